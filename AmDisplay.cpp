@@ -2,6 +2,21 @@
 
 #include <Arduino.h>
 
+#include "SignalSampler.h"
+
+// AM hangolás gyorsítási görbéi (lépés/sec -> szorzó)
+// - normál sáv (LW/MW, szűk SW sávok): mérsékelt gyorsítás
+// - széles sáv (pl. a 100-30000kHz-es "SW"): gyors tekerésnél nagyon nagy szorzó, hogy pár fordulattal végig lehessen menni
+//   rajta, lassú tekerésnél viszont lépésenként hangolunk, így a finom állításnál nincs túllövés
+// - SSB/CW BFO finomhangolás: csak enyhe gyorsítás
+#define AM_WIDE_BAND_STEPS 2000  // Ennél több hangolási lépésből álló sávban a széles sáv görbéjét használjuk
+static constexpr RotaryEncoder::AccelerationPoint AM_ACCELERATION_POINTS[] = {{5, 1}, {15, 2}, {30, 5}, {60, 10}};
+static constexpr RotaryEncoder::AccelerationPoint AM_WIDE_ACCELERATION_POINTS[] = {{5, 1}, {15, 5}, {30, 50}, {50, 200}, {80, 1000}};
+static constexpr RotaryEncoder::AccelerationPoint BFO_ACCELERATION_POINTS[] = {{10, 1}, {30, 2}, {60, 4}};
+static constexpr RotaryEncoder::AccelerationCurve AM_ACCELERATION_CURVE = {AM_ACCELERATION_POINTS, ARRAY_ITEM_COUNT(AM_ACCELERATION_POINTS)};
+static constexpr RotaryEncoder::AccelerationCurve AM_WIDE_ACCELERATION_CURVE = {AM_WIDE_ACCELERATION_POINTS, ARRAY_ITEM_COUNT(AM_WIDE_ACCELERATION_POINTS)};
+static constexpr RotaryEncoder::AccelerationCurve BFO_ACCELERATION_CURVE = {BFO_ACCELERATION_POINTS, ARRAY_ITEM_COUNT(BFO_ACCELERATION_POINTS)};
+
 /**
  * Konstruktor
  */
@@ -55,11 +70,9 @@ void AmDisplay::drawScreen() {
     // RSSI skála kirajzoltatása
     pSMeter->drawSmeterScale();
 
-    // RSSI aktuális érték
-    si4735.getCurrentReceivedSignalQuality();
-    uint8_t rssi = si4735.getCurrentRSSI();
-    uint8_t snr = si4735.getCurrentSNR();
-    pSMeter->showRSSI(rssi, snr, band.getCurrentBand().varData.currMod == FM);
+    // RSSI aktuális érték (a jelminőség mintavételező snapshot-jából)
+    const SignalQuality &signal = signalSampler.get();
+    pSMeter->showRSSI(signal.rssi, signal.snr, band.getCurrentBand().varData.currMod == FM);
 
     // Frekvencia
     float currFreq = band.getCurrentBand().varData.currFreq;  // A Rotary változtatásakor már eltettük a Band táblába
@@ -92,7 +105,7 @@ void AmDisplay::processScreenButtonTouchEvent(TftButton::ButtonTouchEvent &event
                                       band.getCurrentBand().varData.antCap = newValue;
 
                                       // Az új érték beállítása a Si4735-be
-                                      Si4735Utils::si4735.setTuneFrequencyAntennaCapacitor(newValue);
+                                      band.getChipState().setAntennaCapacitor(newValue);
 
                                       // Frissítjük a státusvonalban a kiírást
                                       DisplayBase::drawAntCapStatus(true);
@@ -117,57 +130,83 @@ bool AmDisplay::handleTouch(bool touched, uint16_t tx, uint16_t ty) {
 }
 
 /**
- * Rotary encoder esemény lekezelése
+ * A rotary encoder gyorsítási görbéje: SSB/CW-ben a BFO-é, AM-ben a sáv szélességétől függően
  */
-bool AmDisplay::handleRotary(RotaryEncoder::EncoderState encoderState) {
+const RotaryEncoder::AccelerationCurve &AmDisplay::getAccelerationCurve() {
 
     BandTable &currentBand = band.getCurrentBand();
     uint8_t currMod = currentBand.varData.currMod;
-    uint16_t currentFrequency = si4735.getFrequency();
 
-    // SSB vagy CW módban a BFO-val finomhangolunk, de csak akkor ha a lépés nem 1000Hz, amit az si4735 amúgy is támogat
     if (currMod == LSB or currMod == USB or currMod == CW) {
+        return BFO_ACCELERATION_CURVE;
+    }
 
-        if (encoderState.direction == RotaryEncoder::Direction::Up) {
+    uint16_t bandSteps = (currentBand.pConstData->maximumFreq - currentBand.pConstData->minimumFreq) / max(currentBand.varData.currStep, (uint8_t)1);
+    return bandSteps > AM_WIDE_BAND_STEPS ? AM_WIDE_ACCELERATION_CURVE : AM_ACCELERATION_CURVE;
+}
 
-            // Felfelé hangolásnál
-            rtv::freqDec = rtv::freqDec - rtv::freqstep;
-            uint32_t freqTot = (uint32_t)(currentFrequency * 1000) + (rtv::freqDec * -1);
-            if (freqTot > (uint32_t)(currentBand.pConstData->maximumFreq * 1000)) {
-                si4735.setFrequency(currentBand.pConstData->maximumFreq);
-                rtv::freqDec = 0;
-            }
+/**
+ * Rotary encoder esemény lekezelése
+ */
+bool AmDisplay::handleRotary(RotaryEncoder::EncoderState encoderState) {
 
-            if (rtv::freqDec <= -16000) {
-                rtv::freqDec = rtv::freqDec + 16000;
-                int16_t freqPlus16 = currentFrequency + 16;
-                Si4735Utils::hardwareAudioMuteOn();
-                si4735.setFrequency(freqPlus16);
-            }
+    BandTable &currentBand = band.getCurrentBand();
+    uint8_t currMod = currentBand.varData.currMod;
+    TuneEngine &tuneEngine = band.getTuneEngine();
 
-        } else {
+    // Kézi hangolás -> a memória szkennelés leáll
+    memoryScanner.stop();
 
-            // Lefelé hangolásnál
-            rtv::freqDec = rtv::freqDec + rtv::freqstep;
-            uint32_t freqTot = (uint32_t)(currentFrequency * 1000) - rtv::freqDec;
-            if (freqTot < (uint32_t)(currentBand.pConstData->minimumFreq * 1000)) {
-                si4735.setFrequency(currentBand.pConstData->minimumFreq);
-                rtv::freqDec = 0;
-            }
-            if (rtv::freqDec >= 16000) {
-                rtv::freqDec = rtv::freqDec - 16000;
-                int16_t freqMin16 = currentFrequency - 16;
-                Si4735Utils::hardwareAudioMuteOn();
-                si4735.setFrequency(freqMin16);
+    uint16_t currentFrequency = tuneEngine.getTarget();  // A legutóbbi célfrekvencia, nem várjuk meg az előző hangolás végét
+
+    // SSB vagy CW módban a BFO-val finomhangolunk, de csak akkor ha a lépés nem 1000Hz, amit az si4735 amúgy is támogat
+    if (currMod == LSB or currMod == USB or currMod == CW) {
+
+        // Minden (gyorsított) lépést külön hajtunk végre, hogy a 16kHz-es átfordulásokat egyenként kezeljük
+        for (int16_t i = 0; i < abs(encoderState.value); i++) {
+            currentFrequency = tuneEngine.getTarget();
+
+            if (encoderState.direction == RotaryEncoder::Direction::Up) {
+
+                // Felfelé hangolásnál
+                rtv::freqDec = rtv::freqDec - rtv::freqstep;
+                uint32_t freqTot = (uint32_t)(currentFrequency * 1000) + (rtv::freqDec * -1);
+                if (freqTot > (uint32_t)(currentBand.pConstData->maximumFreq * 1000)) {
+                    tuneEngine.setTarget(currentBand.pConstData->maximumFreq);
+                    rtv::freqDec = 0;
+                }
+
+                if (rtv::freqDec <= -16000) {
+                    rtv::freqDec = rtv::freqDec + 16000;
+                    int16_t freqPlus16 = currentFrequency + 16;
+                    Si4735Utils::hardwareAudioMuteOn();
+                    tuneEngine.setTarget(freqPlus16);
+                }
+
+            } else {
+
+                // Lefelé hangolásnál
+                rtv::freqDec = rtv::freqDec + rtv::freqstep;
+                uint32_t freqTot = (uint32_t)(currentFrequency * 1000) - rtv::freqDec;
+                if (freqTot < (uint32_t)(currentBand.pConstData->minimumFreq * 1000)) {
+                    tuneEngine.setTarget(currentBand.pConstData->minimumFreq);
+                    rtv::freqDec = 0;
+                }
+                if (rtv::freqDec >= 16000) {
+                    rtv::freqDec = rtv::freqDec - 16000;
+                    int16_t freqMin16 = currentFrequency - 16;
+                    Si4735Utils::hardwareAudioMuteOn();
+                    tuneEngine.setTarget(freqMin16);
+                }
             }
         }
 
-        config.data.currentBFO = rtv::freqDec;                 // freqDec a finomhangolás mértéke
+        config.set(config.data.currentBFO, rtv::freqDec);       // freqDec a finomhangolás mértéke
         currentBand.varData.lastBFO = config.data.currentBFO;  // Mentsük el a finomhangolást
 
         // BFO beállítása: CW esetén alap offset + finomhangolás, SSB esetén csak finomhangolás
-        const int16_t cwBaseOffset = (currMod == CW) ? CW_SHIFT_FREQUENCY : 0;                 // CW alap offset
-        si4735.setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);  // <- Itt állítjuk be a BFO-t Hz-ben!
+        const int16_t cwBaseOffset = (currMod == CW) ? CW_SHIFT_FREQUENCY : 0;                              // CW alap offset
+        band.getChipState().setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);  // <- Itt állítjuk be a BFO-t Hz-ben!
 
         checkAGC();
 
@@ -203,15 +242,15 @@ bool AmDisplay::handleRotary(RotaryEncoder::EncoderState encoderState) {
         // 6. Új frekvencia beállítása, csak ha változott
         //    Az összehasonlításhoz és a setFrequency híváshoz vissza kell kasztolni uint16_t-re
         if ((uint16_t)newFrequency != currentFrequency) {
-            si4735.setFrequency((uint16_t)newFrequency);
-            // Mivel setFrequency-t használunk, az AGC-t is ellenőrizni kellhet,
+            tuneEngine.setTarget((uint16_t)newFrequency);
+            // Frekvencia váltáskor az AGC-t is ellenőrizni kellhet,
             // bár valószínűleg AM módban az automatikus AGC jól működik.
             Si4735Utils::checkAGC();  // Szükség esetén
         }
     }
 
-    // Elmentjük a beállított frekvenciát a Band táblába
-    currentBand.varData.currFreq = si4735.getFrequency();
+    // Elmentjük a célfrekvenciát a Band táblába, a kijelző azonnal ezt mutatja
+    currentBand.varData.currFreq = tuneEngine.getTarget();
 
     // Kiszámítjuk a pontos frekvenciát Hz-ben a BFO eltolással
     uint32_t displayFreqHz = (uint32_t)currentFrequency * 1000 - currentBand.varData.lastBFO;
@@ -237,15 +276,21 @@ void AmDisplay::displayLoop() {
     BandTable &currentBand = band.getCurrentBand();
     uint8_t currMod = currentBand.varData.currMod;  // Aktuális mód lekérdezése
 
+    // A memória szkenner csatornát (és esetleg módot) váltott
+    if (memoryScanner.checkChannelChanged()) {
+        if (memoryScanner.checkModeChanged()) {
+            dawStatusLine();
+        }
+        DisplayBase::frequencyChanged = true;
+    }
+
     // Néhány adatot csak ritkábban frissítünk
     static uint32_t elapsedTimedValues = 0;  // Kezdőérték nulla
     if ((millis() - elapsedTimedValues) >= SCREEN_COMPS_REFRESH_TIME_MSEC) {
 
-        // RSSI
-        si4735.getCurrentReceivedSignalQuality();
-        uint8_t rssi = si4735.getCurrentRSSI();
-        uint8_t snr = si4735.getCurrentSNR();
-        pSMeter->showRSSI(rssi, snr, currentBand.varData.currMod == FM);
+        // RSSI (a jelminőség mintavételező snapshot-jából)
+        const SignalQuality &signal = signalSampler.get();
+        pSMeter->showRSSI(signal.rssi, signal.snr, currentBand.varData.currMod == FM);
 
         // Frissítjük az időbélyeget
         elapsedTimedValues = millis();
@@ -20,6 +20,11 @@ class AmDisplay : public DisplayBase {
      */
     bool handleRotary(RotaryEncoder::EncoderState encoderState) override;
 
+    /**
+     * A rotary encoder gyorsítási görbéje
+     */
+    const RotaryEncoder::AccelerationCurve &getAccelerationCurve() override;
+
     /**
      * Touch (nem képrnyő button) esemény lekezelése
      */
@@ -0,0 +1,59 @@
+#include "AudioMute.h"
+
+#include "Config.h"
+#include "SignalSampler.h"
+#include "Squelch.h"
+#include "utils.h"
+
+/**
+ * A mute láb beállítása az aktív okok szerint
+ */
+void AudioMute::apply() {
+
+    bool mute = reasons != 0;
+    if (mute == pinMuted) {
+        return;
+    }
+    pinMuted = mute;
+    si4735.setHardwareAudioMute(mute);
+}
+
+/**
+ * A mute láb kezdő állapota
+ */
+void AudioMute::begin() {
+    pinMuted = reasons != 0;
+    si4735.setHardwareAudioMute(pinMuted);
+}
+
+/**
+ * Egy ok be- / kikapcsolása
+ */
+void AudioMute::set(Reason reason, bool mute) {
+
+    uint8_t bit = 1 << (uint8_t)reason;
+    if (mute) {
+        reasons |= bit;
+    } else {
+        reasons &= ~bit;
+    }
+    apply();
+}
+
+/**
+ * Arduino loop
+ */
+void AudioMute::loop() {
+
+    const SignalQuality &signal = signalSampler.get();
+    if (signal.version == lastVersion) {
+        return;
+    }
+    lastVersion = signal.version;
+
+    uint8_t level = Squelch::selectLevel(signal.rssi, signal.snr, config.data.squelchUsesRSSI);
+    if (squelch.evaluate(level, config.data.currentSquelch, signal.timestamp)) {
+        set(Reason::Squelch, !squelch.isOpen());
+        DEBUG("Squelch -> %s (%s: %d, threshold: %d)\n", squelch.isOpen() ? "open" : "closed", config.data.squelchUsesRSSI ? "RSSI" : "SNR", level, config.data.currentSquelch);
+    }
+}
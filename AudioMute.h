@@ -0,0 +1,75 @@
+#ifndef __AUDIOMUTE_H
+#define __AUDIOMUTE_H
+
+#include <SI4735.h>
+
+/**
+ * A hang némítása: egyetlen helyen, a hardware mute lábbal (PIN_AUDIO_MUTE)
+ *
+ * Több okból kell némítani (felhasználó, zajzár, szkennelés, AF ellenőrzés, SSB átállás), ezek egymástól függetlenül
+ * kapcsolnak be / ki. Okonként egy bitet tartunk, a láb akkor némít, ha bármelyik bit áll, és csak állapotváltáskor
+ * kapcsoljuk. Így pl. a szkenner leállása nem nyitja ki a hangot, ha közben a zajzár zárva van vagy a felhasználó némított.
+ * A chip saját (I2C-s) némítását nem használjuk, a két út egymást írta felül.
+ *
+ * A zajzárat a loop() kezeli: minden új jelminőség snapshot-ot kiértékel, és a zajzár állapotát a Squelch okra képezi le.
+ */
+class AudioMute {
+
+   public:
+    // A némítás okai
+    enum class Reason : uint8_t {
+        User,     // Mute gomb (rtv::muteStat)
+        Squelch,  // Zárt zajzár
+        Scan,     // Memória / spektrum szkennelés a csatornák között
+        RdsAf,    // RDS AF ellenőrzés (más frekvencián mérünk)
+        Retune    // SSB/CW finomhangolás átfordulása (a chip átállása)
+    };
+
+   private:
+    SI4735 &si4735;
+
+    uint8_t reasons = 0;       // Az aktív okok (bit = Reason)
+    bool pinMuted = false;     // A mute láb állapota
+    uint32_t lastVersion = 0;  // Az utoljára kiértékelt jelminőség snapshot verziója
+
+    /**
+     * A mute láb beállítása az aktív okok szerint (csak változáskor)
+     */
+    void apply();
+
+   public:
+    /**
+     * Konstruktor
+     */
+    AudioMute(SI4735 &si4735) : si4735(si4735) {}
+
+    /**
+     * A mute láb kezdő állapota (a setAudioMuteMcuPin() után hívjuk)
+     */
+    void begin();
+
+    /**
+     * Egy ok be- / kikapcsolása
+     */
+    void set(Reason reason, bool mute);
+
+    /**
+     * Némít az adott ok?
+     */
+    inline bool isMutedBy(Reason reason) const { return reasons & (1 << (uint8_t)reason); }
+
+    /**
+     * Némítva van a hang (bármelyik ok miatt)?
+     */
+    inline bool isMuted() const { return reasons != 0; }
+
+    /**
+     * Arduino loop: a zajzár kiértékelése az új jelminőség snapshot-on
+     */
+    void loop();
+};
+
+// Globális példány
+extern AudioMute audioMute;
+
+#endif  //__AUDIOMUTE_H
@@ -3,10 +3,14 @@
 #include <avr/pgmspace.h>
 #include <patch_full.h>  // SSB patch for whole SSBRX full download
 
+#include "I2cTrace.h"
+#include "RdsGroupFifo.h"
+#include "Si4735PatchLoader.h"
+#include "Si4735Utils.h"
 #include "rtVars.h"
 
 // Sávnevek tárolása PROGMEM-ben tömbként
-const char bandNames[][5] PROGMEM = {
+constexpr char bandNames[][5] PROGMEM = {
     "FM",    // 0
     "LW",    // 1
     "MW",    // 2
@@ -40,7 +44,8 @@ const char bandNames[][5] PROGMEM = {
 };
 
 // PROGMEM - ben tárolt állandó tábla
-const BandTableConst bandTableConst[] PROGMEM = {
+// A sorrendet nem szabad megváltoztatni: a sáv indexét a konfig és a band adatok mentése is tárolja
+constexpr BandTableConst bandTableConst[] PROGMEM = {
     {bandNames[0], 0, FM, 6400, 10800, 9390, 10, false},    //  FM          0   // 93.9MHz Petőfi
     {bandNames[1], 1, AM, 100, 514, 198, 9, false},         //  LW          1
     {bandNames[2], 1, AM, 514, 1800, 540, 9, false},        //  MW          2   // 540kHz Kossuth
@@ -74,7 +79,225 @@ const BandTableConst bandTableConst[] PROGMEM = {
 };
 
 /// Itt határozzuk meg a BAND_COUNT értékét!
-const size_t BANDTABLE_COUNT = sizeof(bandTableConst) / sizeof(BandTableConst);
+constexpr size_t BANDTABLE_COUNT = sizeof(bandTableConst) / sizeof(BandTableConst);
+
+//--- A band tábla fordítási idejű ellenőrzése ---------------------------------------------------------------------------------------------
+
+// A frekvencia index bitmaszkja (uint32_t) miatt
+static_assert(BANDTABLE_COUNT <= 32, "A band tábla legfeljebb 32 sávot tartalmazhat");
+
+/**
+ * A sáv rekord önmagában helyes? (határok, alapértelmezett frekvencia, lépésköz, moduláció)
+ */
+static constexpr bool isBandRecordValid(const BandTableConst &b) {
+    return b.minimumFreq < b.maximumFreq and b.defFreq >= b.minimumFreq and b.defFreq <= b.maximumFreq and b.defStep > 0 and b.prefMod <= CW and
+           ((b.bandType == FM_BAND_TYPE) == (b.prefMod == FM));
+}
+
+/**
+ * Az összes AM sávot lefedő 'gyűjtő' sáv? (pl. a teljes SW)
+ */
+static constexpr bool isCoverAllBand(size_t idx) {
+    if (bandTableConst[idx].bandType == FM_BAND_TYPE) {
+        return false;
+    }
+    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+        if (bandTableConst[i].bandType != FM_BAND_TYPE and
+            (bandTableConst[i].minimumFreq < bandTableConst[idx].minimumFreq or bandTableConst[i].maximumFreq > bandTableConst[idx].maximumFreq)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Minden rekord helyes?
+ */
+static constexpr bool areBandRecordsValid() {
+    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+        if (!isBandRecordValid(bandTableConst[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Az egy csoportba (HAM vagy műsorszóró AM) tartozó sávok növekvő sorrendben vannak és nem fedik át egymást?
+ * (A csoportok egymást átfedhetik, pl. 40m HAM és 41m, és a gyűjtő sávok mindent lefednek)
+ */
+static constexpr bool areBandGroupsSortedAndDisjoint() {
+    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+        const BandTableConst &a = bandTableConst[i];
+        if (a.bandType == FM_BAND_TYPE or isCoverAllBand(i)) {
+            continue;
+        }
+        for (size_t j = i + 1; j < BANDTABLE_COUNT; j++) {
+            const BandTableConst &b = bandTableConst[j];
+            if (b.bandType == FM_BAND_TYPE or isCoverAllBand(j) or a.isHam != b.isHam) {
+                continue;
+            }
+            // A sávhatárok érintkezhetnek (pl. LW/MW 514kHz), de nem lóghatnak egymásba
+            if (b.minimumFreq < a.maximumFreq) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(areBandRecordsValid(), "Hibás band rekord: határok, alapértelmezett frekvencia, lépésköz vagy moduláció");
+static_assert(areBandGroupsSortedAndDisjoint(), "A HAM, illetve a műsorszóró sávoknak növekvő sorrendben, átfedés nélkül kell következniük");
+
+//--- Fordítási időben előállított indexek -------------------------------------------------------------------------------------------------
+
+/**
+ * Sávnév lista (a HAM / nem HAM sáv választó dialógusokhoz)
+ */
+struct BandNameList {
+    const char *names[BANDTABLE_COUNT];
+    uint8_t count;
+};
+
+static constexpr BandNameList buildBandNameList(bool isHam) {
+    BandNameList list = {};
+    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+        if (bandTableConst[i].isHam == isHam) {
+            list.names[list.count++] = bandTableConst[i].bandName;
+        }
+    }
+    return list;
+}
+
+// Konstans inicializálás, de nem const: a MultiButtonDialog 'const char *[]'-t vár
+static BandNameList hamBandNames = buildBandNameList(true);
+static BandNameList broadcastBandNames = buildBandNameList(false);
+
+/**
+ * Fordítási idejű string összehasonlítás (strcmp)
+ */
+static constexpr int constStrCmp(const char *a, const char *b) {
+    while (*a != '\0' and *a == *b) {
+        a++;
+        b++;
+    }
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+/**
+ * Név szerint rendezett sáv index (bináris kereséshez)
+ */
+struct BandNameIndex {
+    uint8_t idx[BANDTABLE_COUNT];
+};
+
+static constexpr BandNameIndex buildBandNameIndex() {
+    BandNameIndex index = {};
+    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+        // Beszúrásos rendezés
+        size_t j = i;
+        while (j > 0 and constStrCmp(bandTableConst[index.idx[j - 1]].bandName, bandTableConst[i].bandName) > 0) {
+            index.idx[j] = index.idx[j - 1];
+            j--;
+        }
+        index.idx[j] = i;
+    }
+    return index;
+}
+
+static constexpr BandNameIndex bandNameIndex = buildBandNameIndex();
+
+/**
+ * Nincs két azonos nevű sáv?
+ */
+static constexpr bool areBandNamesUnique() {
+    for (size_t i = 1; i < BANDTABLE_COUNT; i++) {
+        if (constStrCmp(bandTableConst[bandNameIndex.idx[i - 1]].bandName, bandTableConst[bandNameIndex.idx[i]].bandName) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(areBandNamesUnique(), "A sávneveknek egyedinek kell lenniük");
+
+/**
+ * Frekvencia -> sáv intervallum index (az AM sávokra)
+ *
+ * A sávhatárok a frekvencia tengelyt szegmensekre bontják, egy szegmensen belül ugyanazok a sávok tartalmazzák a frekvenciát.
+ * A szegmensek kezdete növekvő sorrendben van -> bináris kereséssel O(log n) a keresés.
+ */
+#define BAND_FREQ_INDEX_MAX_SEGMENTS (BANDTABLE_COUNT * 2)
+
+struct BandFreqIndex {
+    uint16_t segStart[BAND_FREQ_INDEX_MAX_SEGMENTS];  // A szegmens első frekvenciája
+    uint32_t segMask[BAND_FREQ_INDEX_MAX_SEGMENTS];   // A szegmenst tartalmazó sávok (bit = sáv index)
+    int8_t segBest[BAND_FREQ_INDEX_MAX_SEGMENTS];     // A szegmenst tartalmazó legszűkebb sáv, -1 ha nincs ilyen
+    uint8_t count;
+};
+
+/**
+ * Szegmens határ felvétele (rendezve, ismétlés nélkül)
+ */
+static constexpr void addBandFreqBoundary(BandFreqIndex &index, uint16_t freq) {
+    size_t pos = 0;
+    while (pos < index.count and index.segStart[pos] < freq) {
+        pos++;
+    }
+    if (pos < index.count and index.segStart[pos] == freq) {
+        return;
+    }
+    for (size_t i = index.count; i > pos; i--) {
+        index.segStart[i] = index.segStart[i - 1];
+    }
+    index.segStart[pos] = freq;
+    index.count++;
+}
+
+static constexpr BandFreqIndex buildBandFreqIndex() {
+    BandFreqIndex index = {};
+
+    // A határok: a sávok eleje, és a sávok vége utáni első frekvencia
+    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+        if (bandTableConst[i].bandType != FM_BAND_TYPE) {
+            addBandFreqBoundary(index, bandTableConst[i].minimumFreq);
+            addBandFreqBoundary(index, bandTableConst[i].maximumFreq + 1);
+        }
+    }
+
+    // Szegmensenként a tartalmazó sávok
+    for (size_t s = 0; s < index.count; s++) {
+        uint16_t freq = index.segStart[s];
+        index.segBest[s] = -1;
+        for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+            const BandTableConst &b = bandTableConst[i];
+            if (b.bandType == FM_BAND_TYPE or freq < b.minimumFreq or freq > b.maximumFreq) {
+                continue;
+            }
+            index.segMask[s] |= (uint32_t)1 << i;
+            if (index.segBest[s] < 0 or (b.maximumFreq - b.minimumFreq) < (bandTableConst[index.segBest[s]].maximumFreq - bandTableConst[index.segBest[s]].minimumFreq)) {
+                index.segBest[s] = i;
+            }
+        }
+    }
+    return index;
+}
+
+static constexpr BandFreqIndex bandFreqIndex = buildBandFreqIndex();
+
+/**
+ * Az FM sávok bitmaszkja (FM frekvenciát nem az AM indexben keresünk, mert más a mértékegység)
+ */
+static constexpr uint32_t buildFmBandMask() {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+        if (bandTableConst[i].bandType == FM_BAND_TYPE) {
+            mask |= (uint32_t)1 << i;
+        }
+    }
+    return mask;
+}
+
+static constexpr uint32_t fmBandMask = buildFmBandMask();
 
 // A Kombinált tábla RAM-ban
 BandTable bandTable[BANDTABLE_COUNT];
@@ -104,7 +327,7 @@ const FrequencyStep Band::stepSizeFM[] = {
 /**
  * Konstruktor
  */
-Band::Band(SI4735& si4735) : si4735(si4735) {
+Band::Band(SI4735& si4735) : si4735(si4735), chipState(si4735), tuneEngine(chipState) {
 
     // A BandTable inicializálása
     for (uint8_t i = 0; i < BANDTABLE_COUNT; i++) {
@@ -147,64 +370,165 @@ BandTable& Band::getBandByIdx(uint8_t bandIdx) {
     return bandTable[bandIdx];  // Egyébként visszaadjuk a megfelelő rekordot
 }
 
+/**
+ * A sávok száma
+ */
+uint8_t Band::getBandCount() { return BANDTABLE_COUNT; }
+
 /**
  * A Band indexének elkérése a bandName alapján
+ * (Bináris keresés a fordításkor név szerint rendezett indexben)
  *
  * @param bandName A keresett sáv neve
  * @return A BandTable rekord indexe, vagy -1, ha nem található
  */
 int8_t Band::getBandIdxByBandName(const char* bandName) {
 
-    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
-        if (strcmp_P(bandName, bandTableConst[i].bandName) == 0) {
-            return i;  // Megtaláltuk az indexet
+    int16_t lo = 0;
+    int16_t hi = BANDTABLE_COUNT - 1;
+    while (lo <= hi) {
+        int16_t mid = (lo + hi) / 2;
+        uint8_t idx = bandNameIndex.idx[mid];
+        int cmp = strcmp_P(bandName, bandTableConst[idx].bandName);
+        if (cmp == 0) {
+            return idx;  // Megtaláltuk az indexet
+        }
+        if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
         }
     }
     return -1;  // Ha nem található
 }
 
+/**
+ * A frekvenciát tartalmazó sávok elkérése
+ *
+ * @param freq A frekvencia (FM: 10kHz, AM: kHz egységben)
+ * @param isFm FM frekvencia?
+ * @return A tartalmazó sávok bitmaszkja (bit = sáv index), 0, ha nincs ilyen sáv
+ */
+uint32_t Band::getBandMaskByFrequency(uint16_t freq, bool isFm) {
+
+    if (isFm) {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+            if ((fmBandMask & ((uint32_t)1 << i)) and freq >= bandTableConst[i].minimumFreq and freq <= bandTableConst[i].maximumFreq) {
+                mask |= (uint32_t)1 << i;
+            }
+        }
+        return mask;
+    }
+
+    int8_t seg = findBandFreqSegment(freq);
+    return seg < 0 ? 0 : bandFreqIndex.segMask[seg];
+}
+
+/**
+ * A frekvenciát tartalmazó legszűkebb sáv indexének elkérése
+ * (pl. 7100kHz -> 40m HAM, és nem a teljes SW)
+ *
+ * @param freq A frekvencia (FM: 10kHz, AM: kHz egységben)
+ * @param isFm FM frekvencia?
+ * @return A sáv indexe, vagy -1, ha nincs ilyen sáv
+ */
+int8_t Band::getBandIdxByFrequency(uint16_t freq, bool isFm) {
+
+    if (isFm) {
+        uint32_t mask = getBandMaskByFrequency(freq, true);
+        for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
+            if (mask & ((uint32_t)1 << i)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int8_t seg = findBandFreqSegment(freq);
+    return seg < 0 ? -1 : bandFreqIndex.segBest[seg];
+}
+
+/**
+ * Az AM frekvencia szegmensének keresése az intervallum indexben (bináris keresés)
+ *
+ * @return A szegmens indexe, vagy -1, ha a frekvencia az első sáv alatt van
+ */
+int8_t Band::findBandFreqSegment(uint16_t freq) {
+
+    // Az utolsó szegmens, aminek a kezdete <= freq
+    int16_t lo = 0;
+    int16_t hi = bandFreqIndex.count - 1;
+    int8_t found = -1;
+    while (lo <= hi) {
+        int16_t mid = (lo + hi) / 2;
+        if (bandFreqIndex.segStart[mid] <= freq) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
 /**
  * Sávok neveinek visszaadása tömbként
+ * (A listák fordításkor készülnek el)
  *
  * @param count talált elemek száma
  * @param isHamFilter HAM szűrő
  */
 const char** Band::getBandNames(uint8_t& count, bool isHamFilter) {
 
-    static const char* filteredNames[BANDTABLE_COUNT];  // Tároló a kiválasztott nevekre
-    count = 0;                                          // Kezdőérték
-
-    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
-        if (bandTableConst[i].isHam == isHamFilter) {             // HAM sáv szűrés
-            filteredNames[count++] = bandTableConst[i].bandName;  // Hozzáadás a listához
-        }
-    }
+    BandNameList& list = isHamFilter ? hamBandNames : broadcastBandNames;
+    count = list.count;
+    return list.names;  // A pointert visszaadjuk
+}
 
-    return filteredNames;  // A pointert visszaadjuk
+/**
+ * Property írás(ok) mérése az I2C trace-ben
+ * @param properties ennyi property-t ír a library hívás (mindegyik külön SET_PROPERTY parancs)
+ */
+template <typename Write>
+static void traceSetProperty(uint8_t properties, Write write) {
+    I2cTrace::Scope trace(SET_PROPERTY, properties * I2C_TRACE_BYTES_SET_PROPERTY);
+    write();
 }
 
 /**
  * SSB patch betöltése
+ * @return false, ha a patch egyik I2C sebességen sem töltődött le (a chip ilyenkor patch nélkül, újraindítva marad)
  */
-void Band::loadSSB() {
+bool Band::loadSSB() {
 
     DEBUG("Band::loadSSB()\n");
 
     // Ha már be van töltve, akkor nem megyünk tovább
     if (ssbLoaded) {
         DEBUG("Band::loadSSB() -> SSB már be van töltve\n");
-        return;
+        return true;
     }
 
-    si4735.reset();
-    si4735.queryLibraryId();  // Is it really necessary here? I will check it.
-    si4735.patchPowerUp();
-    delay(50);
-
-    si4735.setI2CFastMode();  // Recommended
-    // si4735.setI2CFastModeCustom(500000); // It is a test and may crash.
-    si4735.downloadPatch(ssb_patch_content, sizeof(ssb_patch_content));
-    si4735.setI2CStandardMode();  // goes back to default (100KHz)
+    // Chip előkészítése a patch fogadására
+    auto restartChip = [this]() {
+        si4735.reset();
+        si4735.queryLibraryId();  // Is it really necessary here? I will check it.
+        {
+            I2cTrace::Scope trace(POWER_UP, I2C_TRACE_BYTES_POWER_UP);
+            si4735.patchPowerUp();
+        }
+        delay(50);
+    };
+    restartChip();
+    chipState.invalidate();  // Az újraindított chip állapota ismeretlen
+
+    // A patch letöltése a leggyorsabb megbízható I2C sebességgel (hiba esetén lassabbal újrapróbálja)
+    Si4735PatchLoader patchLoader(Wire, rtv::si4735Address);
+    if (!patchLoader.download(ssb_patch_content, sizeof(ssb_patch_content), restartChip)) {
+        DEBUG("Band::loadSSB() -> SSB patch download failed!\n");
+        return false;
+    }
     delay(50);
 
     // Parameters
@@ -214,9 +538,13 @@ void Band::loadSSB() {
     // AVCEN - SSB Automatic Volume Control (AVC) enable; 0=disable; 1=enable (default).
     // SMUTESEL - SSB Soft-mute Based on RSSI or SNR (0 or 1).
     // DSP_AFCDIS - DSP AFC Disable or enable; 0=SYNC MODE, AFC enable; 1=SSB MODE, AFC disable.
-    si4735.setSSBConfig(config.data.bwIdxSSB, 1, 0, 1, 0, 1);
+    {
+        I2cTrace::Scope trace(SET_PROPERTY, I2C_TRACE_BYTES_SET_PROPERTY);
+        si4735.setSSBConfig(config.data.bwIdxSSB, 1, 0, 1, 0, 1);
+    }
     delay(25);
     ssbLoaded = true;
+    return true;
 }
 
 /**
@@ -272,84 +600,112 @@ void Band::useBand() {
         currentBand.varData.currStep = stepSizeFM[stepIndex].value;
     }
 
-    if (currentBandType == FM_BAND_TYPE) {
-        rtv::bfoOn = false;
+    // A kívánt chip állapot összeállítása
+    currentBand.varData.antCap = getDefaultAntCapValue();
+
+    Si4735Settings desired;
+    desired.minFreq = currentBand.pConstData->minimumFreq;
+    desired.maxFreq = currentBand.pConstData->maximumFreq;
+    desired.freq = currentBand.varData.currFreq;
+    desired.step = currentBand.varData.currStep;
+    desired.sideband = USB;
+    desired.bandwidth = getBandWidthForChip();
+    desired.antCap = currentBand.varData.antCap;
+    desired.bfo = 0;
+    desired.volume = config.data.currVolume;
+    getAgcForChip(desired.agcDisabled, desired.agcIndex);
 
-        // Antenna tuning capacitor beállítása (FM esetén antenna tuning capacitor nem kell)
-        currentBand.varData.antCap = getDefaultAntCapValue();
-        si4735.setTuneFrequencyAntennaCapacitor(currentBand.varData.antCap);
-        delay(100);
+    uint8_t currMod = currentBand.varData.currMod;
 
-        si4735.setFM(currentBand.pConstData->minimumFreq, currentBand.pConstData->maximumFreq, currentBand.varData.currFreq, currentBand.varData.currStep);
-        si4735.setFMDeEmphasis(1);
-        ssbLoaded = false;
-        si4735.RdsInit();
-        si4735.setRdsConfig(1, 2, 2, 2, 2);
+    if (currentBandType == FM_BAND_TYPE) {
+        rtv::bfoOn = false;
+        desired.mode = ChipMode::Fm;
+
+    } else if (ssbLoaded and currMod != AM) {
+        // SSB vagy CW mód
+        bool isCWMode = (currMod == CW);
+
+        // Mód beállítása (LSB-t használunk alapnak CW-hez)
+        desired.mode = ChipMode::Ssb;
+        desired.sideband = isCWMode ? LSB : currMod;
+
+        // SSB/CW esetén a lépésköz a chipen mindig 1kHz, a finomhangolás BFO-val történik
+        currentBand.varData.currStep = 1;
+        desired.step = currentBand.varData.currStep;
+
+        // BFO beállítása
+        // CW mód: Fix BFO offset (pl. 700 Hz) + manuális finomhangolás
+        const int16_t cwBaseOffset = isCWMode ? CW_SHIFT_FREQUENCY : 0;
+        desired.bfo = cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu;
+        rtv::CWShift = isCWMode;  // Jelezzük a kijelzőnek
+
+    } else if (ssbLoaded) {
+        // AM mód a bent lévő SSB patch-el: a patch-elt firmware szinkron AM módját használjuk,
+        // így nem kell a chipet újraindítani és a patch-et újra letölteni, ha visszaváltunk SSB/CW-re
+        desired.mode = ChipMode::SyncAm;
+        rtv::bfoOn = false;
+        rtv::CWShift = false;
 
     } else {
+        // Sima AM mód
+        desired.mode = ChipMode::Am;
+        rtv::bfoOn = false;
+        rtv::CWShift = false;  // AM módban biztosan nincs CW shift
+    }
 
-        // AM-ben vagyunk
-        //  Antenna capacitor beállítása
-        currentBand.varData.antCap = getDefaultAntCapValue();  // Sima AM esetén antenna tuning capacitor nem kell
-        si4735.setTuneFrequencyAntennaCapacitor(currentBand.varData.antCap);
-        delay(100);
-
-        if (ssbLoaded) {
-            // SSB vagy CW mód
-
-            bool isCWMode = (currentBand.varData.currMod == CW);
-
-            // Mód beállítása (LSB-t használunk alapnak CW-hez)
-            uint8_t modeForChip = isCWMode ? LSB : currentBand.varData.currMod;
-            si4735.setSSB(currentBand.pConstData->minimumFreq, currentBand.pConstData->maximumFreq, currentBand.varData.currFreq,
-                          1,  // SSB/CW esetén a step mindig 1kHz a chipen belül
-                          modeForChip);
-
-            // si4735.setSSB(currentBand.pConstData->minimumFreq, currentBand.pConstData->maximumFreq, currentBand.varData.currFreq, currentBand.varData.currStep,
-            //               currentBand.varData.currMod);
-            //  si4735.setSSBAutomaticVolumeControl(1);
-            //  si4735.setSsbSoftMuteMaxAttenuation(0); // Disable Soft Mute for SSB
-            //  si4735.setSSBDspAfc(0);
-            //  si4735.setSSBAvcDivider(3);
-            //  si4735.setSsbSoftMuteMaxAttenuation(8); // Disable Soft Mute for SSB
-            //  si4735.setSBBSidebandCutoffFilter(0);
-            //  si4735.setSSBBfo(currentBFO);
-
-            // Itt van állítva a BFO!!
-            // si4735.setSSBBfo(config.data.currentBFO + config.data.currentBFOmanu);
-
-            // SSB ONLY 1KHz stepsize
-            // currentBand.varData.currStep = 1;
-            // si4735.setFrequencyStep(currentBand.varData.currStep);
-
-            // BFO beállítása
-            // CW mód: Fix BFO offset (pl. 700 Hz) + manuális finomhangolás
-            const int16_t cwBaseOffset = isCWMode ? CW_SHIFT_FREQUENCY : 0;
-            si4735.setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);
-            rtv::CWShift = isCWMode;  // Jelezzük a kijelzőnek
-
-            // SSB/CW esetén a lépésköz a chipen mindig 1kHz, de a finomhangolás BFO-val történik
-            currentBand.varData.currStep = 1;
-            si4735.setFrequencyStep(currentBand.varData.currStep);
-
-        } else {
-            // Sima AM mód
-            si4735.setAM(currentBand.pConstData->minimumFreq, currentBand.pConstData->maximumFreq, currentBand.varData.currFreq, currentBand.varData.currStep);
-            // si4735.setAutomaticGainControl(1, 0);
-            // si4735.setAmSoftMuteMaxAttenuation(0); // // Disable Soft Mute for AM
-            rtv::bfoOn = false;
-            rtv::CWShift = false;  // AM módban biztosan nincs CW shift
-        }
+    // A rotary-ból még függő hangolás eldobása (a currFreq már a célfrekvencia)
+    tuneEngine.cancel();
+
+    // Csak a különbségeket küldjük ki
+    bool modeChanged = chipState.apply(desired);
+
+    // FM bekapcsolás után az FM-only beállítások
+    if (modeChanged and desired.mode == ChipMode::Fm) {
+        ssbLoaded = false;  // A setFM() újraindította a chipet
+        traceSetProperty(1, [] { si4735.setFMDeEmphasis(1); });
+        traceSetProperty(1, [] { si4735.setSeekFmSpacing(10); });
+        traceSetProperty(2, [&] { si4735.setSeekFmLimits(desired.minFreq, desired.maxFreq); });
+        traceSetProperty(1, [] { si4735.setSeekFmRssiThreshold(5); });
+        traceSetProperty(1, [] { si4735.setSeekFmSrnThreshold(5); });
+        si4735.RdsInit();                                                 // Csak a library RDS puffereit törli, nincs I2C forgalom
+        traceSetProperty(1, [] { si4735.setRdsConfig(1, 3, 3, 3, 3); });  // Minden csoportot kérünk, a hibaszinteket a RdsDecoder kezeli
+        rdsGroupFifo.enableInterrupt();                                   // A bekapcsoláskor törlődött az RDS megszakítás beállítása
+
+    } else if (modeChanged and desired.mode == ChipMode::Am) {
+        traceSetProperty(1, [] { si4735.setSeekAmRssiThreshold(50); });
+        traceSetProperty(1, [] { si4735.setSeekAmSrnThreshold(20); });
     }
-    delay(100);
 }
 
 /**
- * Sávszélesség beállítása
+ * Az AGC chip paraméterei a konfig szerint
+ * @param agcDisabled 1 = AGC tiltva
+ * @param agcIndex a csillapítás (manuális módban)
  */
-void Band::setBandWidth() {
+void Band::getAgcForChip(uint8_t& agcDisabled, uint8_t& agcIndex) {
+    switch (static_cast<Si4735Utils::AgcGainMode>(config.data.agcGain)) {
+        case Si4735Utils::AgcGainMode::Off:
+            agcDisabled = 1;
+            agcIndex = 0;
+            break;
+
+        case Si4735Utils::AgcGainMode::Manual:
+            agcDisabled = 1;
+            agcIndex = config.data.currentAGCgain;
+            break;
+
+        default:
+            agcDisabled = 0;
+            agcIndex = 0;
+            break;
+    }
+}
 
-    DEBUG("Band::setBandWidth()\n");
+/**
+ * Az aktuális demodulációhoz tartozó sávszélesség index a konfig szerint
+ * (A kiküldést a Si4735State végzi, a módnak megfelelő paranccsal)
+ */
+uint8_t Band::getBandWidthForChip() {
 
     BandTable& currentBand = getCurrentBand();
     uint8_t currMod = currentBand.varData.currMod;
@@ -379,16 +735,8 @@ void Band::setBandWidth() {
          *
          * @param AUDIOBW the valid values are 0, 1, 2, 3, 4 or 5; see description above
          */
-        si4735.setSSBAudioBandwidth(config.data.bwIdxSSB);
-
-        // If audio bandwidth selected is about 2 kHz or below, it is recommended to set Sideband Cutoff Filter to 0.
-        if (config.data.bwIdxSSB == 0 or config.data.bwIdxSSB == 4 or config.data.bwIdxSSB == 5) {
-            // Band pass filter to cutoff both the unwanted side band and high frequency components > 2.0 kHz of the wanted side band. (default)
-            si4735.setSSBSidebandCutoffFilter(0);
-        } else {
-            // Low pass filter to cutoff the unwanted side band.
-            si4735.setSSBSidebandCutoffFilter(1);
-        }
+        // (A Sideband Cutoff Filter-t a Si4735State az AUDIOBW alapján állítja)
+        return config.data.bwIdxSSB;
 
     } else if (currMod == AM) {
         /**
@@ -406,7 +754,8 @@ void Band::setBandWidth() {
          *                                   7–15 = Reserved (Do not use).
          * @param AMPLFLT Enables the AM Power Line Noise Rejection Filter.
          */
-        si4735.setBandwidth(config.data.bwIdxAM, 0);
+        // Szinkron AM módban a patch-elt firmware audio sávszélességét állítjuk
+        return ssbLoaded ? getSyncAmAudioBandwidth() : config.data.bwIdxAM;
 
     } else if (currMod == FM) {
         /**
@@ -423,8 +772,10 @@ void Band::setBandWidth() {
          *
          * @param filter_value
          */
-        si4735.setFmBandwidth(config.data.bwIdxFM);
+        return config.data.bwIdxFM;
     }
+
+    return 0;
 }
 
 /**
@@ -435,20 +786,20 @@ void Band::bandInit(bool sysStart) {
     DEBUG("Band::BandInit() ->bandIdx: %d\n", config.data.bandIdx);
     BandTable& curretBand = getCurrentBand();
 
-    if (getCurrentBandType() == FM_BAND_TYPE) {
-        si4735.setup(PIN_SI4735_RESET, FM_BAND_TYPE);
-        si4735.setFM();
-
-        si4735.setSeekFmSpacing(10);
-        si4735.setSeekFmLimits(curretBand.pConstData->minimumFreq, curretBand.pConstData->maximumFreq);
-        si4735.setSeekAmRssiThreshold(50);
-        si4735.setSeekAmSrnThreshold(20);
-        si4735.setSeekFmRssiThreshold(5);
-        si4735.setSeekFmSrnThreshold(5);
-
-    } else {
-        si4735.setup(PIN_SI4735_RESET, MW_BAND_TYPE);
-        si4735.setAM();
+    // A chipet csak rendszer induláskor kell újraindítani, band váltáskor a mód/frekvencia/property-k
+    // kiküldése a useBand() -> Si4735State dolga (csak a különbségeket küldi ki)
+    if (sysStart or !chipState.isValid()) {
+        uint8_t defaultBand = getCurrentBandType() == FM_BAND_TYPE ? FM_BAND_TYPE : MW_BAND_TYPE;
+#ifdef __USE_RDS_INTERRUPT
+        // A GPO2/INT lábat engedélyezzük (a megszakítást nem a library kezeli -> interruptPin = -1)
+        si4735.setup(PIN_SI4735_RESET, -1, defaultBand, SI473X_ANALOG_AUDIO, XOSCEN_CRYSTAL, 1);
+#else
+        si4735.setup(PIN_SI4735_RESET, defaultBand);
+#endif
+
+        // A chip újraindult: az SSB patch már nincs bent, az állapota ismeretlen
+        ssbLoaded = false;
+        chipState.invalidate();
     }
 
     // Rendszer indítás van?
@@ -460,7 +811,7 @@ void Band::bandInit(bool sysStart) {
         // curretBand.prefMod = config.data.currentMode;
         // curretBand.varData.currFreq = config.data.currentFreq;
 
-        si4735.setVolume(config.data.currVolume);  // Hangerő
+        // A hangerőt a useBand() -> Si4735State küldi ki
     }
 }
 
@@ -478,26 +829,48 @@ void Band::bandSet(bool useDefaults) {
     // Demoduláció beállítása
     uint8_t currMod = currentBand.varData.currMod;
 
+#ifdef __DEBUG
+    uint32_t startMicros = micros();
+    bool patchWasLoaded = ssbLoaded;
+#endif
+
     // A sávhoz preferált demodulációs módot állítunk be?
     if (useDefaults) {
         // Átmásoljuk a preferált modulációs módot
         currMod = currentBand.varData.currMod = currentBand.pConstData->prefMod;
-        ssbLoaded = false;  // SSB patch betöltése szükséges
     }
 
-    if (currMod == AM or currMod == FM) {
-
-        ssbLoaded = false;  // FIXME: Ez kell? Band váltás után megint be kell tölteni az SSB-t?
-
-    } else if (currMod == LSB or currMod == USB or currMod == CW) {
-        if (ssbLoaded == false) {
-            this->loadSSB();
-        }
+    // Az SSB patch csak akkor kell, ha még nincs a chipen
+    // (A patch-et csak a chip újraindítása törli: FM mód, vagy a Band::bandInit())
+    if ((currMod == LSB or currMod == USB or currMod == CW) and !ssbLoaded and !this->loadSSB()) {
+        // Egyik sebességen sem sikerült a letöltés: patch nélkül csak AM-et tudunk, arra állunk vissza
+        DEBUG("Band::bandSet() -> SSB patch unavailable, falling back to AM\n");
+        currMod = currentBand.varData.currMod = AM;
+        Utils::beepError();
     }
 
+    // A sávszélességet és az antenna kapacitást is a useBand() küldi ki (csak ha változott)
     useBand();
-    setBandWidth();
 
-    // Antenna Tunning Capacitor beállítása
-    si4735.setTuneFrequencyAntennaCapacitor(currentBand.varData.antCap);
+#ifdef __DEBUG
+    DEBUG("Band::bandSet() -> mode: %s, switch time: %d msec, patch %s\n", bandModeDesc[currMod], (micros() - startMicros) / 1000,
+          patchWasLoaded ? "resident" : (ssbLoaded ? "downloaded" : "not used"));
+#endif
+}
+
+/**
+ * A szinkron AM (patch-elt firmware) audio sávszélessége az AM csatorna sávszélesség alapján
+ * Az AM csatornaszűrő kétoldalas, az SSB audio sávszélesség egyoldalas -> nagyjából a fele kell
+ *
+ * @return az SSB AUDIOBW értéke (0 = 1.2kHz, 1 = 2.2kHz, 2 = 3kHz, 3 = 4kHz)
+ */
+uint8_t Band::getSyncAmAudioBandwidth() {
+    switch (config.data.bwIdxAM) {
+        case 0:  // 6kHz
+            return 2;
+        case 1:  // 4kHz
+            return 1;
+        default:  // 3kHz és az alatt
+            return 0;
+    }
 }
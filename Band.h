@@ -4,6 +4,8 @@
 #include <SI4735.h>
 
 #include "Config.h"
+#include "Si4735State.h"
+#include "TuneEngine.h"
 #include "rtVars.h"
 
 // Band index
@@ -70,11 +72,21 @@ class Band {
     // Si4735 referencia
     SI4735 &si4735;
 
-    // SSB betöltve?
+    // SSB patch a chipen van?
+    // Csak a chip újraindítása (FM mód, bandInit) törli, AM-ben a patch-elt firmware szinkron AM módját használjuk
     bool ssbLoaded = false;
 
-    void setBandWidth();
-    void loadSSB();
+    // A chipre utoljára kiküldött állapot, band/mód váltáskor csak a különbségeket küldjük ki
+    Si4735State chipState;
+
+    // Nem blokkoló hangolás (rotary)
+    TuneEngine tuneEngine;
+
+    uint8_t getBandWidthForChip();
+    int8_t findBandFreqSegment(uint16_t freq);
+    void getAgcForChip(uint8_t &agcDisabled, uint8_t &agcIndex);
+    bool loadSSB();
+    uint8_t getSyncAmAudioBandwidth();
 
    public:
     // BandMode description
@@ -103,6 +115,16 @@ class Band {
      */
     void bandSet(bool useDefaults = false);
 
+    /**
+     * A chip állapot / property cache elérése (a redundáns I2C írások elkerüléséhez ezen keresztül írjunk)
+     */
+    inline Si4735State &getChipState() { return chipState; }
+
+    /**
+     * A nem blokkoló hangoló elérése
+     */
+    inline TuneEngine &getTuneEngine() { return tuneEngine; }
+
     /**
      * A Default Antenna Tuning Capacitor értékének lekérdezése
      * @return Az alapértelmezett antenna tuning capacitor értéke
@@ -141,6 +163,11 @@ class Band {
      */
     BandTable &getBandByIdx(uint8_t bandIdx);
 
+    /**
+     * A sávok száma
+     */
+    uint8_t getBandCount();
+
     /**
      *
      */
@@ -154,6 +181,24 @@ class Band {
      */
     int8_t getBandIdxByBandName(const char *bandName);
 
+    /**
+     * A frekvenciát tartalmazó sávok elkérése
+     *
+     * @param freq A frekvencia (FM: 10kHz, AM: kHz egységben)
+     * @param isFm FM frekvencia?
+     * @return A tartalmazó sávok bitmaszkja (bit = sáv index), 0, ha nincs ilyen sáv
+     */
+    uint32_t getBandMaskByFrequency(uint16_t freq, bool isFm);
+
+    /**
+     * A frekvenciát tartalmazó legszűkebb sáv indexének elkérése
+     *
+     * @param freq A frekvencia (FM: 10kHz, AM: kHz egységben)
+     * @param isFm FM frekvencia?
+     * @return A sáv indexe, vagy -1, ha nincs ilyen sáv
+     */
+    int8_t getBandIdxByFrequency(uint16_t freq, bool isFm);
+
     /**
      * Aktuális mód/modulációs típus (FM, AM, LSB, USB, CW)
      */
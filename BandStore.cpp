@@ -0,0 +1,209 @@
+#include "BandStore.h"
+
+#include "EepromManager.h"
+
+// A config (+ CRC) nem lóghat bele a sáv adatokba, és minden sávnak el kell férnie az EEPROM-ban
+static_assert(sizeof(EepromManager<Config_t>) <= BAND_STORE_EEPROM_ADDRESS, "A config nem fér el a sáv adatok előtt");
+static_assert(BAND_STORE_EEPROM_ADDRESS + sizeof(BandStoreHeader) + BAND_STORE_MAX_BANDS * sizeof(BandStoreRecord) <= EEPROM_SIZE, "A sáv adatok nem férnek el az EEPROM-ban");
+
+static_assert(BAND_STORE_GROUP_SIZE * sizeof(BandTableVar) <= FLASH_JOURNAL_MAX_PAYLOAD, "Egy sáv csoport nem fér el egy journal rekordban");
+static_assert(FLASH_JOURNAL_KEY_BANDS + BAND_STORE_GROUP_COUNT <= FLASH_JOURNAL_MAX_KEYS, "A sáv csoportok kilógnak a flash journal kulcs tartományából");
+
+/**
+ * A kezelt sávok száma
+ */
+uint8_t BandStore::getRecordCount() { return min(band.getBandCount(), (uint8_t)BAND_STORE_MAX_BANDS); }
+
+/**
+ * A csoport sávjainak száma
+ */
+uint8_t BandStore::getGroupBandCount(uint8_t group) {
+    int16_t remaining = getRecordCount() - group * BAND_STORE_GROUP_SIZE;
+    return constrain(remaining, 0, BAND_STORE_GROUP_SIZE);
+}
+
+/**
+ * A betöltött rekord értelmes a sávra?
+ */
+bool BandStore::isRecordValid(uint8_t bandIdx, const BandTableVar &var) {
+    const BandTableConst *pConstData = band.getBandByIdx(bandIdx).pConstData;
+    return var.currFreq >= pConstData->minimumFreq and var.currFreq <= pConstData->maximumFreq and var.currStep > 0 and var.currMod <= CW;
+}
+
+/**
+ * Betöltés a journal-ból
+ */
+bool BandStore::loadJournal() {
+
+    bool found = false;
+    uint8_t loaded = 0;
+    for (uint8_t group = 0; group < BAND_STORE_GROUP_COUNT; group++) {
+        uint8_t groupBands = getGroupBandCount(group);
+        if (groupBands == 0 or !flashJournal.contains(FLASH_JOURNAL_KEY_BANDS + group)) {
+            continue;
+        }
+        found = true;
+
+        // Ha a BandTableVar (vagy a sávok száma) változott, a rekord mérete eltér -> a csoport az alapértelmezett értékeken marad
+        BandTableVar vars[BAND_STORE_GROUP_SIZE];
+        if (!flashJournal.read(FLASH_JOURNAL_KEY_BANDS + group, vars, groupBands * sizeof(BandTableVar))) {
+            continue;
+        }
+        for (uint8_t i = 0; i < groupBands; i++) {
+            uint8_t bandIdx = group * BAND_STORE_GROUP_SIZE + i;
+            if (isRecordValid(bandIdx, vars[i])) {
+                band.getBandByIdx(bandIdx).varData = vars[i];
+                saved[bandIdx] = vars[i];
+                loaded++;
+            }
+        }
+    }
+
+    if (found) {
+        DEBUG("BandStore::loadJournal() -> %d/%d bands loaded\n", loaded, getRecordCount());
+    }
+    return found;
+}
+
+/**
+ * Betöltés az EEPROM-ból
+ */
+void BandStore::loadEeprom() {
+
+    EEPROM.begin(EEPROM_SIZE);
+
+    BandStoreHeader header;
+    EEPROM.get(BAND_STORE_EEPROM_ADDRESS, header);
+    if (header.magic != BAND_STORE_MAGIC or header.recordSize != sizeof(BandStoreRecord)) {
+        DEBUG("BandStore::loadEeprom() -> no saved band data\n");
+        return;  // A 'saved' üres -> az első checkSave() minden sávot kiment
+    }
+
+    // Ha a journal használható, a 'saved'-et üresen hagyjuk, így az első checkSave() a journal-ba írja át a sávokat
+    bool migrate = flashJournal.isReady();
+
+    uint8_t count = getRecordCount();
+    uint8_t loaded = 0;
+    for (uint8_t i = 0; i < min(count, header.recordCount); i++) {
+        BandStoreRecord record;
+        EEPROM.get(getRecordAddress(i), record);
+        if (record.crc == calcCRC16((uint8_t *)&record.var, sizeof(BandTableVar)) and isRecordValid(i, record.var)) {
+            band.getBandByIdx(i).varData = record.var;
+            if (!migrate) {
+                saved[i] = record.var;
+            }
+            loaded++;
+        }
+    }
+
+    DEBUG("BandStore::loadEeprom() -> %d/%d bands loaded%s\n", loaded, count, migrate ? ", migrating to the flash journal" : "");
+}
+
+/**
+ * A mentett sáv adatok betöltése a band táblába
+ */
+void BandStore::load() {
+
+    uint32_t start = micros();
+
+    if (!loadJournal()) {
+        loadEeprom();
+    }
+
+    DEBUG("BandStore::load() -> %d usec\n", micros() - start);
+}
+
+/**
+ * A változott sávok csoportjainak mentése a journal-ba
+ */
+bool BandStore::saveJournal() {
+
+    if (!flashJournal.isReady()) {
+        return false;
+    }
+
+    bool ok = true;
+    uint8_t written = 0;
+    for (uint8_t group = 0; group < BAND_STORE_GROUP_COUNT; group++) {
+        uint8_t groupBands = getGroupBandCount(group);
+        uint32_t groupMask = (((uint32_t)1 << groupBands) - 1) << (group * BAND_STORE_GROUP_SIZE);
+        if (groupBands == 0 or !(dirtyMask & groupMask)) {
+            continue;
+        }
+
+        // A csoport minden sávja egy rekordba kerül
+        BandTableVar vars[BAND_STORE_GROUP_SIZE];
+        for (uint8_t i = 0; i < groupBands; i++) {
+            vars[i] = band.getBandByIdx(group * BAND_STORE_GROUP_SIZE + i).varData;
+        }
+        if (!flashJournal.append(FLASH_JOURNAL_KEY_BANDS + group, vars, groupBands * sizeof(BandTableVar))) {
+            ok = false;
+            continue;  // A csoport dirty bitjei maradnak, az EEPROM-ba mentjük
+        }
+
+        memcpy(&saved[group * BAND_STORE_GROUP_SIZE], vars, groupBands * sizeof(BandTableVar));
+        dirtyMask &= ~groupMask;
+        written++;
+    }
+
+    DEBUG("BandStore::saveJournal() -> %d band groups saved to the flash journal\n", written);
+    return ok;
+}
+
+/**
+ * A változott sávok mentése az EEPROM-ba
+ */
+void BandStore::saveEeprom() {
+
+    uint8_t count = getRecordCount();
+
+    EEPROM.begin(EEPROM_SIZE);
+
+    BandStoreHeader header = {BAND_STORE_MAGIC, count, sizeof(BandStoreRecord)};
+    EEPROM.put(BAND_STORE_EEPROM_ADDRESS, header);
+
+    // Csak a változott rekordokat írjuk
+    uint8_t written = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!(dirtyMask & ((uint32_t)1 << i))) {
+            continue;
+        }
+        BandStoreRecord record;
+        record.var = band.getBandByIdx(i).varData;
+        record.crc = calcCRC16((uint8_t *)&record.var, sizeof(BandTableVar));
+        EEPROM.put(getRecordAddress(i), record);
+        saved[i] = record.var;
+        written++;
+    }
+    EEPROM.commit();
+    dirtyMask = 0;
+
+    DEBUG("BandStore::saveEeprom() -> %d band records saved to the EEPROM\n", written);
+}
+
+/**
+ * A változott sávok mentése, ha szükséges
+ */
+void BandStore::checkSave() {
+
+    uint8_t count = getRecordCount();
+
+    // Dirty bitek: a band tábla rekordjai bárhonnan közvetlenül módosulhatnak, ezért a mentett másolathoz hasonlítunk
+    for (uint8_t i = 0; i < count; i++) {
+        if (memcmp(&band.getBandByIdx(i).varData, &saved[i], sizeof(BandTableVar)) != 0) {
+            dirtyMask |= (uint32_t)1 << i;
+        }
+    }
+
+    if (dirtyMask == 0) {
+        DEBUG("BandStore::checkSave() -> There is no need to save the bands\n");
+        return;
+    }
+
+    // A journal nem használható (vagy írási hiba volt): a maradék változott sávok az EEPROM-ba
+    uint32_t start = micros();
+    if (!saveJournal()) {
+        saveEeprom();
+    }
+    DEBUG("BandStore::checkSave() -> %d usec\n", micros() - start);
+}
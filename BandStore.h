@@ -0,0 +1,113 @@
+#ifndef __BANDSTORE_H
+#define __BANDSTORE_H
+
+#include "Band.h"
+#include "FlashJournal.h"
+
+#define BAND_STORE_EEPROM_ADDRESS 512  // A config után, az EEPROM-ban itt kezdődnek a sávok adatai (régi formátum / tartalék)
+#define BAND_STORE_MAGIC 0x4253        // 'BS'
+#define BAND_STORE_MAX_BANDS 32        // A dirty bitmaszk mérete miatt
+#define BAND_STORE_GROUP_SIZE 8        // Ennyi sáv kerül egy journal rekordba
+#define BAND_STORE_GROUP_COUNT ((BAND_STORE_MAX_BANDS + BAND_STORE_GROUP_SIZE - 1) / BAND_STORE_GROUP_SIZE)
+
+/**
+ * A mentett sáv adatok fejléce
+ */
+struct BandStoreHeader {
+    uint16_t magic;
+    uint8_t recordCount;  // A mentett rekordok száma
+    uint8_t recordSize;   // Egy rekord mérete (ha a BandTableVar változik, nem töltjük be a régi adatokat)
+};
+
+/**
+ * Egy sáv EEPROM-ba mentett rekordja, saját CRC-vel, így a sérült rekordok egyenként eldobhatók
+ */
+struct BandStoreRecord {
+    BandTableVar var;
+    uint16_t crc;
+};
+
+/**
+ * A sávonkénti hangolási adatok (BandTableVar) mentése a flash journal-ba
+ *
+ * A sávokat BAND_STORE_GROUP_SIZE-os csoportokban, csoportonként egy journal rekordban tároljuk
+ * (FLASH_JOURNAL_KEY_BANDS + csoport index), a CRC-t a journal rekord adja. A legutóbb mentett állapot másolatát
+ * RAM-ban tartjuk, mentéskor ehhez hasonlítva sávonként jelöljük a változást (dirty bit), és csak a változott
+ * sávok csoportjait írjuk ki. Az EEPROM.commit() minden mentéskor a teljes szektort törölte, letiltott megszakításokkal,
+ * a journal viszont a FlashWriter-en keresztül ír.
+ *
+ * Az EEPROM-ot csak a korábbi formátum betöltésére (az első journal-os induláskor), és tartaléknak használjuk,
+ * ha a journal nem használható, vagy az írása nem sikerült.
+ */
+class BandStore {
+
+   private:
+    Band &band;
+
+    BandTableVar saved[BAND_STORE_MAX_BANDS];  // Az EEPROM-ban lévő állapot másolata
+    uint32_t dirtyMask = 0;                    // A mentésre váró sávok (bit = sáv index)
+
+    /**
+     * A kezelt sávok száma
+     */
+    uint8_t getRecordCount();
+
+    /**
+     * A csoport sávjainak száma (az utolsó csoport rövidebb lehet)
+     */
+    uint8_t getGroupBandCount(uint8_t group);
+
+    /**
+     * A sáv rekordjának EEPROM címe
+     */
+    inline uint16_t getRecordAddress(uint8_t bandIdx) { return BAND_STORE_EEPROM_ADDRESS + sizeof(BandStoreHeader) + bandIdx * sizeof(BandStoreRecord); }
+
+    /**
+     * A betöltött rekord értelmes a sávra?
+     */
+    bool isRecordValid(uint8_t bandIdx, const BandTableVar &var);
+
+    /**
+     * Betöltés a journal-ból
+     * @return false, ha a journal-ban még nincsenek sáv adatok
+     */
+    bool loadJournal();
+
+    /**
+     * Betöltés az EEPROM-ból (régi formátum / tartalék)
+     */
+    void loadEeprom();
+
+    /**
+     * A változott sávok csoportjainak mentése a journal-ba
+     * @return false, ha a journal nem használható, vagy írási hiba volt
+     */
+    bool saveJournal();
+
+    /**
+     * A változott sávok mentése az EEPROM-ba (tartalék)
+     */
+    void saveEeprom();
+
+   public:
+    /**
+     * Konstruktor
+     */
+    BandStore(Band &band) : band(band), saved{} {}
+
+    /**
+     * A mentett sáv adatok betöltése a band táblába
+     * (A hibás/hiányzó rekordok sávjai az alapértelmezett értékeken maradnak)
+     */
+    void load();
+
+    /**
+     * A változott sávok mentése, ha szükséges
+     */
+    void checkSave();
+};
+
+// A főprogramban definiálva
+extern BandStore bandStore;
+
+#endif  //__BANDSTORE_H
@@ -1,7 +1,65 @@
 #include "Config.h"
 
+#include "ConfigLegacy.h"
 #include "Si4735Utils.h"
 
+#include <cstddef>
+
+// A korábbi formátumban a config egy flash journal rekordba került
+static_assert(sizeof(Config_t) <= FLASH_JOURNAL_MAX_PAYLOAD, "A config nem fér el egy flash journal rekordban");
+
+#define CONFIG_FIELD(tag, name) {tag, offsetof(Config_t, name), sizeof(Config_t::name)}
+
+/**
+ * A config mezői a mezőnkénti mentéshez
+ * A tag azonosítja a tárolt mezőt (flash journal kulcs: FLASH_JOURNAL_KEY_CONFIG_FIELDS + tag), ezért egy mező tag-je
+ * nem változhat, és törölt mező tag-jét sem szabad újra kiosztani! Új mező új tag-et kap, a sorrend szabadon változhat.
+ */
+static constexpr StoreField CONFIG_FIELDS[] = {
+    CONFIG_FIELD(0, bandIdx),
+    CONFIG_FIELD(1, bwIdxAM),
+    CONFIG_FIELD(2, bwIdxFM),
+    CONFIG_FIELD(3, bwIdxMW),
+    CONFIG_FIELD(4, bwIdxSSB),
+    CONFIG_FIELD(5, ssIdxMW),
+    CONFIG_FIELD(6, ssIdxAM),
+    CONFIG_FIELD(7, ssIdxFM),
+    CONFIG_FIELD(8, currentBFO),
+    CONFIG_FIELD(9, currentBFOStep),
+    CONFIG_FIELD(10, currentBFOmanu),
+    CONFIG_FIELD(11, currentSquelch),
+    CONFIG_FIELD(12, squelchUsesRSSI),
+    CONFIG_FIELD(13, memScanPrioritySec),
+    CONFIG_FIELD(14, memScanPrioritySlot),
+    CONFIG_FIELD(15, rdsEnabled),
+    CONFIG_FIELD(16, rdsAfRssiThreshold),
+    CONFIG_FIELD(17, rdsAfMaxGapMsec),
+    CONFIG_FIELD(18, currVolume),
+    CONFIG_FIELD(19, agcGain),
+    CONFIG_FIELD(20, currentAGCgain),
+    CONFIG_FIELD(21, tftCalibrateData),
+    CONFIG_FIELD(22, tftBackgroundBrightness),
+    CONFIG_FIELD(23, tftDigitLigth),
+};
+#define CONFIG_FIELD_COUNT (sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]))
+
+static_assert(CONFIG_FIELD_COUNT <= 32, "A dirty maszk max. 32 mezőt kezel");
+static_assert(storeFieldTagsValid(CONFIG_FIELDS, CONFIG_FIELD_COUNT, FLASH_JOURNAL_KEY_BANDS - FLASH_JOURNAL_KEY_CONFIG_FIELDS - 1),
+              "A config mezők tag-jei nem egyediek, vagy kilógnak a flash journal kulcs tartományából");
+
+/**
+ * A mezők leírói a mezőnkénti mentéshez
+ */
+const StoreField *Config::getFields(uint8_t &count) {
+    count = CONFIG_FIELD_COUNT;
+    return CONFIG_FIELDS;
+}
+
+/**
+ * A séma verzió előtti firmware EEPROM tartalmának betöltése
+ */
+bool Config::loadLegacyEeprom() { return loadConfigV0Eeprom(data); }
+
 /**
  * Alapértelmezett readonly konfigurációs adatok
  */
@@ -33,8 +91,14 @@ const Config_t DEFAULT_CONFIG = {
     .currentSquelch = 0,
     .squelchUsesRSSI = true,  // A squlech RSSI alapú legyen?
 
+    // Memória szkenner
+    .memScanPrioritySec = 5,    // sec
+    .memScanPrioritySlot = -1,  // Nincs prioritásos csatorna
+
     // FM RDS
     .rdsEnabled = true,
+    .rdsAfRssiThreshold = 20,  // dBuV
+    .rdsAfMaxGapMsec = 150,
 
     // Hangerő
     .currVolume = 50,
@@ -7,6 +7,10 @@
 #define TFT_BACKGROUND_LED_MAX_BRIGHTNESS 255
 #define TFT_BACKGROUND_LED_MIN_BRIGHTNESS 5
 
+// A konfig séma verziója: csak akkor kell léptetni, ha egy mező jelentése változik (Config::migrate())
+// Új mező felvételéhez, a mezők átrendezéséhez nem kell, a mezőket a tag-jük azonosítja (Config.cpp)
+#define CONFIG_SCHEMA_VERSION 1
+
 // --------------------------------
 // Konfig struktúra típusdefiníció
 struct Config_t {
@@ -36,8 +40,14 @@ struct Config_t {
     uint8_t currentSquelch;
     bool squelchUsesRSSI;  // A squlech RSSI alapú legyen?
 
+    // Memória szkenner
+    uint8_t memScanPrioritySec;   // A prioritásos csatorna ellenőrzésének gyakorisága (0 -> kikapcsolva)
+    int16_t memScanPrioritySlot;  // A prioritásos memória csatorna slot-ja (-1 -> nincs)
+
     // FM RDS
     bool rdsEnabled;
+    uint8_t rdsAfRssiThreshold;  // Ez alatti RSSI esetén keresünk jobb AF-et (0 -> kikapcsolva)
+    int rdsAfMaxGapMsec;         // Az AF ellenőrzés alatti némítás maximális ideje
 
     // Hangerő
     uint8_t currVolume;
@@ -71,17 +81,27 @@ class Config : public StoreBase<Config_t> {
      */
     Config_t &r() override { return data; };
 
-   public:
     /**
-     * Konstruktor
-     * @param pData Pointer a konfigurációs adatokhoz
+     * Az alapértelmezett adatok
+     */
+    const Config_t &getDefaults() override { return DEFAULT_CONFIG; }
+
+    /**
+     * A mezők leírói a mezőnkénti mentéshez
      */
-    Config() : StoreBase<Config_t>(), data(DEFAULT_CONFIG) {}
+    const StoreField *getFields(uint8_t &count) override;
 
     /**
-     * Alapértelmezett adatok betöltése
+     * A séma verzió előtti firmware EEPROM tartalmának betöltése (ConfigLegacy.h)
+     */
+    bool loadLegacyEeprom() override;
+
+   public:
+    /**
+     * Konstruktor
+     * @param pData Pointer a konfigurációs adatokhoz
      */
-    void loadDefaults() override { memcpy(&data, &DEFAULT_CONFIG, sizeof(Config_t)); }
+    Config() : StoreBase<Config_t>(FLASH_JOURNAL_KEY_CONFIG, FLASH_JOURNAL_KEY_CONFIG_SCHEMA, FLASH_JOURNAL_KEY_CONFIG_FIELDS, CONFIG_SCHEMA_VERSION), data(DEFAULT_CONFIG) {}
 };
 
 // A főprogramban definiálva
@@ -0,0 +1,59 @@
+#include "ConfigLegacy.h"
+
+#include <cstddef>
+
+// A régi firmware struktúrájának mérete és elrendezése: ha ez változik, a régi EEPROM tartalom nem olvasható be
+static_assert(sizeof(ConfigV0_t) == 40, "A ConfigV0_t a régi firmware struktúrájának másolata, nem változhat");
+static_assert(offsetof(ConfigV0_t, currentBFOmanu) == 16 and offsetof(ConfigV0_t, tftCalibrateData) == 26, "A ConfigV0_t elrendezése nem változhat");
+
+/**
+ * A régi struktúra mezőinek átmásolása
+ */
+void convertConfigV0(const ConfigV0_t &v0, Config_t &data) {
+
+    data.bandIdx = v0.bandIdx;
+
+    data.bwIdxAM = v0.bwIdxAM;
+    data.bwIdxFM = v0.bwIdxFM;
+    data.bwIdxMW = v0.bwIdxMW;
+    data.bwIdxSSB = v0.bwIdxSSB;
+
+    data.ssIdxMW = v0.ssIdxMW;
+    data.ssIdxAM = v0.ssIdxAM;
+    data.ssIdxFM = v0.ssIdxFM;
+
+    data.currentBFO = v0.currentBFO;
+    data.currentBFOStep = v0.currentBFOStep;
+    data.currentBFOmanu = v0.currentBFOmanu;
+
+    data.currentSquelch = v0.currentSquelch;
+    data.squelchUsesRSSI = v0.squelchUsesRSSI;
+
+    data.rdsEnabled = v0.rdsEnabled;
+
+    data.currVolume = v0.currVolume;
+
+    data.agcGain = v0.agcGain;
+    data.currentAGCgain = v0.currentAGCgain;
+
+    memcpy(data.tftCalibrateData, v0.tftCalibrateData, sizeof(data.tftCalibrateData));
+    data.tftBackgroundBrightness = v0.tftBackgroundBrightness;
+    data.tftDigitLigth = v0.tftDigitLigth;
+}
+
+/**
+ * A régi formátumú EEPROM tartalom betöltése
+ */
+bool loadConfigV0Eeprom(Config_t &data) {
+
+    ConfigV0_t v0 = {};
+    bool valid = false;
+    EepromManager<ConfigV0_t>::getIfValid(v0, valid);
+    if (!valid) {
+        return false;
+    }
+
+    convertConfigV0(v0, data);
+    DEBUG("loadConfigV0Eeprom() -> pre-schema EEPROM config converted\n");
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef __CONFIGLEGACY_H
+#define __CONFIGLEGACY_H
+
+#include "Config.h"
+
+/**
+ * A séma verzió előtti firmware Config_t struktúrájának befagyasztott másolata
+ *
+ * Ez a firmware a teljes struktúrát CRC-vel az EEPROM elejére mentette. Azóta a Config_t közepére új mezők kerültek,
+ * így a régi EEPROM tartalom az új struktúrával beolvasva CRC hibás lenne (és az alapértelmezett adatok felülírnák).
+ * Ezért a régi tartalmat ezzel a struktúrával olvassuk be, és a mezőket név szerint másoljuk át.
+ * Ezt a struktúrát nem szabad módosítani!
+ */
+struct ConfigV0_t {
+    uint8_t bandIdx;
+
+    uint8_t bwIdxAM;
+    uint8_t bwIdxFM;
+    uint8_t bwIdxMW;
+    uint8_t bwIdxSSB;
+
+    uint8_t ssIdxMW;
+    uint8_t ssIdxAM;
+    uint8_t ssIdxFM;
+
+    int currentBFO;
+    uint8_t currentBFOStep;
+    int currentBFOmanu;
+
+    uint8_t currentSquelch;
+    bool squelchUsesRSSI;
+
+    bool rdsEnabled;
+
+    uint8_t currVolume;
+
+    uint8_t agcGain;
+    uint8_t currentAGCgain;
+
+    uint16_t tftCalibrateData[5];
+    uint8_t tftBackgroundBrightness;
+    bool tftDigitLigth;
+};
+
+/**
+ * A régi struktúra mezőinek átmásolása (az új mezők a data-ban lévő értéküket tartják meg)
+ */
+void convertConfigV0(const ConfigV0_t &v0, Config_t &data);
+
+/**
+ * A régi formátumú EEPROM tartalom betöltése
+ * @return false, ha az EEPROM-ban nincs érvényes (CRC helyes) régi formátumú config, a data ilyenkor nem változik
+ */
+bool loadConfigV0Eeprom(Config_t &data);
+
+#endif  // __CONFIGLEGACY_H
@@ -1,5 +1,6 @@
 #include "DisplayBase.h"
 
+#include "AudioMute.h"
 #include "ValueChangeDialog.h"
 
 namespace DisplayConstants {
@@ -386,11 +387,11 @@ void DisplayBase::buildVerticalScreenButtons(BuildButtonData screenVButtonsData[
 
     // Kötelező vertikális Képernyőgombok definiálása
     DisplayBase::BuildButtonData mandatoryVButtons[] = {
-        {"Mute", TftButton::ButtonType::Toggleable, TFT_TOGGLE_BUTTON_STATE(rtv::muteStat)},         //
-        {"Volum", TftButton::ButtonType::Pushable},                                                  //
-        {"AGC", TftButton::ButtonType::Toggleable, TFT_TOGGLE_BUTTON_STATE(si4735.isAgcEnabled())},  //
-        {"Att", TftButton::ButtonType::Pushable},                                                    //
-        {"Setup", TftButton::ButtonType::Pushable},                                                  //
+        {"Mute", TftButton::ButtonType::Toggleable, TFT_TOGGLE_BUTTON_STATE(rtv::muteStat)},                       //
+        {"Volum", TftButton::ButtonType::Pushable},                                                                //
+        {"AGC", TftButton::ButtonType::Toggleable, TFT_TOGGLE_BUTTON_STATE(band.getChipState().isAgcEnabled())},  //
+        {"Att", TftButton::ButtonType::Pushable},                                                                  //
+        {"Setup", TftButton::ButtonType::Pushable},                                                                //
     };
     uint8_t mandatoryVButtonsLength = ARRAY_ITEM_COUNT(mandatoryVButtons);
 
@@ -439,8 +440,11 @@ void DisplayBase::buildHorizontalScreenButtons(BuildButtonData screenHButtonsDat
         {"Band", TftButton::ButtonType::Pushable},   //
         {"DeMod", TftButton::ButtonType::Pushable},  //
         {"BndW", TftButton::ButtonType::Pushable, band.getCurrentBand().varData.currMod == FM ? TftButton::ButtonState::Disabled : TftButton::ButtonState::Off},
-        {"Step", TftButton::ButtonType::Pushable},  //
-        {"Scan", TftButton::ButtonType::Pushable},  //
+        {"Step", TftButton::ButtonType::Pushable},   //
+        {"Scan", TftButton::ButtonType::Pushable},   //
+        {"Memo", TftButton::ButtonType::Pushable},   //
+        {"MScan", TftButton::ButtonType::Pushable},  //
+        {"Prio", TftButton::ButtonType::Pushable},   //
     };
     uint8_t mandatoryHButtonsLength = ARRAY_ITEM_COUNT(mandatoryHButtons);
 
@@ -502,19 +506,19 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
     if (STREQ("Mute", event.label)) {
         // Némítás
         rtv::muteStat = event.state == TftButton::ButtonState::On;
-        Si4735Utils::si4735.setAudioMute(rtv::muteStat);
+        audioMute.set(AudioMute::Reason::User, rtv::muteStat);
         processed = true;
 
     } else if (STREQ("Volum", event.label)) {
         // Hangerő állítása
         this->pDialog = new ValueChangeDialog(this, this->tft, 250, 150, F("Volume"), F("Value:"),                                                              //
                                               &config.data.currVolume, (uint8_t)DisplayConstants::VolumeMin, (uint8_t)DisplayConstants::VolumeMax, (uint8_t)1,  //
-                                              [this](uint8_t newValue) { si4735.setVolume(newValue); });
+                                              [this](uint8_t newValue) { band.getChipState().setVolume(newValue); });
         processed = true;
     } else if (STREQ("AGC", event.label)) {  // Automatikus AGC
 
         bool stateOn = (event.state == TftButton::ButtonState::On);
-        config.data.agcGain = stateOn ? static_cast<uint8_t>(Si4735Utils::AgcGainMode::Automatic) : static_cast<uint8_t>(Si4735Utils::AgcGainMode::Off);
+        config.set(config.data.agcGain, stateOn ? static_cast<uint8_t>(Si4735Utils::AgcGainMode::Automatic) : static_cast<uint8_t>(Si4735Utils::AgcGainMode::Off));
 
         Si4735Utils::checkAGC();
 
@@ -538,12 +542,12 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
 #define MX_FM_AGC_GAIN 26
 #define MX_AM_AGC_GAIN 37
         uint8_t maxValue = si4735.isCurrentTuneFM() ? MX_FM_AGC_GAIN : MX_AM_AGC_GAIN;
-        config.data.agcGain = static_cast<uint8_t>(Si4735Utils::AgcGainMode::Manual);  // 2
+        config.set(config.data.agcGain, static_cast<uint8_t>(Si4735Utils::AgcGainMode::Manual));  // 2
 
         DisplayBase::pDialog = new ValueChangeDialog(this, DisplayBase::tft, 270, 150, F("RF Attennuator"), F("Value:"),      //
                                                      &config.data.currentAGCgain, (uint8_t)1, (uint8_t)maxValue, (uint8_t)1,  //
                                                      [this](uint8_t currentAGCgain) {
-                                                         si4735.setAutomaticGainControl(1, currentAGCgain);
+                                                         band.getChipState().setAutomaticGainControl(1, currentAGCgain);
                                                          DisplayBase::drawAgcAttStatus(true);
                                                      });
         processed = true;
@@ -566,7 +570,7 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
             this, DisplayBase::tft, 400, 180, F("HAM Radio Bands"), hamBands, hamBandCount,  //
             [this](TftButton::ButtonTouchEvent event) {
                 // Átállítjuk a használni kívánt BAND indexet
-                config.data.bandIdx = band.getBandIdxByBandName(event.label);
+                config.set(config.data.bandIdx, band.getBandIdxByBandName(event.label));
 
                 // Megkeressük, hogy ez FM vagy AM-e és arra állítjuk a display-t
                 ::newDisplay = band.getCurrentBandType() == FM_BAND_TYPE ? DisplayBase::DisplayType::fm : DisplayBase::DisplayType::am;
@@ -584,7 +588,7 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
             this, DisplayBase::tft, 400, 250, F("All Radio Bands"), bandNames, bandCount,
             [this](TftButton::ButtonTouchEvent event) {
                 // Átállítjuk a használni kívánt BAND indexet
-                config.data.bandIdx = band.getBandIdxByBandName(event.label);
+                config.set(config.data.bandIdx, band.getBandIdxByBandName(event.label));
 
                 // Megkeressük, hogy ez FM vagy AM-e és arra állítjuk a display-t
                 ::newDisplay = band.getCurrentBandType() == FM_BAND_TYPE ? DisplayBase::DisplayType::fm : DisplayBase::DisplayType::am;
@@ -613,7 +617,7 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
                 // CW reset
                 if (newMod != CW and rtv::CWShift == true) {
                     currentBand.varData.lastBFO = 0;  // CW_SHIFT_FREQUENCY;
-                    config.data.currentBFO = currentBand.varData.lastBFO;
+                    config.set(config.data.currentBFO, currentBand.varData.lastBFO);
                     rtv::CWShift = false;
                 }
 
@@ -669,11 +673,11 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
                 // A megnyomott gomb indexének kikeresése
                 uint8_t currMod = band.getCurrentBand().varData.currMod;  // Demodulációs mód
                 if (currMod == AM) {
-                    config.data.bwIdxAM = band.getBandWidthIndexByLabel(Band::bandWidthAM, event.label);
+                    config.set(config.data.bwIdxAM, band.getBandWidthIndexByLabel(Band::bandWidthAM, event.label));
                 } else if (currMod == FM) {
-                    config.data.bwIdxFM = band.getBandWidthIndexByLabel(Band::bandWidthFM, event.label);
+                    config.set(config.data.bwIdxFM, band.getBandWidthIndexByLabel(Band::bandWidthFM, event.label));
                 } else {
-                    config.data.bwIdxSSB = band.getBandWidthIndexByLabel(Band::bandWidthSSB, event.label);
+                    config.set(config.data.bwIdxSSB, band.getBandWidthIndexByLabel(Band::bandWidthSSB, event.label));
                 }
                 band.bandSet();
             },
@@ -719,11 +723,11 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
 
                 // Beállítjuk a konfigban a stepSize-t
                 if (currentBandType == MW_BAND_TYPE or currentBandType == LW_BAND_TYPE) {
-                    config.data.ssIdxMW = btnIdx;
+                    config.set(config.data.ssIdxMW, btnIdx);
                 } else if (currMod == FM) {
-                    config.data.ssIdxFM = btnIdx;
+                    config.set(config.data.ssIdxFM, btnIdx);
                 } else {
-                    config.data.ssIdxAM = btnIdx;
+                    config.set(config.data.ssIdxAM, btnIdx);
                 }
                 Si4735Utils::setStep();
             },
@@ -731,14 +735,76 @@ bool DisplayBase::processMandatoryButtonTouchEvent(TftButton::ButtonTouchEvent &
         processed = true;
 
     } else if (STREQ("Scan", event.label)) {
+        // A sáv szkenner hangol, a memória szkennelést leállítjuk
+        memoryScanner.stop();
+
         // Képernyő váltás !!!
         ::newDisplay = DisplayBase::DisplayType::freqScan;
         processed = true;
+
+    } else if (STREQ("Memo", event.label)) {
+        // Az aktuális állomás mentése memória csatornának (ha még nincs ilyen)
+        MemoryRecord record;
+        getCurrentStationMemory(record);
+        if (memoryStore.findSlotByFrequency(record.freqHz) < 0 and memoryStore.add(record) >= 0) {
+            Utils::beepTick();
+        } else {
+            Utils::beepError();
+        }
+        processed = true;
+
+    } else if (STREQ("MScan", event.label)) {
+        // Memória szkennelés indítása/leállítása
+        if (memoryScanner.isActive()) {
+            memoryScanner.stop();
+        } else if (!memoryScanner.start()) {
+            Utils::beepError();  // Nincs memória csatorna a sávban
+        }
+        processed = true;
+
+    } else if (STREQ("Prio", event.label)) {
+        // Az aktuális frekvencián lévő memória csatorna lesz a prioritásos, ha már az volt, akkor töröljük
+        MemoryRecord record;
+        getCurrentStationMemory(record);
+        int16_t slot = memoryStore.findSlotByFrequency(record.freqHz);
+        if (slot < 0) {
+            Utils::beepError();  // Előbb el kell menteni a csatornát
+        } else {
+            memoryScanner.setPrioritySlot(slot == config.data.memScanPrioritySlot ? -1 : slot);
+            Utils::beepTick();
+        }
+        processed = true;
     }
 
     return processed;
 }
 
+/**
+ * Az aktuális állomás memória csatorna rekordja
+ */
+void DisplayBase::getCurrentStationMemory(MemoryRecord &record) {
+
+    BandTable &currentBand = band.getCurrentBand();
+    uint8_t currMod = currentBand.varData.currMod;
+    bool isSsb = currMod == LSB or currMod == USB or currMod == CW;
+
+    memset(&record, 0, sizeof(record));
+    record.bandIdx = config.data.bandIdx;
+    record.mod = currMod;
+
+    if (currMod == FM) {
+        record.freqHz = (uint32_t)currentBand.varData.currFreq * 10000;
+        record.bandwidth = config.data.bwIdxFM;
+    } else {
+        // SSB/CW-ben a kijelzett frekvencia a BFO-val eltolt érték (lásd AmDisplay::handleRotary())
+        record.bfo = isSsb ? config.data.currentBFO : 0;
+        record.freqHz = (uint32_t)currentBand.varData.currFreq * 1000 - record.bfo;
+        record.bandwidth = isSsb ? config.data.bwIdxSSB : config.data.bwIdxAM;
+    }
+
+    snprintf(record.name, sizeof(record.name), "%s %lu", band.getCurrentBandName(), record.freqHz / 1000);
+}
+
 /**
  * Konstruktor
  */
@@ -9,6 +9,8 @@
 #include "DialogBase.h"
 #include "IDialogParent.h"
 #include "IGuiEvents.h"
+#include "MemoryScanner.h"
+#include "MemoryStore.h"
 #include "MessageDialog.h"
 #include "MultiButtonDialog.h"
 #include "Si4735Utils.h"
@@ -37,6 +39,28 @@ class DisplayBase : public Si4735Utils, public IGuiEvents, public IDialogParent
     // Lehetséges képernyő típusok
     enum DisplayType { none, fm, am, freqScan, screenSaver, setup };
 
+    /**
+     * Képernyő típus neve
+     */
+    static const char *decodeDisplayType(DisplayType displayType) {
+
+        switch (displayType) {
+            case fm:
+                return "FM";
+            case am:
+                return "AM";
+            case freqScan:
+                return "FreqScan";
+            case screenSaver:
+                return "ScreenSaver";
+            case setup:
+                return "Setup";
+            case none:
+            default:
+                return "none";
+        }
+    }
+
    private:
     // Gombok orientációja
     enum ButtonOrientation { Horizontal, Vertical };
@@ -152,6 +176,11 @@ class DisplayBase : public Si4735Utils, public IGuiEvents, public IDialogParent
      */
     TftButton *findButtonByLabel(const char *label);
 
+    /**
+     * Az aktuális állomás memória csatorna rekordja (SSB/CW esetén a BFO-val eltolt frekvenciával)
+     */
+    void getCurrentStationMemory(MemoryRecord &record);
+
     /**
      * Közös gombok touch handlere
      */
@@ -178,6 +207,11 @@ class DisplayBase : public Si4735Utils, public IGuiEvents, public IDialogParent
      */
     inline DialogBase *getPDialog() { return pDialog; }
 
+    /**
+     * Az éppen aktív gyorsítási görbe: ha van nyitott dialóg, akkor azé, egyébként a képernyőé
+     */
+    inline const RotaryEncoder::AccelerationCurve &getActiveAccelerationCurve() { return pDialog ? pDialog->getAccelerationCurve() : getAccelerationCurve(); }
+
     /**
      * A dialog által átadott megnyomott gomb adatai
      * Az IDialogParent-ből jön, a dialóg hívja, ha nyomtak rajta valamit
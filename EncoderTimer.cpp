@@ -0,0 +1,59 @@
+#include "EncoderTimer.h"
+
+#include "utils.h"
+
+RotaryEncoder *EncoderTimer::pEncoder = nullptr;
+uint8_t EncoderTimer::alarmNum = 0;
+uint32_t EncoderTimer::intervalUsec = 1000;
+volatile uint32_t EncoderTimer::target = 0;
+volatile uint32_t EncoderTimer::maxJitterUsec = 0;
+volatile uint32_t EncoderTimer::maxWriteJitterUsec = 0;
+volatile bool EncoderTimer::flashWriteActive = false;
+
+/**
+ * Az alarm megszakítás kezelője (RAM-ban, flash hozzáférés nélkül)
+ */
+void __not_in_flash_func(EncoderTimer::alarmIrqHandler)() {
+
+    // Megszakítás nyugtázása (write-1-to-clear)
+    timer_hw->intr = 1u << alarmNum;
+
+    uint32_t now = timer_hw->timerawl;
+    uint32_t jitter = now - target;
+    if (jitter > maxJitterUsec) {
+        maxJitterUsec = jitter;
+    }
+    if (flashWriteActive and jitter > maxWriteJitterUsec) {
+        maxWriteJitterUsec = jitter;
+    }
+
+    // Újraélesítés az előző céltól (ha nagyon lemaradtunk, akkor a mostani időtől)
+    target += intervalUsec;
+    if ((int32_t)(target - now) <= 0) {
+        target = now + intervalUsec;
+    }
+    timer_hw->alarm[alarmNum] = target;
+
+    pEncoder->service();
+}
+
+/**
+ * Indítás
+ */
+void EncoderTimer::begin(RotaryEncoder &encoder, uint32_t intervalUsec) {
+
+    pEncoder = &encoder;
+    EncoderTimer::intervalUsec = intervalUsec;
+
+    alarmNum = hardware_alarm_claim_unused(true);
+    uint8_t irqNum = getIrqNum();
+
+    irq_set_exclusive_handler(irqNum, alarmIrqHandler);
+    hw_set_bits(&timer_hw->inte, 1u << alarmNum);
+    irq_set_enabled(irqNum, true);
+
+    target = timer_hw->timerawl + intervalUsec;
+    timer_hw->alarm[alarmNum] = target;
+
+    DEBUG("EncoderTimer::begin() -> alarm: %d, interval: %d usec\n", alarmNum, intervalUsec);
+}
@@ -0,0 +1,68 @@
+#ifndef __ENCODERTIMER_H
+#define __ENCODERTIMER_H
+
+#include <Arduino.h>
+#include <hardware/irq.h>
+#include <hardware/timer.h>
+
+#include "RotaryEncoder.h"
+
+/**
+ * A rotary encoder periodikus kiszolgálása egy hardware alarm megszakításból
+ *
+ * A megszakítás kezelő és a RotaryEncoder::service() a RAM-ból fut, és csak a timer és SIO regisztereket használja
+ * (a flash-t nem), így a flash írás/törlés alatt (amikor az XIP áll) is fut tovább, az encoder nem veszít lépést.
+ * Az alarm-ot minden híváskor az előző céltól számolva élesítjük újra, így a késés nem halmozódik.
+ *
+ * A jitter a megszakítás tényleges és tervezett időpontja közötti eltérés. Külön mérjük a legnagyobb értéket
+ * a flash írás alatt (FlashWriter), hogy lássuk, a flash művelet tényleg nem tartja fel a megszakítást.
+ */
+class EncoderTimer {
+
+   private:
+    // A megszakítás kezelő RAM-ból futó statikus függvény, ezért az állapot is statikus
+    static RotaryEncoder *pEncoder;
+    static uint8_t alarmNum;
+    static uint32_t intervalUsec;
+    static volatile uint32_t target;  // A következő megszakítás tervezett ideje (timer usec)
+
+    // Jitter mérés
+    static volatile uint32_t maxJitterUsec;       // Az indulás óta
+    static volatile uint32_t maxWriteJitterUsec;  // A flash írás alatt (a FlashWriter nullázza)
+    static volatile bool flashWriteActive;
+
+    /**
+     * Az alarm megszakítás kezelője (RAM-ban)
+     */
+    static void alarmIrqHandler();
+
+   public:
+    /**
+     * Indítás
+     * @param encoder a kiszolgálandó encoder
+     * @param intervalUsec a hívás periódusideje usec-ben
+     */
+    static void begin(RotaryEncoder &encoder, uint32_t intervalUsec);
+
+    /**
+     * Az alarm megszakítás száma (a FlashWriter ezt engedi a flash írás alatt)
+     */
+    static inline uint8_t getIrqNum() { return TIMER_IRQ_0 + alarmNum; }
+
+    /**
+     * Flash írás kezdete / vége (a FlashWriter hívja)
+     */
+    static inline void flashWriteBegin() {
+        maxWriteJitterUsec = 0;
+        flashWriteActive = true;
+    }
+    static inline void flashWriteEnd() { flashWriteActive = false; }
+
+    /**
+     * A legnagyobb jitter usec-ben
+     */
+    static inline uint32_t getMaxJitterUsec() { return maxJitterUsec; }
+    static inline uint32_t getMaxWriteJitterUsec() { return maxWriteJitterUsec; }
+};
+
+#endif  //__ENCODERTIMER_H
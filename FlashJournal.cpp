@@ -0,0 +1,346 @@
+#include "FlashJournal.h"
+
+#include <CRC.h>
+
+#include "FlashWriter.h"
+#include "utils.h"
+
+// Linker szimbólumok: a LittleFS terület kezdete, a program vége a flash-ben
+extern uint8_t _FS_start;
+extern uint8_t __flash_binary_end;
+
+// Egy rekord férjen el egy üres szektor felében (a kulcsok élő rekordjai együtt sem lehetnek nagyobbak egy szektornál, ezt a hívók ellenőrzik)
+static_assert(sizeof(FlashJournalSectorHeader) + 2 * (sizeof(FlashJournalRecordHeader) + FLASH_JOURNAL_MAX_PAYLOAD) < FLASH_SECTOR_SIZE,
+              "A journal rekord túl nagy egy szektorhoz");
+static_assert(FLASH_JOURNAL_SECTORS >= 2, "A journal gyűrűhöz legalább 2 szektor kell");
+
+/**
+ * Bájtok programozása a gyűrű adott helyére (lapokra bontva, a lap többi része 0xFF -> nem változik)
+ */
+void FlashJournal::programBytes(uint32_t offset, const uint8_t *data, uint32_t length) {
+
+    uint8_t page[FLASH_PAGE_SIZE];
+
+    while (length > 0) {
+        uint32_t pageStart = offset & ~(FLASH_PAGE_SIZE - 1);
+        uint32_t inPage = offset - pageStart;
+        uint32_t chunk = min(length, (uint32_t)FLASH_PAGE_SIZE - inPage);
+
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page + inPage, data, chunk);
+        FlashWriter::program(regionOffset + pageStart, page, FLASH_PAGE_SIZE);
+
+        offset += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+/**
+ * Egy szektor törlése
+ */
+void FlashJournal::eraseSector(uint8_t sector) {
+    FlashWriter::eraseSector(regionOffset + sector * FLASH_SECTOR_SIZE);
+    eraseCount++;
+}
+
+/**
+ * A terület törölt (csupa 0xFF)?
+ */
+bool FlashJournal::isErased(uint32_t offset, uint32_t length) {
+    const uint8_t *p = flashPtr(offset);
+    for (uint32_t i = 0; i < length; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Egy szektor rekordjainak végigolvasása induláskor
+ */
+uint32_t FlashJournal::scanSector(uint8_t sector, uint32_t &maxSeq) {
+
+    uint32_t base = sector * FLASH_SECTOR_SIZE;
+
+    FlashJournalSectorHeader sectorHeader;
+    memcpy(&sectorHeader, flashPtr(base), sizeof(sectorHeader));
+    if (sectorHeader.magic != FLASH_JOURNAL_SECTOR_MAGIC) {
+        // Nem formázott (vagy félbeszakadt törlés): írás előtt törölni kell
+        return FLASH_SECTOR_SIZE;
+    }
+
+    uint32_t offset = sizeof(FlashJournalSectorHeader);
+    while (offset + sizeof(FlashJournalRecordHeader) <= FLASH_SECTOR_SIZE) {
+
+        FlashJournalRecordHeader header;
+        memcpy(&header, flashPtr(base + offset), sizeof(header));
+
+        // Szabad hely? Csak akkor írunk ide, ha a szektor maradéka tényleg törölt
+        if (header.magic == 0xFFFF) {
+            return isErased(base + offset, FLASH_SECTOR_SIZE - offset) ? offset : FLASH_SECTOR_SIZE;
+        }
+
+        // Sérült fejléc: a hossz sem megbízható, a szektor maradékát nem használjuk
+        if (header.magic != FLASH_JOURNAL_RECORD_MAGIC or header.length > FLASH_JOURNAL_MAX_PAYLOAD or offset + recordSize(header.length) > FLASH_SECTOR_SIZE) {
+            DEBUG("FlashJournal::scanSector() -> corrupt header, sector: %d, offset: %d\n", sector, offset);
+            return FLASH_SECTOR_SIZE;
+        }
+
+        // A félbeszakadt írás rekordját (hibás CRC) átugorjuk
+        uint16_t crc = calcCRC16((uint8_t *)flashPtr(base + offset + 4), sizeof(FlashJournalRecordHeader) - 4 + header.length);
+        if (crc == header.crc and header.key < FLASH_JOURNAL_MAX_KEYS) {
+            LatestRecord &rec = latest[header.key];
+            if (rec.offset == 0 or header.seq > rec.seq) {
+                rec.offset = base + offset;
+                rec.seq = header.seq;
+                rec.length = header.length;
+            }
+            if (header.seq > maxSeq) {
+                maxSeq = header.seq;
+            }
+        } else {
+            DEBUG("FlashJournal::scanSector() -> torn record dropped, sector: %d, offset: %d\n", sector, offset);
+        }
+
+        offset += recordSize(header.length);
+    }
+
+    return offset;
+}
+
+/**
+ * Egy rekord kiírása az aktuális szektor szabad helyére
+ */
+bool FlashJournal::writeRecord(uint8_t key, const uint8_t *data, uint16_t length) {
+
+    uint32_t size = recordSize(length);
+    if (writeOffset + size > FLASH_SECTOR_SIZE) {
+        return false;
+    }
+
+    // A rekord összeállítása RAM-ban (az adat akár a flash-ből is jöhet, programozás közben az nem olvasható)
+    uint8_t buffer[recordSize(FLASH_JOURNAL_MAX_PAYLOAD)];
+    memset(buffer, 0xFF, size);
+
+    FlashJournalRecordHeader header;
+    header.magic = FLASH_JOURNAL_RECORD_MAGIC;
+    header.length = length;
+    header.key = key;
+    header.reserved = 0;
+    header.seq = nextSeq;
+    memcpy(buffer, &header, sizeof(header));
+    if (length > 0) {
+        memcpy(buffer + sizeof(header), data, length);
+    }
+
+    header.crc = calcCRC16(buffer + 4, sizeof(header) - 4 + length);
+    memcpy(buffer, &header, sizeof(header));
+
+    uint32_t offset = currentSector * FLASH_SECTOR_SIZE + writeOffset;
+    programBytes(offset, buffer, size);
+
+    // Visszaolvasás: ha nem sikerült, a szektor maradékát nem használjuk
+    if (memcmp(flashPtr(offset), buffer, size) != 0) {
+        DEBUG("FlashJournal::writeRecord() -> verify error, sector: %d, offset: %d\n", currentSector, writeOffset);
+        writeOffset = FLASH_SECTOR_SIZE;
+        return false;
+    }
+
+    latest[key] = {offset, nextSeq, length};
+    nextSeq++;
+    writeOffset += size;
+    appendCount++;
+
+    return true;
+}
+
+/**
+ * Szektor formázása: törlés, fejléc írás
+ */
+void FlashJournal::formatSector(uint8_t sector) {
+
+    uint32_t base = sector * FLASH_SECTOR_SIZE;
+
+    // A törlések számát visszük tovább
+    FlashJournalSectorHeader header;
+    memcpy(&header, flashPtr(base), sizeof(header));
+    header.eraseCount = header.magic == FLASH_JOURNAL_SECTOR_MAGIC ? header.eraseCount + 1 : 1;
+    header.magic = FLASH_JOURNAL_SECTOR_MAGIC;
+
+    if (!isErased(base, FLASH_SECTOR_SIZE)) {
+        eraseSector(sector);
+    }
+    programBytes(base, (const uint8_t *)&header, sizeof(header));
+
+    DEBUG("FlashJournal::formatSector() -> sector: %d, erase count: %d\n", sector, header.eraseCount);
+}
+
+/**
+ * A szektor formázott és üres (a fejléc után csupa 0xFF)?
+ */
+bool FlashJournal::isFormattedEmpty(uint8_t sector) {
+    uint32_t base = sector * FLASH_SECTOR_SIZE;
+    const FlashJournalSectorHeader *header = (const FlashJournalSectorHeader *)flashPtr(base);
+    return header->magic == FLASH_JOURNAL_SECTOR_MAGIC and isErased(base + sizeof(FlashJournalSectorHeader), FLASH_SECTOR_SIZE - sizeof(FlashJournalSectorHeader));
+}
+
+/**
+ * Szektor megnyitása írásra (ha még nincs előkészítve: törlés, fejléc írás)
+ */
+void FlashJournal::openSector(uint8_t sector) {
+
+    if (!(sector == preparedSector and isFormattedEmpty(sector))) {
+        formatSector(sector);
+    }
+    preparedSector = -1;
+
+    // Ha valami mégis itt maradt volna (nem sikerült az áthelyezés), az elveszett
+    for (uint8_t key = 0; key < FLASH_JOURNAL_MAX_KEYS; key++) {
+        if (latest[key].offset != 0 and latest[key].offset / FLASH_SECTOR_SIZE == sector) {
+            DEBUG("FlashJournal::openSector() -> record lost, key: %d\n", key);
+            latest[key].offset = 0;
+        }
+    }
+
+    currentSector = sector;
+    writeOffset = sizeof(FlashJournalSectorHeader);
+}
+
+/**
+ * A szektor még élő rekordjainak átmásolása az aktuális szektorba
+ */
+void FlashJournal::relocateLive(uint8_t sector) {
+
+    for (uint8_t key = 0; key < FLASH_JOURNAL_MAX_KEYS; key++) {
+        LatestRecord &rec = latest[key];
+        if (rec.offset != 0 and rec.offset / FLASH_SECTOR_SIZE == sector) {
+            if (!writeRecord(key, flashPtr(rec.offset + sizeof(FlashJournalRecordHeader)), rec.length)) {
+                DEBUG("FlashJournal::relocateLive() -> no room, key: %d\n", key);
+            }
+        }
+    }
+}
+
+/**
+ * Továbblépés a gyűrű következő szektorára
+ */
+void FlashJournal::advanceSector() {
+
+    uint8_t next = (currentSector + 1) % FLASH_JOURNAL_SECTORS;
+    openSector(next);
+
+    // A rákövetkező szektor élő rekordjait most hozzuk át, így az a következő váltáskor gond nélkül törölhető
+    relocateLive((next + 1) % FLASH_JOURNAL_SECTORS);
+}
+
+/**
+ * A következő szektor előkészítése (törlés, fejléc írás) üresjáratban
+ */
+void FlashJournal::loop() {
+
+    if (!ready or preparedSector >= 0) {
+        return;
+    }
+
+    // Csak akkor törölhető, ha már nincs benne élő rekord (az áthelyezés nem sikerült -> majd a megnyitáskor)
+    uint8_t next = (currentSector + 1) % FLASH_JOURNAL_SECTORS;
+    for (uint8_t key = 0; key < FLASH_JOURNAL_MAX_KEYS; key++) {
+        if (latest[key].offset != 0 and latest[key].offset / FLASH_SECTOR_SIZE == next) {
+            return;
+        }
+    }
+
+    if (!isFormattedEmpty(next)) {
+        formatSector(next);
+    }
+    preparedSector = next;
+}
+
+/**
+ * Inicializálás: a gyűrű végigolvasása, az érvényes rekordok megkeresése
+ */
+void FlashJournal::begin() {
+
+    uint32_t start = micros();
+    memset(latest, 0, sizeof(latest));
+
+    // A gyűrű a LittleFS előtt van, a program nem lóghat bele
+    uint32_t regionStart = (uint32_t)(uintptr_t)&_FS_start - FLASH_JOURNAL_SECTORS * FLASH_SECTOR_SIZE;
+    if ((uint32_t)(uintptr_t)&__flash_binary_end > regionStart) {
+        DEBUG("FlashJournal::begin() -> the program overlaps the journal area, journal disabled\n");
+        ready = false;
+        return;
+    }
+    regionOffset = regionStart - XIP_BASE;
+    ready = true;
+
+    // Kulcsonként a legfrissebb ép rekord, és a legutoljára írt szektor megkeresése
+    uint32_t maxSeq = 0;
+    int8_t newestSector = -1;
+    uint32_t freeOffset[FLASH_JOURNAL_SECTORS];
+    for (uint8_t sector = 0; sector < FLASH_JOURNAL_SECTORS; sector++) {
+        uint32_t prevMaxSeq = maxSeq;
+        freeOffset[sector] = scanSector(sector, maxSeq);
+        if (maxSeq > prevMaxSeq) {
+            newestSector = sector;
+        }
+    }
+    nextSeq = maxSeq + 1;
+
+    if (newestSector < 0) {
+        // Üres (vagy még nem formázott) gyűrű
+        openSector(0);
+    } else {
+        currentSector = newestSector;
+        writeOffset = freeOffset[newestSector];
+    }
+
+    // A rákövetkező szektorban nem maradhat élő rekord (pl. az áthelyezés közben kapcsolták ki)
+    relocateLive((currentSector + 1) % FLASH_JOURNAL_SECTORS);
+
+    DEBUG("FlashJournal::begin() -> sector: %d, offset: %d, seq: %d, %d usec\n", currentSector, writeOffset, nextSeq, micros() - start);
+}
+
+/**
+ * A kulcs legfrissebb rekordjának beolvasása
+ */
+bool FlashJournal::read(uint8_t key, void *data, uint16_t length) {
+
+    if (!ready or key >= FLASH_JOURNAL_MAX_KEYS) {
+        return false;
+    }
+
+    const LatestRecord &rec = latest[key];
+    if (rec.offset == 0 or rec.length != length) {
+        return false;
+    }
+
+    memcpy(data, flashPtr(rec.offset + sizeof(FlashJournalRecordHeader)), length);
+    return true;
+}
+
+/**
+ * Új rekord hozzáfűzése
+ */
+bool FlashJournal::append(uint8_t key, const void *data, uint16_t length) {
+
+    if (!ready or key >= FLASH_JOURNAL_MAX_KEYS or length > FLASH_JOURNAL_MAX_PAYLOAD) {
+        return false;
+    }
+
+    uint32_t start = micros();
+
+    // Ha nem fér el (vagy írási hiba volt), a következő szektorba írunk
+    if (!writeRecord(key, (const uint8_t *)data, length)) {
+        advanceSector();
+        if (!writeRecord(key, (const uint8_t *)data, length)) {
+            return false;
+        }
+    }
+
+    DEBUG("FlashJournal::append() -> key: %d, %d bytes, sector: %d, %d usec, max encoder ISR jitter: %d usec (appends: %d, erases: %d)\n", key, length, currentSector,
+          micros() - start, FlashWriter::getMaxJitterUsec(), appendCount, eraseCount);
+    return true;
+}
@@ -0,0 +1,177 @@
+#ifndef __FLASHJOURNAL_H
+#define __FLASHJOURNAL_H
+
+#include <Arduino.h>
+#include <hardware/flash.h>
+
+#define FLASH_JOURNAL_SECTORS 4                // A gyűrű szektorainak száma (a LittleFS terület előtt)
+#define FLASH_JOURNAL_MAX_KEYS 48              // A tárolható rekord típusok (kulcsok) száma
+#define FLASH_JOURNAL_MAX_PAYLOAD 256          // Egy rekord adatának maximális mérete
+#define FLASH_JOURNAL_SECTOR_MAGIC 0x4A524E31  // 'JRN1' - szektor fejléc azonosító, formátum váltáskor léptetni kell
+#define FLASH_JOURNAL_RECORD_MAGIC 0x4A52      // 'JR' - rekord fejléc azonosító (törölt flash: 0xFFFF)
+
+// A journal rekord kulcsai
+#define FLASH_JOURNAL_KEY_CONFIG 0         // Config_t egyben (a korábbi formátum, csak betöltjük)
+#define FLASH_JOURNAL_KEY_CONFIG_SCHEMA 1  // Config_t séma verzió
+#define FLASH_JOURNAL_KEY_CONFIG_FIELDS 8  // Config_t mezőnként: a mező tag-je + ez a kulcs
+#define FLASH_JOURNAL_KEY_BANDS 40         // BandTableVar csoportonként: a csoport indexe + ez a kulcs (BandStore)
+
+/**
+ * A szektor eleji fejléc
+ */
+struct FlashJournalSectorHeader {
+    uint32_t magic;
+    uint32_t eraseCount;  // A szektor törléseinek száma (a kopás figyeléséhez)
+};
+
+/**
+ * Egy rekord fejléce, utána jön az adat, a következő rekord 4 byte-os határon kezdődik
+ * A CRC a length mezőtől az adat végéig tart, így a félbeszakadt írás felismerhető
+ */
+struct FlashJournalRecordHeader {
+    uint16_t magic;
+    uint16_t crc;
+    uint16_t length;  // Az adat hossza
+    uint8_t key;      // A rekord típusa
+    uint8_t reserved;
+    uint32_t seq;     // Sorszám, a legnagyobb az érvényes
+};
+
+/**
+ * Napló szerkezetű (log-structured) tároló a flash egy szektor gyűrűjében
+ *
+ * Az RP2040 EEPROM emulációja minden commit()-nál egy teljes 4 kByte-os szektort töröl és újraír, ami lassú,
+ * és közben a flash-ből futó (XIP) kód is áll. Itt mentéskor csak hozzáfűzünk egy új rekordot (sorszámmal, CRC-vel)
+ * a szektor szabad részéhez, így mentésenként csak 1-2 lap programozása kell. Ha a szektor megtelt, a gyűrű következő
+ * szektorába írunk tovább, a törlés így egyenletesen oszlik el a szektorok között.
+ *
+ * Az új szektor megnyitásakor a rákövetkező (legrégebbi) szektor még élő rekordjait átmásoljuk, így az bármikor
+ * törölhető. Induláskor kulcsonként a legnagyobb sorszámú, ép CRC-jű rekord az érvényes, a félbeszakadt írás rekordját eldobjuk.
+ *
+ * A gyűrű a LittleFS terület előtti, a program által nem használt flash végén van. Ha a program ebbe belelógna,
+ * a journal nem használható (isReady() == false), ekkor a hívók az EEPROM-ot használják.
+ */
+class FlashJournal {
+
+   private:
+    // Kulcsonként a legfrissebb rekord helye
+    struct LatestRecord {
+        uint32_t offset;  // A rekord fejléc helye a gyűrűn belül (0 -> nincs ilyen rekord)
+        uint32_t seq;
+        uint16_t length;
+    };
+
+    LatestRecord latest[FLASH_JOURNAL_MAX_KEYS];
+
+    uint32_t regionOffset = 0;  // A gyűrű kezdete a flash elejétől (a flash_range_xxx() függvényekhez)
+    bool ready = false;
+
+    uint8_t currentSector = 0;   // Ebbe a szektorba írunk
+    uint32_t writeOffset = 0;    // A szabad hely kezdete az aktuális szektorban
+    uint32_t nextSeq = 1;        // A következő rekord sorszáma
+    int8_t preparedSector = -1;  // Az üresjáratban előre törölt és formázott következő szektor (-1 -> nincs)
+
+    // Statisztika (az indulás óta)
+    uint32_t appendCount = 0;
+    uint32_t eraseCount = 0;
+
+    /**
+     * A gyűrű adott helyének címe a memóriába leképezett (XIP) flash-ben
+     */
+    inline const uint8_t *flashPtr(uint32_t offset) { return (const uint8_t *)(uintptr_t)(XIP_BASE + regionOffset + offset); }
+
+    /**
+     * Flash műveletek (FlashWriter: a RAM-ból futó megszakítások mennek tovább, a másik mag áll)
+     */
+    void programBytes(uint32_t offset, const uint8_t *data, uint32_t length);
+    void eraseSector(uint8_t sector);
+
+    /**
+     * A terület törölt (csupa 0xFF)?
+     */
+    bool isErased(uint32_t offset, uint32_t length);
+
+    /**
+     * Egy szektor rekordjainak végigolvasása induláskor
+     * @return a szabad hely kezdete a szektorban (FLASH_SECTOR_SIZE, ha nem írható tovább)
+     */
+    uint32_t scanSector(uint8_t sector, uint32_t &maxSeq);
+
+    /**
+     * Egy rekord kiírása az aktuális szektor szabad helyére (nincs szektor váltás)
+     */
+    bool writeRecord(uint8_t key, const uint8_t *data, uint16_t length);
+
+    /**
+     * Szektor formázása: törlés, fejléc írás
+     */
+    void formatSector(uint8_t sector);
+
+    /**
+     * A szektor formázott és üres?
+     */
+    bool isFormattedEmpty(uint8_t sector);
+
+    /**
+     * Szektor megnyitása írásra (ha még nincs előkészítve: törlés, fejléc írás)
+     */
+    void openSector(uint8_t sector);
+
+    /**
+     * A szektor még élő (kulcsonként legfrissebb) rekordjainak átmásolása az aktuális szektorba
+     */
+    void relocateLive(uint8_t sector);
+
+    /**
+     * Továbblépés a gyűrű következő szektorára
+     */
+    void advanceSector();
+
+    /**
+     * Egy rekord teljes (4 byte-ra kerekített) mérete
+     */
+    static constexpr uint32_t recordSize(uint16_t length) { return (sizeof(FlashJournalRecordHeader) + length + 3) & ~3; }
+
+   public:
+    /**
+     * Inicializálás: a gyűrű végigolvasása, az érvényes rekordok megkeresése (a setup()-ból hívjuk)
+     */
+    void begin();
+
+    /**
+     * Üresjárati feladat: a következő szektor előre törlése, így a mentés közben ritkán kell szektort törölni
+     * Egy hívás legfeljebb egy szektort töröl (a loop()-ból hívjuk, ha nincs felhasználói interakció)
+     */
+    void loop();
+
+    /**
+     * Használható a journal?
+     */
+    inline bool isReady() const { return ready; }
+
+    /**
+     * A kulcs legfrissebb rekordjának beolvasása
+     * @return false, ha nincs ilyen rekord, vagy más a mérete
+     */
+    bool read(uint8_t key, void *data, uint16_t length);
+
+    /**
+     * Van (nem törölt) rekord a kulcshoz?
+     */
+    inline bool contains(uint8_t key) const { return ready and key < FLASH_JOURNAL_MAX_KEYS and latest[key].offset != 0 and latest[key].length > 0; }
+
+    /**
+     * Új rekord hozzáfűzése (a kulcs korábbi rekordjai ezzel érvénytelenné válnak)
+     */
+    bool append(uint8_t key, const void *data, uint16_t length);
+
+    /**
+     * A kulcs törlése: egy üres (0 hosszú) rekordot fűzünk hozzá, ami elfedi a korábbiakat
+     */
+    inline bool remove(uint8_t key) { return append(key, nullptr, 0); }
+};
+
+// Globális journal (a pico-radio.ino-ban példányosítjuk)
+extern FlashJournal flashJournal;
+
+#endif  //__FLASHJOURNAL_H
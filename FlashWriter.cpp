@@ -0,0 +1,70 @@
+#include "FlashWriter.h"
+
+#include <hardware/structs/nvic.h>
+
+#include "EncoderTimer.h"
+#include "utils.h"
+
+uint32_t FlashWriter::allowedIrqMask = 0;
+uint32_t FlashWriter::opCount = 0;
+uint32_t FlashWriter::maxOpUsec = 0;
+uint32_t FlashWriter::maxJitterUsec = 0;
+
+/**
+ * A flash művelet előtti teendők: a flash-ből futó megszakítások tiltása, a másik mag megállítása
+ */
+uint32_t FlashWriter::enter() {
+
+    // Az NVIC ISER olvasva az engedélyezett megszakításokat adja, az ICER-be írt bitek letiltják őket
+    uint32_t savedIrqMask = nvic_hw->iser;
+    nvic_hw->icer = savedIrqMask & ~allowedIrqMask;
+
+    rp2040.idleOtherCore();
+    EncoderTimer::flashWriteBegin();
+
+    return savedIrqMask;
+}
+
+/**
+ * A flash művelet utáni teendők: a másik mag és a megszakítások visszaállítása, statisztika
+ */
+void FlashWriter::leave(uint32_t savedIrqMask, uint32_t start) {
+
+    EncoderTimer::flashWriteEnd();
+    rp2040.resumeOtherCore();
+    nvic_hw->iser = savedIrqMask & ~allowedIrqMask;
+
+    uint32_t elapsed = micros() - start;
+    opCount++;
+    if (elapsed > maxOpUsec) {
+        maxOpUsec = elapsed;
+    }
+    if (EncoderTimer::getMaxWriteJitterUsec() > maxJitterUsec) {
+        maxJitterUsec = EncoderTimer::getMaxWriteJitterUsec();
+    }
+}
+
+/**
+ * Lapok programozása
+ */
+void FlashWriter::program(uint32_t flashOffset, const uint8_t *data, uint32_t length) {
+
+    uint32_t start = micros();
+    uint32_t savedIrqMask = enter();
+    flash_range_program(flashOffset, data, length);
+    leave(savedIrqMask, start);
+}
+
+/**
+ * Egy szektor törlése
+ */
+void FlashWriter::eraseSector(uint32_t flashOffset) {
+
+    uint32_t start = micros();
+    uint32_t savedIrqMask = enter();
+    flash_range_erase(flashOffset, FLASH_SECTOR_SIZE);
+    leave(savedIrqMask, start);
+
+    DEBUG("FlashWriter::eraseSector() -> %d usec, encoder ISR jitter: %d usec (max: %d usec, ops: %d)\n", micros() - start, EncoderTimer::getMaxWriteJitterUsec(),
+          maxJitterUsec, opCount);
+}
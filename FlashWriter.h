@@ -0,0 +1,66 @@
+#ifndef __FLASHWRITER_H
+#define __FLASHWRITER_H
+
+#include <Arduino.h>
+#include <hardware/flash.h>
+
+/**
+ * Flash írás/törlés a futó megszakítások és a másik mag zavarása nélkül
+ *
+ * Írás/törlés közben az XIP (a flash-ből futó kód és a flash-beli konstansok olvasása) mindkét magon áll.
+ * A korábbi megoldás (noInterrupts() a művelet alatt) a rotary encoder 1 msec-es megszakítását is egy szektor törlés
+ * idejére (akár 50 msec-re) feltartotta. Itt csak azokat a megszakításokat tiltjuk le, amelyek kezelője a flash-ből fut,
+ * a RAM-ból futókat (allowIrq(), pl. EncoderTimer) nem, a másik magot pedig az rp2040.idleOtherCore() lockout-jával
+ * állítjuk meg (az a RAM-ban várakozik).
+ *
+ * A művelet idejét és az encoder megszakítás közben mért legnagyobb jitterét eltároljuk, a DEBUG kiírja.
+ *
+ * Ezen megy a FlashJournal (Config, BandStore). A LittleFS (MemoryStore, RdsStationCache) írásai NEM: azokat az
+ * arduino-pico LittleFS flash rétege végzi, letiltott megszakításokkal, és ez a core módosítása nélkül nem irányítható át.
+ * Ezek csak felhasználói műveletre (memória mentés/törlés) vagy állomásváltáskor írnak, és a LittleFS a szektort
+ * is ritkán törli, így az encoder ilyenkor kihagyhat egy-egy lépést.
+ */
+class FlashWriter {
+
+   private:
+    static uint32_t allowedIrqMask;  // A flash művelet alatt is engedélyezett (RAM-ból futó) megszakítások
+
+    // Statisztika (az indulás óta)
+    static uint32_t opCount;
+    static uint32_t maxOpUsec;
+    static uint32_t maxJitterUsec;
+
+    /**
+     * A flash művelet előtti / utáni teendők, a visszatérési érték a korábban engedélyezett megszakítások maszkja
+     */
+    static uint32_t enter();
+    static void leave(uint32_t savedIrqMask, uint32_t start);
+
+   public:
+    /**
+     * Megszakítás engedélyezése a flash műveletek alatt (a kezelőnek és mindennek, amit hív, RAM-ban kell lennie!)
+     */
+    static inline void allowIrq(uint8_t irqNum) { allowedIrqMask |= 1u << irqNum; }
+
+    /**
+     * Lapok programozása
+     * @param flashOffset a flash elejétől számított hely (FLASH_PAGE_SIZE-ra igazítva)
+     * @param data a RAM-ban lévő adat (a flash-ből nem lehet, az írás alatt nem olvasható)
+     * @param length FLASH_PAGE_SIZE többszöröse
+     */
+    static void program(uint32_t flashOffset, const uint8_t *data, uint32_t length);
+
+    /**
+     * Egy szektor törlése
+     * @param flashOffset a flash elejétől számított hely (FLASH_SECTOR_SIZE-ra igazítva)
+     */
+    static void eraseSector(uint32_t flashOffset);
+
+    /**
+     * Az eddigi leghosszabb flash művelet és az alatta mért legnagyobb encoder megszakítás jitter (usec)
+     */
+    static inline uint32_t getMaxOpUsec() { return maxOpUsec; }
+    static inline uint32_t getMaxJitterUsec() { return maxJitterUsec; }
+};
+
+#endif  //__FLASHWRITER_H
@@ -3,6 +3,12 @@
 #include <Arduino.h>
 
 #include "FrequencyInputDialog.h"
+#include "SignalSampler.h"
+
+// FM hangolás gyorsítási görbéje (lépés/sec -> szorzó)
+// A 87.5-108MHz sáv 100kHz-es lépésekkel kb. 200 lépés, ehhez elég a mérsékelt gyorsítás
+static constexpr RotaryEncoder::AccelerationPoint FM_ACCELERATION_POINTS[] = {{8, 1}, {20, 2}, {40, 5}, {80, 10}};
+static constexpr RotaryEncoder::AccelerationCurve FM_ACCELERATION_CURVE = {FM_ACCELERATION_POINTS, ARRAY_ITEM_COUNT(FM_ACCELERATION_POINTS)};
 
 /**
  * Konstruktor
@@ -15,8 +21,8 @@ FmDisplay::FmDisplay(TFT_eSPI &tft, SI4735 &si4735, Band &band) : DisplayBase(tf
     pSMeter = new SMeter(tft, 0, 80);
 
     // RDS példányosítása
-    pRds = new Rds(tft, si4735, 80, 62,  // Station x,y
-                   0, 80,                // Message x,y
+    pRds = new Rds(tft, si4735, band, 80, 62,  // Station x,y
+                   0, 80, 228,           // Message x,y,w (az S-Meter szélessége)
                    2, 42,                // Time x,y
                    0, 140                // program type x,y
     );
@@ -80,11 +86,9 @@ void FmDisplay::drawScreen() {
 
     BandTable &currentBand = band.getCurrentBand();
 
-    // RSSI aktuális érték
-    si4735.getCurrentReceivedSignalQuality();
-    uint8_t rssi = si4735.getCurrentRSSI();
-    uint8_t snr = si4735.getCurrentSNR();
-    pSMeter->showRSSI(rssi, snr, currentBand.varData.currMod == FM);
+    // RSSI aktuális érték (a jelminőség mintavételező snapshot-jából)
+    const SignalQuality &signal = signalSampler.get();
+    pSMeter->showRSSI(signal.rssi, signal.snr, currentBand.varData.currMod == FM);
 
     // RDS (erőből a 'valamilyen' adatok megjelenítése)
     if (config.data.rdsEnabled) {
@@ -92,7 +96,7 @@ void FmDisplay::drawScreen() {
     }
 
     // Mono/Stereo aktuális érték
-    this->showMonoStereo(si4735.getCurrentPilot());
+    this->showMonoStereo(signal.pilot);
 
     // Frekvencia
     float currFreq = currentBand.varData.currFreq;  // A Rotary változtatásakor már eltettük a Band táblába
@@ -111,7 +115,7 @@ void FmDisplay::processScreenButtonTouchEvent(TftButton::ButtonTouchEvent &event
 
     if (STREQ("RDS", event.label)) {
         // Radio Data System
-        config.data.rdsEnabled = event.state == TftButton::ButtonState::On;
+        config.set(config.data.rdsEnabled, event.state == TftButton::ButtonState::On);
         if (config.data.rdsEnabled) {
             pRds->displayRds(true);
         } else {
@@ -201,24 +205,36 @@ void FmDisplay::showMonoStereo(bool stereo) {
     tft.drawString(buffer, rtv::freqDispX + 210, rtv::freqDispY + 71);
 }
 
+/**
+ * A rotary encoder gyorsítási görbéje
+ */
+const RotaryEncoder::AccelerationCurve &FmDisplay::getAccelerationCurve() { return FM_ACCELERATION_CURVE; }
+
 /**
  * Rotary encoder esemény lekezelése
  */
 bool FmDisplay::handleRotary(RotaryEncoder::EncoderState encoderState) {
 
     BandTable &currentBand = band.getCurrentBand();
+    TuneEngine &tuneEngine = band.getTuneEngine();
+
+    // Kézi hangolás -> a memória szkennelés leáll
+    memoryScanner.stop();
 
     // Kiszámítjuk a frekvencia lépés nagyságát
-    uint16_t step = encoderState.value * currentBand.varData.currStep;  // A lépés nagysága
+    int32_t step = encoderState.value * currentBand.varData.currStep;  // A lépés nagysága
 
-    // Beállítjuk a frekvenciát
-    si4735.setFrequency(si4735.getFrequency() + step);
+    // Az új célfrekvencia a legutóbbi célhoz képest (nem várjuk meg az előző hangolás végét), a sáv határain belül
+    uint16_t newFreq = constrain((int32_t)tuneEngine.getTarget() + step, (int32_t)currentBand.pConstData->minimumFreq, (int32_t)currentBand.pConstData->maximumFreq);
 
-    // Elmentjük a band táblába az aktuális frekvencia értékét
-    currentBand.varData.currFreq = si4735.getFrequency();
+    // Beállítjuk a frekvenciát (a hangolás akkor indul, ha a chip szabad)
+    tuneEngine.setTarget(newFreq);
 
-    // RDS törlés
-    pRds->clearRds();
+    // Elmentjük a band táblába a célfrekvenciát, a kijelző azonnal ezt mutatja
+    currentBand.varData.currFreq = newFreq;
+
+    // Az RDS adatokat csak a hangolás végén töröljük, egyszer (a törlés I2C parancs, nem minden lépésnél)
+    rdsClearPending = true;
 
     // Beállítjuk, hogy kell majd új frekvenciakijelzés
     DisplayBase::frequencyChanged = true;
@@ -231,31 +247,70 @@ bool FmDisplay::handleRotary(RotaryEncoder::EncoderState encoderState) {
  */
 void FmDisplay::displayLoop() {
 
+    // Kézi hangolás után, ha a hangolás befejeződött, egyszer töröljük az RDS adatokat
+    // (addig nem dekódolunk, a FIFO-ban még a korábbi állomás csoportjai lehetnek)
+    if (rdsClearPending and band.getTuneEngine().isIdle()) {
+        pRds->clearRds();
+        rdsClearPending = false;
+    }
+
+    // Az RDS csoportokat dialóg alatt is dekódoljuk, hogy ne maradjunk le semmiről
+    bool rdsCacheHit = config.data.rdsEnabled and !rdsClearPending and pRds->processGroups();
+
     // Ha van dialóg, akkor nem frissítjük a komponenseket
     if (DisplayBase::pDialog != nullptr) {
         return;
     }
 
+    // A memória szkenner csatornát váltott -> a régi állomás RDS adatai már nem érvényesek
+    if (memoryScanner.checkChannelChanged()) {
+        pRds->clearRds();
+        DisplayBase::frequencyChanged = true;
+    }
+
+    // A cache-ből előtöltött RDS adatokat azonnal kirajzoljuk, nem várunk a következő frissítésig
+    if (rdsCacheHit) {
+        pRds->displayRds();
+    }
+
+    // A hosszú RadioText görgetése a saját ütemében
+    if (config.data.rdsEnabled) {
+        pRds->scrollRadioText();
+    }
+
     BandTable &currentBand = band.getCurrentBand();
 
     // Néhány adatot csak ritkábban frissítünk
     static uint32_t elapsedTimedValues = 0;  // Kezdőérték nulla
     if ((millis() - elapsedTimedValues) >= SCREEN_COMPS_REFRESH_TIME_MSEC) {
 
-        // RSSI
-        si4735.getCurrentReceivedSignalQuality();
-        uint8_t rssi = si4735.getCurrentRSSI();
-        uint8_t snr = si4735.getCurrentSNR();
+        // RSSI (a jelminőség mintavételező snapshot-jából)
+        const SignalQuality &signal = signalSampler.get();
+        uint8_t rssi = signal.rssi;
+        uint8_t snr = signal.snr;
         pSMeter->showRSSI(rssi, snr, currentBand.varData.currMod == FM);
 
         // RDS
         if (config.data.rdsEnabled) {
             pRds->showRDS(snr);
+
+            // Gyenge jelnél jobb AF keresése, az AF-ek a sáv határain belül lehetnek
+            // Csak nyugalomban: hangolás / RDS törlés előtt a dekóder és a mérés még a régi állomásé, szkenneléskor a hangoló a szkenneré
+            Si4735State &chipState = band.getChipState();
+            bool afAllowed = !rdsClearPending and band.getTuneEngine().isIdle() and !memoryScanner.isActive() and signal.version != 0 and
+                             signal.frequency == chipState.getTunedFrequency() and (int32_t)(signal.timestamp - chipState.getLastTuneMsec()) > 0;
+            if (afAllowed) {
+                uint16_t afFreq = pRds->checkAlternativeFrequencies(rssi, currentBand.pConstData->minimumFreq, currentBand.pConstData->maximumFreq);
+                if (afFreq != 0) {
+                    currentBand.varData.currFreq = afFreq;
+                    DisplayBase::frequencyChanged = true;
+                }
+            }
         }
 
         // Mono/Stereo
         static bool prevStereo = false;
-        bool stereo = si4735.getCurrentPilot();
+        bool stereo = signal.pilot;
         // Ha változott, akkor frissítünk
         if (stereo != prevStereo) {
             this->showMonoStereo(stereo);
@@ -17,6 +17,7 @@ class FmDisplay : public DisplayBase {
     // int antCapValue = 0;
     //
     Rds *pRds;
+    bool rdsClearPending = false;  // Kézi hangolás volt, a hangolás végén törölni kell az RDS adatokat
     SMeter *pSMeter;
     SevenSegmentFreq *pSevenSegmentFreq;
 
@@ -31,6 +32,11 @@ class FmDisplay : public DisplayBase {
      */
     bool handleRotary(RotaryEncoder::EncoderState encoderState) override;
 
+    /**
+     * A rotary encoder gyorsítási görbéje
+     */
+    const RotaryEncoder::AccelerationCurve &getAccelerationCurve() override;
+
     /**
      * Touch (nem képrnyő button) esemény lekezelése
      */
@@ -4,6 +4,10 @@
 
 #include <cmath>  // std::pow, round, fmod használatához
 
+#include "AudioMute.h"
+#include "I2cTrace.h"
+#include "SignalSampler.h"
+
 /**
  * Konstruktor
  */
@@ -38,6 +42,8 @@ FreqScanDisplay::FreqScanDisplay(TFT_eSPI &tft, SI4735 &si4735, Band &band) : Di
  */
 FreqScanDisplay::~FreqScanDisplay() {
     DEBUG("FreqScanDisplay::~FreqScanDisplay\n");
+    signalSampler.setSuspended(false);  // Ha szkennelés közben lépnek ki
+    audioMute.set(AudioMute::Reason::Scan, false);
     // A vektorok automatikusan felszabadulnak.
 }
 
@@ -482,6 +488,7 @@ void FreqScanDisplay::startScan() {
 
     DEBUG("Starting scan...\n");
     scanning = true;
+    signalSampler.setSuspended(true);  // A chip a szkennelt frekvenciákon jár, az aktuális csatornát nem mérjük
     scanPaused = false;             // Indításkor nem szünetel
     scanEmpty = true;               // Új szkennelés, töröljük az adatokat
     scanAGC = config.data.agcGain;  // Mentsük el az AGC állapotát
@@ -521,7 +528,7 @@ void FreqScanDisplay::startScan() {
     drawScanText(true);
 
     setFreq(currentFrequency);  // Első frekvencia beállítása
-    si4735.setAudioMute(true);  // Némítás szkennelés alatt
+    audioMute.set(AudioMute::Reason::Scan, true);  // Némítás szkennelés alatt
 
     // Kurzor eltüntetése (ha volt)
     eraseCursor(static_cast<int>(currentScanLine));
@@ -542,6 +549,7 @@ void FreqScanDisplay::stopScan() {
 
     DEBUG("Stopping scan...\n");
     scanning = false;
+    signalSampler.setSuspended(false);
     scanPaused = true;
 
     // Állítsuk be a "Pause" gombot On állapotba (szünetel)
@@ -558,7 +566,7 @@ void FreqScanDisplay::stopScan() {
     checkAGC();
 
     // Hang visszaállítása (ha némítva volt)
-    si4735.setAudioMute(rtv::muteStat);  // Vissza az eredeti némítási állapotba
+    audioMute.set(AudioMute::Reason::Scan, false);  // A többi ok (felhasználó, zajzár) szerint szól
 
     // Utolsó ismert frekvencia beállítása (ahol a kurzor van)
     setFreq(currentFrequency);
@@ -584,9 +592,10 @@ void FreqScanDisplay::pauseScan() {
         // AGC visszaállítása, hang vissza, step vissza...
         config.data.agcGain = scanAGC;
         checkAGC();
-        si4735.setAudioMute(rtv::muteStat);
+        audioMute.set(AudioMute::Reason::Scan, false);
+        signalSampler.setSuspended(false);
         uint8_t step = band.getCurrentBand().varData.currStep;
-        si4735.setFrequencyStep(step);
+        si4735.setFrequencyStep(step);  // Csak a library lépésközét állítja (a frequencyUp/Down-hoz), nincs I2C forgalom
 
         // Frekvencia beállítása a kurzor pozíciójára
         setFreq(currentFrequency);
@@ -600,7 +609,8 @@ void FreqScanDisplay::pauseScan() {
         scanAGC = config.data.agcGain;
         config.data.agcGain = static_cast<uint8_t>(Si4735Utils::AgcGainMode::Off);
         checkAGC();
-        si4735.setAudioMute(true);
+        audioMute.set(AudioMute::Reason::Scan, true);
+        signalSampler.setSuspended(true);
         // si4735.setFrequencyStep(1); // Ezt kivettük, mert a freqUp kezeli a scanStep-et
 
         // Frekvencia beállítása a következő szkennelési pontra
@@ -993,12 +1003,12 @@ void FreqScanDisplay::displayScanSignal() {
     // Középen fent töröljük a régi értéket a számított magassággal
     tft.fillRect(spectrumX + spectrumWidth / 2 - 60, clearY, 120, fontHeight + 2, TFT_BLACK);  // Szélesebb törlés
 
-    if (scanPaused && cursorVisible) {  // Ha szünetel, az aktuális mérést írjuk ki
-        si4735.getCurrentReceivedSignalQuality();
+    if (scanPaused && cursorVisible) {  // Ha szünetel, az aktuális mérést írjuk ki (a jelminőség mintavételező snapshot-jából)
+        const SignalQuality &signal = signalSampler.get();
         tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawString("RSSI:" + String(si4735.getCurrentRSSI()), spectrumX + spectrumWidth / 2 - 30, textY);  // textY használata
+        tft.drawString("RSSI:" + String(signal.rssi), spectrumX + spectrumWidth / 2 - 30, textY);  // textY használata
         tft.setTextColor(TFT_ORANGE, TFT_BLACK);
-        tft.drawString("SNR:" + String(si4735.getCurrentSNR()), spectrumX + spectrumWidth / 2 + 30, textY);  // textY használata
+        tft.drawString("SNR:" + String(signal.snr), spectrumX + spectrumWidth / 2 + 30, textY);  // textY használata
     } else if (!scanEmpty && cursorVisible && n >= 0 && n < spectrumWidth) {                                 // Ha fut és van adat, a tárolt értéket írjuk ki
         // Az RSSI érték visszaalakítása a skálázott Y koordinátából
         int displayed_rssi = 0;
@@ -1020,13 +1030,14 @@ void FreqScanDisplay::displayScanSignal() {
  * @return Az átlagolt jelerősség (RSSI esetén már Y koordinátává alakítva).
  */
 int FreqScanDisplay::getSignal(bool rssi) {
+    I2cTrace::Caller traceCaller(I2cCaller::Scan);
     int res = 0;
     for (int i = 0; i < countScanSignal; i++) {
-        si4735.getCurrentReceivedSignalQuality();  // Új mérés kérése
+        SignalQuality signal = signalSampler.measure();  // Új mérés a szkennelt frekvencián (a snapshot-ot nem írja felül)
         if (rssi)
-            res += si4735.getCurrentRSSI();
+            res += signal.rssi;
         else
-            res += si4735.getCurrentSNR();
+            res += signal.snr;
         // Rövid várakozás lehet szükséges a mérések között?
         // delayMicroseconds(100); // Opcionális
     }
@@ -1054,11 +1065,16 @@ void FreqScanDisplay::setFreq(uint16_t f) {
         currentFrequency = f;  // Ha szünetel, az aktuális frekvencia is ez lesz
     }
 
-    si4735.setFrequency(f);
+    // A chip állapoton keresztül hangolunk (a library fix várakozása helyett az STC-ig várunk), így a hangolást
+    // mindenki látja (Si4735State::isTuning()), és a chip állapot frekvenciája is követi
+    I2cTrace::Caller traceCaller(I2cCaller::Scan);
+    Si4735State &chipState = band.getChipState();
+    chipState.beginTune(f);
+    chipState.waitTuneComplete();
     // Az AGC-t csak akkor állítjuk, ha szkennelünk és nem szünetelünk
     if (scanning && !scanPaused) {
         // AGC letiltása (1 = disabled)
-        si4735.setAutomaticGainControl(1, 0);  // Explicit letiltás
+        band.getChipState().setAutomaticGainControl(1, 0);  // Explicit letiltás (a cache miatt csak az első lépésnél megy ki)
     }
 }
 
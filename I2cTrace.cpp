@@ -0,0 +1,140 @@
+#include "I2cTrace.h"
+
+#include "utils.h"
+
+I2cTraceEntry I2cTrace::ring[I2C_TRACE_RING_SIZE];
+uint32_t I2cTrace::ringHead = 0;
+
+I2cCaller I2cTrace::currentCaller = I2cCaller::Other;
+uint8_t I2cTrace::currentScreen = 0;
+const char *I2cTrace::screenNames[I2C_TRACE_SCREEN_COUNT] = {};
+
+I2cTraceStats I2cTrace::screenStats[I2C_TRACE_SCREEN_COUNT] = {};
+I2cTraceStats I2cTrace::callerStats[(uint8_t)I2cCaller::Count] = {};
+
+uint32_t I2cTrace::lastEndUsec = 0;
+uint32_t I2cTrace::burstUsec = 0;
+uint16_t I2cTrace::burstCount = 0;
+
+/**
+ * Egy tranzakció rögzítése
+ */
+void I2cTrace::record(uint8_t command, uint8_t bytes, uint32_t startUsec, uint32_t durationUsec) {
+
+    ring[ringHead & (I2C_TRACE_RING_SIZE - 1)] = {startUsec, (uint16_t)min(durationUsec, (uint32_t)UINT16_MAX), command, bytes, currentCaller, currentScreen};
+    ringHead++;
+
+    // Burst: az előző tranzakció vége óta kevés idő telt el
+    if (burstCount > 0 and startUsec - lastEndUsec < I2C_TRACE_BURST_GAP_USEC) {
+        burstUsec += durationUsec;
+        burstCount++;
+    } else {
+        burstUsec = durationUsec;
+        burstCount = 1;
+    }
+    lastEndUsec = startUsec + durationUsec;
+
+    I2cTraceStats *stats[] = {&screenStats[currentScreen], &callerStats[(uint8_t)currentCaller]};
+    for (I2cTraceStats *s : stats) {
+        s->count++;
+        s->bytes += bytes;
+        s->totalUsec += durationUsec;
+    }
+
+    // A burst a képernyőhöz tartozik (azt blokkolja)
+    I2cTraceStats &screen = screenStats[currentScreen];
+    if (burstUsec > screen.peakBurstUsec) {
+        screen.peakBurstUsec = burstUsec;
+        screen.peakBurstCount = burstCount;
+    }
+}
+
+/**
+ * Képernyő váltás
+ */
+void I2cTrace::setScreen(uint8_t screen, const char *name) {
+    currentScreen = screen % I2C_TRACE_SCREEN_COUNT;
+    screenNames[currentScreen] = name;
+    burstCount = 0;
+}
+
+/**
+ * A kezdeményező neve
+ */
+const char *I2cTrace::decodeCaller(I2cCaller caller) {
+
+    switch (caller) {
+        case I2cCaller::Screen:
+            return "Screen";
+        case I2cCaller::Tune:
+            return "Tune";
+        case I2cCaller::Signal:
+            return "Signal";
+        case I2cCaller::Scan:
+            return "Scan";
+        case I2cCaller::Rds:
+            return "Rds";
+        case I2cCaller::RdsFifo:
+            return "RdsFifo";
+        case I2cCaller::Utils:
+            return "Utils";
+        case I2cCaller::Other:
+        default:
+            return "Other";
+    }
+}
+
+/**
+ * Egy statisztika sor kiírása
+ */
+void I2cTrace::reportLine(const char *name, const I2cTraceStats &stats) {
+    DEBUG("  %-10s %6d tx, %7d bytes, %7d usec", name, stats.count, stats.bytes, stats.totalUsec);
+    if (stats.peakBurstCount > 0) {
+        DEBUG(", peak burst: %d tx / %d usec", stats.peakBurstCount, stats.peakBurstUsec);
+    }
+    DEBUG("\n");
+}
+
+/**
+ * Az összesítő kiírása a soros portra
+ */
+void I2cTrace::report() {
+
+    DEBUG("I2cTrace -> per screen:\n");
+    for (uint8_t i = 0; i < I2C_TRACE_SCREEN_COUNT; i++) {
+        if (screenStats[i].count > 0) {
+            reportLine(screenNames[i] ? screenNames[i] : "?", screenStats[i]);
+        }
+    }
+
+    DEBUG("I2cTrace -> per caller:\n");
+    for (uint8_t i = 0; i < (uint8_t)I2cCaller::Count; i++) {
+        if (callerStats[i].count > 0) {
+            reportLine(decodeCaller((I2cCaller)i), callerStats[i]);
+        }
+    }
+}
+
+/**
+ * Az utolsó tranzakciók kiírása a soros portra (a legrégebbivel kezdve)
+ */
+void I2cTrace::dump() {
+
+    uint16_t count = min(ringHead, (uint32_t)I2C_TRACE_RING_SIZE);
+    DEBUG("I2cTrace -> last %d transactions:\n", count);
+    for (uint32_t i = ringHead - count; i != ringHead; i++) {
+        const I2cTraceEntry &e = ring[i & (I2C_TRACE_RING_SIZE - 1)];
+        DEBUG("  %10u usec: cmd 0x%02X, %2d bytes, %5d usec, %s @ %s\n", e.timeUsec, e.command, e.bytes, e.durationUsec, decodeCaller(e.caller),
+              screenNames[e.screen] ? screenNames[e.screen] : "?");
+    }
+}
+
+/**
+ * A statisztika és a gyűrű puffer törlése
+ */
+void I2cTrace::reset() {
+    memset(screenStats, 0, sizeof(screenStats));
+    memset(callerStats, 0, sizeof(callerStats));
+    ringHead = 0;
+    burstCount = 0;
+}
@@ -0,0 +1,148 @@
+#ifndef __I2CTRACE_H
+#define __I2CTRACE_H
+
+#include <Arduino.h>
+
+#define I2C_TRACE_RING_SIZE 64         // Az utolsó ennyi tranzakciót tartjuk meg (2 hatványa)
+#define I2C_TRACE_SCREEN_COUNT 8       // Ennyi képernyőre gyűjtünk statisztikát (DisplayBase::DisplayType)
+#define I2C_TRACE_BURST_GAP_USEC 5000  // Az ennél kisebb szünettel követő tranzakciók egy burst-nek számítanak
+
+// Becsült bájtszám (írás + válasz) az SI4735 programozói leírása szerint, a library belsejét nem látjuk
+#define I2C_TRACE_BYTES_POWER_UP 4      // POWER_UP: 3 + 1 státusz (a library utána property-ket is ír)
+#define I2C_TRACE_BYTES_SET_PROPERTY 7  // SET_PROPERTY: 6 + 1 státusz
+#define I2C_TRACE_BYTES_AGC_OVERRIDE 4  // FM/AM_AGC_OVERRIDE: 3 + 1 státusz
+#define I2C_TRACE_BYTES_TUNE 7          // FM/AM_TUNE_FREQ: max 6 + 1 státusz
+#define I2C_TRACE_BYTES_STATUS 2        // GET_INT_STATUS: 1 + 1 státusz
+#define I2C_TRACE_BYTES_TUNE_STATUS 10  // FM/AM_TUNE_STATUS: 2 + 8
+#define I2C_TRACE_BYTES_RSQ_STATUS 10   // FM/AM_RSQ_STATUS: 2 + 8
+#define I2C_TRACE_BYTES_RDS_STATUS 15   // FM_RDS_STATUS: 2 + 13
+#define I2C_TRACE_BYTES_AGC_STATUS 5    // FM/AM_AGC_STATUS: 1 + 4
+#define I2C_TRACE_BYTES_PATCH_LINE 9    // PATCH_ARGS/PATCH_DATA: 8 + 1 státusz
+#define I2C_TRACE_BYTES_STATUS_READ 1   // Parancs nélküli státusz olvasás (CTS pollozás)
+
+#define I2C_TRACE_CMD_STATUS_READ 0x00  // A parancs nélküli státusz olvasás kódja a trace-ben
+
+/**
+ * A tranzakció kezdeményezője
+ */
+enum class I2cCaller : uint8_t { Other, Screen, Tune, Signal, Scan, Rds, RdsFifo, Utils, Count };
+
+/**
+ * Egy I2C tranzakció (SI4735 parancs)
+ */
+struct I2cTraceEntry {
+    uint32_t timeUsec;      // A kezdete
+    uint16_t durationUsec;  // Az időtartama
+    uint8_t command;        // SI4735 parancs kód (pl. FM_RSQ_STATUS)
+    uint8_t bytes;          // Az átvitt bájtok (becsült) száma
+    I2cCaller caller;
+    uint8_t screen;  // Az akkor aktív képernyő
+};
+
+/**
+ * Összesített statisztika (képernyőnként és kezdeményezőnként)
+ */
+struct I2cTraceStats {
+    uint32_t count;
+    uint32_t bytes;
+    uint32_t totalUsec;
+    uint32_t peakBurstUsec;  // A leghosszabb (a UI-t blokkoló) összefüggő burst (csak képernyőnként)
+    uint16_t peakBurstCount;
+};
+
+/**
+ * SI4735 I2C tranzakció nyomkövetés
+ *
+ * A Wire-t a SI4735 library kezeli, abba nem nyúlunk bele, ezért a saját hívási pontjainkon mérünk:
+ * - I2cTrace::Scope: egy parancs (RAII, a konstruktor és a destruktor között eltelt időt méri)
+ * - I2cTrace::Caller: a benne kiadott parancsok kezdeményezője (RAII, egymásba ágyazható, a belső a nyerő)
+ * Az utolsó I2C_TRACE_RING_SIZE tranzakciót egy RAM gyűrű pufferben tartjuk, emellett képernyőnként és kezdeményezőnként
+ * összesítjük a darabszámot, a bájtokat, az időt és a leghosszabb burst-öt. Az összesítő soros porton kiírható (report()),
+ * a SetupDisplay is megjeleníti.
+ * Csak a loop()-ból (egy magról) hívható, megszakításból nem.
+ */
+class I2cTrace {
+
+   private:
+    static I2cTraceEntry ring[I2C_TRACE_RING_SIZE];
+    static uint32_t ringHead;  // A következő írás helye (szabadon fut)
+
+    static I2cCaller currentCaller;
+    static uint8_t currentScreen;
+    static const char *screenNames[I2C_TRACE_SCREEN_COUNT];
+
+    static I2cTraceStats screenStats[I2C_TRACE_SCREEN_COUNT];
+    static I2cTraceStats callerStats[(uint8_t)I2cCaller::Count];
+
+    // Az aktuális burst
+    static uint32_t lastEndUsec;
+    static uint32_t burstUsec;
+    static uint16_t burstCount;
+
+    /**
+     * Egy tranzakció rögzítése
+     */
+    static void record(uint8_t command, uint8_t bytes, uint32_t startUsec, uint32_t durationUsec);
+
+    /**
+     * Egy statisztika sor kiírása
+     */
+    static void reportLine(const char *name, const I2cTraceStats &stats);
+
+   public:
+    /**
+     * Egy parancs mérése (RAII)
+     */
+    class Scope {
+       private:
+        uint8_t command;
+        uint8_t bytes;
+        uint32_t start;
+
+       public:
+        Scope(uint8_t command, uint8_t bytes) : command(command), bytes(bytes), start(micros()) {}
+        ~Scope() { record(command, bytes, start, micros() - start); }
+    };
+
+    /**
+     * A kezdeményező beállítása a blokk idejére (RAII)
+     */
+    class Caller {
+       private:
+        I2cCaller prevCaller;
+
+       public:
+        Caller(I2cCaller caller) : prevCaller(currentCaller) { currentCaller = caller; }
+        ~Caller() { currentCaller = prevCaller; }
+    };
+
+    /**
+     * Képernyő váltás (a changeDisplay() hívja)
+     */
+    static void setScreen(uint8_t screen, const char *name);
+
+    /**
+     * Statisztika lekérdezése
+     */
+    static inline const I2cTraceStats &getScreenStats(uint8_t screen) { return screenStats[screen % I2C_TRACE_SCREEN_COUNT]; }
+    static inline const char *getScreenName(uint8_t screen) { return screenNames[screen % I2C_TRACE_SCREEN_COUNT]; }
+    static inline const I2cTraceStats &getCallerStats(I2cCaller caller) { return callerStats[(uint8_t)caller]; }
+    static const char *decodeCaller(I2cCaller caller);
+
+    /**
+     * Az összesítő kiírása a soros portra
+     */
+    static void report();
+
+    /**
+     * Az utolsó tranzakciók kiírása a soros portra
+     */
+    static void dump();
+
+    /**
+     * A statisztika és a gyűrű puffer törlése
+     */
+    static void reset();
+};
+
+#endif  //__I2CTRACE_H
@@ -17,6 +17,12 @@ class IGuiEvents {
      */
     virtual bool handleRotary(RotaryEncoder::EncoderState encoderState) { return false; };
 
+    /**
+     * A rotary encoder gyorsítási görbéje ehhez a képernyőhöz/dialóghoz
+     * (Ha kell a leszármazottnak akkor majd felülírja)
+     */
+    virtual const RotaryEncoder::AccelerationCurve &getAccelerationCurve() { return RotaryEncoder::DEFAULT_ACCELERATION_CURVE; };
+
     /**
      * Touch esemény lekezelése
      * true, ha valaki rámozdult az eseményre
@@ -0,0 +1,356 @@
+#include "MemoryScanner.h"
+
+#include "AudioMute.h"
+#include "Config.h"
+#include "I2cTrace.h"
+#include "SignalSampler.h"
+#include "Squelch.h"
+#include "rtVars.h"
+#include "utils.h"
+
+/**
+ * Az aktuális sáv határain belüli csatornák pozíció tartománya a frekvencia sorrendben [first, last)
+ */
+void MemoryScanner::getBandRange(uint16_t &first, uint16_t &last) {
+
+    // FM-ben 10kHz, AM-ben 1kHz a chip frekvencia egysége
+    BandTable &currentBand = band.getCurrentBand();
+    uint32_t unitHz = currentBand.pConstData->bandType == FM_BAND_TYPE ? 10000 : 1000;
+
+    first = memoryStore.findByFrequency((uint32_t)currentBand.pConstData->minimumFreq * unitHz);
+    last = memoryStore.findByFrequency((uint32_t)currentBand.pConstData->maximumFreq * unitHz + 1);
+}
+
+/**
+ * Szkennelés indítása az aktuális frekvenciától
+ */
+bool MemoryScanner::start() {
+
+    uint16_t first, last;
+    getBandRange(first, last);
+    if (first >= last) {
+        DEBUG("MemoryScanner::start() -> no memory channel in this band\n");
+        return false;
+    }
+
+    // A rotary-ból még függő hangolás eldobása
+    band.getTuneEngine().cancel();
+
+    // Az aktuális frekvencia feletti első csatornától indulunk
+    BandTable &currentBand = band.getCurrentBand();
+    uint32_t unitHz = currentBand.pConstData->bandType == FM_BAND_TYPE ? 10000 : 1000;
+    uint16_t pos = memoryStore.findByFrequency((uint32_t)currentBand.varData.currFreq * unitHz + 1);
+    scanPos = (pos < first or pos >= last) ? first : pos;
+
+    scanBandIdx = config.data.bandIdx;
+    returnSlot = -1;
+    checkingPriority = false;
+    lastPriorityCheck = millis();
+
+    channelsScanned = 0;
+    scanMillis = 0;
+    scanSegmentStart = millis();
+#ifdef __DEBUG
+    lastStatsReport = millis();
+#endif
+
+    DEBUG("MemoryScanner::start() -> %d channels in band\n", last - first);
+
+    if (!tuneSlot(memoryStore.getSlotByFrequencyPos(scanPos)) and !tuneNext()) {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Szkennelés leállítása (a futó hangolás végét megvárjuk)
+ */
+void MemoryScanner::stop() {
+
+    if (state == State::Idle) {
+        return;
+    }
+
+    // A futó hangolás STC-jét nyugtázni kell
+    if (state == State::Tuning and !tuneCompleted) {
+        I2cTrace::Caller traceCaller(I2cCaller::Scan);
+        band.getChipState().waitTuneComplete();
+    }
+
+    if (scanSegmentStart != 0) {
+        scanMillis += millis() - scanSegmentStart;
+        scanSegmentStart = 0;
+    }
+
+    state = State::Idle;
+    returnSlot = -1;
+    checkingPriority = false;
+
+    // A szkennelés némítását feloldjuk (a hang a többi ok, pl. a zajzár szerint szól)
+    audioMute.set(AudioMute::Reason::Scan, false);
+
+    float cps = getChannelsPerSecond();
+    DEBUG("MemoryScanner::stop() -> %d channels, %d.%d channels/s\n", channelsScanned, (int)cps, (int)(cps * 10) % 10);
+}
+
+/**
+ * A következő csatorna hangolásának indítása
+ */
+bool MemoryScanner::tuneNext() {
+
+    uint16_t first, last;
+    getBandRange(first, last);
+
+    // Körbe járunk a sáv csatornáin, a hibás (nem olvasható, sávon kívüli) csatornákat átugorjuk
+    for (uint16_t i = first; i < last; i++) {
+        scanPos = (scanPos >= first and scanPos + 1 < last) ? scanPos + 1 : first;
+        if (tuneSlot(memoryStore.getSlotByFrequencyPos(scanPos))) {
+            return true;
+        }
+    }
+
+    // Nincs (már) hangolható csatorna a sávban
+    return false;
+}
+
+/**
+ * Esedékes a prioritásos csatorna ellenőrzése?
+ */
+bool MemoryScanner::isPriorityDue() {
+    int16_t prioritySlot = config.data.memScanPrioritySlot;
+    return prioritySlot >= 0 and prioritySlot != currentSlot and config.data.memScanPrioritySec > 0 and
+           millis() - lastPriorityCheck >= (uint32_t)config.data.memScanPrioritySec * 1000;
+}
+
+/**
+ * Továbblépés: a prioritásos csatorna, ha esedékes, egyébként a következő csatorna
+ */
+void MemoryScanner::advance() {
+
+    // Megállás után innen újra szkennelünk
+    if (scanSegmentStart == 0) {
+        scanSegmentStart = millis();
+    }
+
+    if (isPriorityDue()) {
+        lastPriorityCheck = millis();
+        checkingPriority = true;
+        if (tuneSlot(config.data.memScanPrioritySlot)) {
+            return;
+        }
+        // A prioritásos csatorna nem ebben a sávban van, vagy törölték
+        checkingPriority = false;
+    }
+
+    if (!tuneNext()) {
+        stop();
+    }
+}
+
+/**
+ * Hangolás egy memória csatornára
+ */
+bool MemoryScanner::tuneSlot(int16_t slot) {
+
+    MemoryRecord record;
+    if (slot < 0 or !memoryStore.read(slot, record)) {
+        return false;
+    }
+
+    BandTable &currentBand = band.getCurrentBand();
+    bool isFm = currentBand.pConstData->bandType == FM_BAND_TYPE;
+    uint8_t mod = isFm ? FM : record.mod;
+    bool isSsb = mod == LSB or mod == USB or mod == CW;
+
+    // SSB/CW-ben a tárolt frekvencia a BFO-val eltolt (kijelzett) érték
+    int16_t bfo = isSsb ? record.bfo : 0;
+    uint32_t freq = isFm ? record.freqHz / 10000 : (record.freqHz + bfo) / 1000;
+    if (freq < currentBand.pConstData->minimumFreq or freq > currentBand.pConstData->maximumFreq or (!isFm and mod == FM)) {
+        return false;
+    }
+
+    // A start() a képernyőről hív ide: a hangolás forgalma így is a szkenneré
+    I2cTrace::Caller traceCaller(I2cCaller::Scan);
+
+    currentSlot = slot;
+    currentBand.varData.currFreq = freq;
+    channelChanged = true;
+
+    // A csatornák közötti zajt nem engedjük ki
+    audioMute.set(AudioMute::Reason::Scan, true);
+
+    if (isSsb) {
+        config.data.currentBFO = rtv::freqDec = currentBand.varData.lastBFO = bfo;
+    }
+
+    if (mod != currentBand.varData.currMod) {
+        // Mód váltás: a band beállítása az új móddal (blokkoló, a hangolás végét is megvárja)
+        currentBand.varData.currMod = mod;
+        band.bandSet(false);
+        modeChanged = true;
+
+        // A kiértékelés a következő loop()-ban (nem rekurzívan innen)
+        tuneCompleted = true;
+        state = State::Tuning;
+        return true;
+    }
+
+    if (isSsb) {
+        const int16_t cwBaseOffset = (mod == CW) ? CW_SHIFT_FREQUENCY : 0;
+        band.getChipState().setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);
+    }
+
+    // Nem blokkoló hangolás, a végét a loop()-ban figyeljük
+    band.getChipState().beginTune(freq);
+    tuneStart = millis();
+    tuneCompleted = false;
+    state = State::Tuning;
+
+    return true;
+}
+
+/**
+ * A hangolás befejeződött, a jel kiértékelése
+ */
+void MemoryScanner::evaluate() {
+
+    // A hangolás végén azonnal mérünk, nem várjuk meg a mintavételező következő periódusát
+    // A zajzár nyitási küszöbével döntünk (a zajzár késleltetése nélkül, csatornánként egy mérés van)
+    const SignalQuality &signal = signalSampler.sampleNow();
+    bool open = Squelch::reachesOpenThreshold(Squelch::selectLevel(signal.rssi, signal.snr, config.data.squelchUsesRSSI), config.data.currentSquelch);
+
+    bool wasPriority = checkingPriority;
+    checkingPriority = false;
+
+    // A megállás alatti prioritás ellenőrzés nem számít bele a szkennelés sebességébe
+    if (scanSegmentStart != 0) {
+        channelsScanned++;
+    }
+
+    if (open) {
+        returnSlot = -1;
+        startHolding();
+        return;
+    }
+
+    // Megállás közbeni prioritás ellenőrzés volt -> vissza a korábbi csatornára
+    if (wasPriority and returnSlot >= 0) {
+        int16_t slot = returnSlot;
+        returnSlot = -1;
+        if (tuneSlot(slot)) {
+            return;
+        }
+    }
+
+    advance();
+}
+
+/**
+ * Megállás az aktuális csatornán
+ */
+void MemoryScanner::startHolding() {
+
+    if (scanSegmentStart != 0) {
+        scanMillis += millis() - scanSegmentStart;
+        scanSegmentStart = 0;
+    }
+
+    state = State::Holding;
+    belowSquelchSince = 0;
+    lastHoldCheck = millis();
+
+    audioMute.set(AudioMute::Reason::Scan, false);
+
+    DEBUG("MemoryScanner -> hold on slot %d, freq: %d\n", currentSlot, band.getCurrentBand().varData.currFreq);
+}
+
+/**
+ * A szkennelés folytatása a megállás után
+ */
+void MemoryScanner::resumeScan() {
+    DEBUG("MemoryScanner -> resume, slot %d is quiet\n", currentSlot);
+    advance();
+}
+
+/**
+ * Arduino loop
+ */
+void MemoryScanner::loop() {
+
+    if (state == State::Idle) {
+        return;
+    }
+
+    // Sávváltáskor (Band/Ham gomb) leállunk
+    if (config.data.bandIdx != scanBandIdx) {
+        stop();
+        return;
+    }
+
+    switch (state) {
+
+        case State::Tuning:
+            if (tuneCompleted or band.getChipState().pollTuneComplete()) {
+                evaluate();
+            } else if (millis() - tuneStart >= SI4735_STC_TIMEOUT_MSEC) {
+                DEBUG("MemoryScanner::loop() -> STC timeout, slot: %d\n", currentSlot);
+                evaluate();
+            }
+            break;
+
+        case State::Holding:
+            // Esedékes a prioritásos csatorna ellenőrzése?
+            if (isPriorityDue()) {
+                lastPriorityCheck = millis();
+                returnSlot = currentSlot;
+                checkingPriority = true;
+                if (!tuneSlot(config.data.memScanPrioritySlot)) {
+                    returnSlot = -1;
+                    checkingPriority = false;
+                }
+                break;
+            }
+
+            if (millis() - lastHoldCheck >= MEMORY_SCAN_HOLD_CHECK_MSEC) {
+                lastHoldCheck = millis();
+
+                // A zajzár állapota (hiszterézissel, késleltetéssel) dönt: ha zárva marad, továbbmegyünk
+                if (squelch.isOpen()) {
+                    belowSquelchSince = 0;
+                } else if (belowSquelchSince == 0) {
+                    belowSquelchSince = millis();
+                } else if (millis() - belowSquelchSince >= MEMORY_SCAN_RESUME_MSEC) {
+                    resumeScan();
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+#ifdef __DEBUG
+    if (millis() - lastStatsReport >= MEMORY_SCAN_STATS_INTERVAL) {
+        float cps = getChannelsPerSecond();
+        DEBUG("MemoryScanner stats -> %d channels, %d.%d channels/s\n", channelsScanned, (int)cps, (int)(cps * 10) % 10);
+        lastStatsReport = millis();
+    }
+#endif
+}
+
+/**
+ * A prioritásos csatorna beállítása / törlése
+ */
+void MemoryScanner::setPrioritySlot(int16_t slot) {
+    config.set(config.data.memScanPrioritySlot, slot);
+    lastPriorityCheck = millis();
+}
+
+/**
+ * Az átnézett csatornák száma másodpercenként (a megállások ideje nélkül)
+ */
+float MemoryScanner::getChannelsPerSecond() {
+    uint32_t elapsed = scanMillis + (scanSegmentStart != 0 ? millis() - scanSegmentStart : 0);
+    return elapsed > 0 ? channelsScanned * 1000.0f / elapsed : 0.0f;
+}
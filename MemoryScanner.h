@@ -0,0 +1,157 @@
+#ifndef __MEMORYSCANNER_H
+#define __MEMORYSCANNER_H
+
+#include <SI4735.h>
+
+#include "Band.h"
+#include "MemoryStore.h"
+
+#define MEMORY_SCAN_HOLD_CHECK_MSEC 250   // Megállás alatt ilyen gyakran mérjük a jelet
+#define MEMORY_SCAN_RESUME_MSEC 2000      // Ennyi ideig squelch alatti jel után megyünk tovább
+#define MEMORY_SCAN_STATS_INTERVAL 10000  // A csatorna/s statisztika kiírásának gyakorisága (__DEBUG)
+
+/**
+ * Memória csatornák szkennelése
+ *
+ * Az aktuális sáv határain belüli memória csatornákon lépked végig frekvencia sorrendben. Csatornánként csak addig
+ * maradunk, amíg a hangolás befejeződik (STC) és megvan az érvényes RSSI/SNR, fix várakozás nincs.
+ * Ha a jel eléri a zajzár nyitási küszöbét (config.data.currentSquelch, squelchUsesRSSI), megállunk a csatornán,
+ * és csak akkor megyünk tovább, ha a zajzár MEMORY_SCAN_RESUME_MSEC ideig zárva marad.
+ * Ha van prioritásos csatorna, azt config.data.memScanPrioritySec másodpercenként (szkennelés és megállás alatt is)
+ * megnézzük, és ha ott van jel, átállunk rá.
+ */
+class MemoryScanner {
+
+   private:
+    enum class State : uint8_t { Idle, Tuning, Holding };
+
+    SI4735 &si4735;
+    Band &band;
+
+    State state = State::Idle;
+
+    uint8_t scanBandIdx = 0;        // A szkennelt sáv (sávváltáskor leállunk)
+    uint16_t scanPos = 0;           // Az aktuális csatorna pozíciója a frekvencia sorrendben
+    int16_t currentSlot = -1;       // Az aktuálisan hangolt csatorna slot-ja
+    int16_t returnSlot = -1;        // A prioritás ellenőrzés után ide állunk vissza (-1 -> szkennelés tovább)
+    bool checkingPriority = false;  // A futó hangolás a prioritásos csatorna ellenőrzése?
+
+    uint32_t tuneStart = 0;          // A hangolás indításának ideje (STC timeout)
+    bool tuneCompleted = false;      // A hangolás már befejeződött (blokkoló mód váltás után)
+    uint32_t lastHoldCheck = 0;      // Az utolsó jel mérés megállás alatt
+    uint32_t belowSquelchSince = 0;  // Megállás alatt mióta van a jel a squelch alatt (0 -> felette van)
+    uint32_t lastPriorityCheck = 0;  // Az utolsó prioritás ellenőrzés ideje
+
+    // A kijelző frissítéséhez
+    bool channelChanged = false;
+    bool modeChanged = false;
+
+    // Mérés: a megállás nélkül átnézett csatornák száma és ideje
+    uint32_t channelsScanned = 0;
+    uint32_t scanMillis = 0;        // A szkenneléssel (nem megállással) töltött idő
+    uint32_t scanSegmentStart = 0;  // Az aktuális szkennelési szakasz kezdete (0 -> most nem szkennelünk)
+#ifdef __DEBUG
+    uint32_t lastStatsReport = 0;
+#endif
+
+    /**
+     * Az aktuális sáv határain belüli csatornák pozíció tartománya a frekvencia sorrendben [first, last)
+     */
+    void getBandRange(uint16_t &first, uint16_t &last);
+
+    /**
+     * A következő csatorna hangolásának indítása
+     */
+    bool tuneNext();
+
+    /**
+     * Esedékes a prioritásos csatorna ellenőrzése?
+     */
+    bool isPriorityDue();
+
+    /**
+     * Továbblépés: a prioritásos csatorna, ha esedékes, egyébként a következő csatorna
+     */
+    void advance();
+
+    /**
+     * Hangolás egy memória csatornára
+     */
+    bool tuneSlot(int16_t slot);
+
+    /**
+     * A hangolás befejeződött, a jel kiértékelése
+     */
+    void evaluate();
+
+    /**
+     * Megállás az aktuális csatornán / a szkennelés folytatása
+     */
+    void startHolding();
+    void resumeScan();
+
+   public:
+    /**
+     * Konstruktor
+     */
+    MemoryScanner(SI4735 &si4735, Band &band) : si4735(si4735), band(band) {}
+
+    /**
+     * Szkennelés indítása az aktuális frekvenciától
+     * @return false, ha nincs csatorna az aktuális sávban
+     */
+    bool start();
+
+    /**
+     * Szkennelés leállítása (a futó hangolás végét megvárjuk)
+     */
+    void stop();
+
+    /**
+     * Fut a szkennelés?
+     */
+    inline bool isActive() const { return state != State::Idle; }
+
+    /**
+     * Megálltunk egy csatornán?
+     */
+    inline bool isHolding() const { return state == State::Holding; }
+
+    /**
+     * Arduino loop (a pico-radio.ino-ból hívjuk)
+     */
+    void loop();
+
+    /**
+     * Csatornát váltottunk az utolsó lekérdezés óta? (A kijelzők frissítéséhez)
+     */
+    inline bool checkChannelChanged() {
+        bool changed = channelChanged;
+        channelChanged = false;
+        return changed;
+    }
+
+    /**
+     * A demodulációs mód is változott az utolsó lekérdezés óta?
+     */
+    inline bool checkModeChanged() {
+        bool changed = modeChanged;
+        modeChanged = false;
+        return changed;
+    }
+
+    /**
+     * A prioritásos csatorna beállítása / törlése a memória csatorna slot-jával (-1 -> nincs)
+     */
+    void setPrioritySlot(int16_t slot);
+
+    /**
+     * Az átnézett csatornák száma másodpercenként (a megállások ideje nélkül)
+     */
+    float getChannelsPerSecond();
+};
+
+// Globális memória szkenner (a pico-radio.ino-ban példányosítjuk)
+extern MemoryScanner memoryScanner;
+
+#endif  //__MEMORYSCANNER_H
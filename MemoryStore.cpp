@@ -0,0 +1,291 @@
+#include "MemoryStore.h"
+
+#include <LittleFS.h>
+
+#include <algorithm>
+
+#include "utils.h"
+
+#define MEMORY_STORE_HEADER_SIZE sizeof(uint32_t)  // A fájl elején lévő magic mérete
+
+static_assert(sizeof(MemoryRecord) == 32, "A MemoryRecord mérete 32 byte kell legyen");
+
+/**
+ * A név rendezési kulcsának előállítása (az eleje nagybetűsítve, nullával kitöltve)
+ */
+void MemoryStore::makeNameKey(const char *name, char *key) {
+    uint8_t i = 0;
+    for (; i < MEMORY_NAME_KEY_LENGTH and name[i] != '\0'; i++) {
+        key[i] = toupper(name[i]);
+    }
+    for (; i < MEMORY_NAME_KEY_LENGTH; i++) {
+        key[i] = '\0';
+    }
+}
+
+/**
+ * Két slot sorrendje frekvencia szerint (azonos frekvencián slot szerint, hogy a sorrend egyértelmű legyen)
+ */
+int MemoryStore::compareByFrequency(uint16_t slotA, uint16_t slotB) {
+    if (keys[slotA].freqHz != keys[slotB].freqHz) {
+        return keys[slotA].freqHz < keys[slotB].freqHz ? -1 : 1;
+    }
+    return (int)slotA - (int)slotB;
+}
+
+/**
+ * Két slot sorrendje név szerint (azonos kulcsnál frekvencia szerint)
+ */
+int MemoryStore::compareByName(uint16_t slotA, uint16_t slotB) {
+    int cmp = memcmp(keys[slotA].nameKey, keys[slotB].nameKey, MEMORY_NAME_KEY_LENGTH);
+    return cmp != 0 ? cmp : compareByFrequency(slotA, slotB);
+}
+
+/**
+ * Az első, a freqHz-nél nem kisebb frekvenciájú pozíció (bináris keresés)
+ */
+uint16_t MemoryStore::lowerBoundByFrequency(uint32_t freqHz) {
+    uint16_t lo = 0;
+    uint16_t hi = entryCount;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (keys[freqIndex[mid]].freqHz < freqHz) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Az első, a kulcsnál nem kisebb nevű pozíció (bináris keresés)
+ */
+uint16_t MemoryStore::lowerBoundByNameKey(const char *key) {
+    uint16_t lo = 0;
+    uint16_t hi = entryCount;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (memcmp(keys[nameIndex[mid]].nameKey, key, MEMORY_NAME_KEY_LENGTH) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Név szerinti keresés
+ */
+uint16_t MemoryStore::findByName(const char *name) {
+    char key[MEMORY_NAME_KEY_LENGTH];
+    makeNameKey(name, key);
+    return lowerBoundByNameKey(key);
+}
+
+/**
+ * Slot beszúrása a rendezett indexekbe (bináris kereséssel megtalált helyre)
+ */
+void MemoryStore::insertIntoIndexes(uint16_t slot) {
+
+    // Frekvencia index
+    uint16_t lo = 0;
+    uint16_t hi = entryCount;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (compareByFrequency(freqIndex[mid], slot) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(&freqIndex[lo + 1], &freqIndex[lo], (entryCount - lo) * sizeof(uint16_t));
+    freqIndex[lo] = slot;
+
+    // Név index
+    lo = 0;
+    hi = entryCount;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (compareByName(nameIndex[mid], slot) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(&nameIndex[lo + 1], &nameIndex[lo], (entryCount - lo) * sizeof(uint16_t));
+    nameIndex[lo] = slot;
+
+    entryCount++;
+}
+
+/**
+ * Slot törlése a rendezett indexekből
+ */
+void MemoryStore::removeFromIndexes(uint16_t slot) {
+
+    for (uint16_t i = 0; i < entryCount; i++) {
+        if (freqIndex[i] == slot) {
+            memmove(&freqIndex[i], &freqIndex[i + 1], (entryCount - i - 1) * sizeof(uint16_t));
+            break;
+        }
+    }
+    for (uint16_t i = 0; i < entryCount; i++) {
+        if (nameIndex[i] == slot) {
+            memmove(&nameIndex[i], &nameIndex[i + 1], (entryCount - i - 1) * sizeof(uint16_t));
+            break;
+        }
+    }
+    entryCount--;
+}
+
+/**
+ * Inicializálás: a fájl megnyitása és az indexek felépítése
+ */
+void MemoryStore::begin() {
+
+    fsReady = LittleFS.begin();
+    if (!fsReady) {
+        DEBUG("MemoryStore::begin() -> LittleFS mount error\n");
+        return;
+    }
+
+    uint32_t start = millis();
+    entryCount = 0;
+    slotCount = 0;
+    memset(usedSlots, 0, sizeof(usedSlots));
+
+    File file = LittleFS.open(MEMORY_STORE_FILE_NAME, "r");
+    uint32_t magic = 0;
+    if (file) {
+        file.read((uint8_t *)&magic, sizeof(magic));
+    }
+
+    // Nincs még fájl, vagy más a formátuma -> újat kezdünk
+    if (magic != MEMORY_STORE_MAGIC) {
+        if (file) {
+            file.close();
+        }
+        file = LittleFS.open(MEMORY_STORE_FILE_NAME, "w");
+        magic = MEMORY_STORE_MAGIC;
+        file.write((const uint8_t *)&magic, sizeof(magic));
+        file.close();
+        DEBUG("MemoryStore::begin() -> new memory file created\n");
+        return;
+    }
+
+    // Slot-ok beolvasása, a foglaltak kulcsai a RAM-ba
+    MemoryRecord record;
+    while (slotCount < MEMORY_STORE_MAX_ENTRIES and file.read((uint8_t *)&record, sizeof(record)) == sizeof(record)) {
+        uint16_t slot = slotCount++;
+        if (record.flags & MEMORY_FLAG_USED) {
+            keys[slot].freqHz = record.freqHz;
+            makeNameKey(record.name, keys[slot].nameKey);
+            setSlotUsed(slot, true);
+            freqIndex[entryCount] = nameIndex[entryCount] = slot;
+            entryCount++;
+        }
+    }
+    file.close();
+
+    // Az indexek rendezése
+    std::sort(freqIndex, freqIndex + entryCount, [this](uint16_t a, uint16_t b) { return compareByFrequency(a, b) < 0; });
+    std::sort(nameIndex, nameIndex + entryCount, [this](uint16_t a, uint16_t b) { return compareByName(a, b) < 0; });
+
+    DEBUG("MemoryStore::begin() -> %d memories (%d slots) loaded, %d msec\n", entryCount, slotCount, millis() - start);
+}
+
+/**
+ * Egy rekord kiírása a fájlba
+ */
+bool MemoryStore::writeRecord(uint16_t slot, const MemoryRecord &record) {
+
+    File file = LittleFS.open(MEMORY_STORE_FILE_NAME, "r+");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = file.seek(MEMORY_STORE_HEADER_SIZE + slot * sizeof(MemoryRecord)) and file.write((const uint8_t *)&record, sizeof(record)) == sizeof(record);
+    file.close();
+
+    return ok;
+}
+
+/**
+ * Egy rekord beolvasása a fájlból
+ */
+bool MemoryStore::read(uint16_t slot, MemoryRecord &record) {
+
+    if (!fsReady or slot >= slotCount or !isSlotUsed(slot)) {
+        return false;
+    }
+
+    File file = LittleFS.open(MEMORY_STORE_FILE_NAME, "r");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = file.seek(MEMORY_STORE_HEADER_SIZE + slot * sizeof(MemoryRecord)) and file.read((uint8_t *)&record, sizeof(record)) == sizeof(record);
+    file.close();
+
+    return ok;
+}
+
+/**
+ * Új memória csatorna felvétele
+ */
+int16_t MemoryStore::add(const MemoryRecord &record) {
+
+    if (!fsReady or entryCount >= MEMORY_STORE_MAX_ENTRIES) {
+        return -1;
+    }
+
+    // Törölt slot újrahasznosítása, ha nincs, akkor a fájl végére írunk
+    uint16_t slot = slotCount;
+    for (uint16_t i = 0; i < slotCount; i++) {
+        if (!isSlotUsed(i)) {
+            slot = i;
+            break;
+        }
+    }
+
+    MemoryRecord stored = record;
+    stored.flags |= MEMORY_FLAG_USED;
+    if (!writeRecord(slot, stored)) {
+        DEBUG("MemoryStore::add() -> write error, slot: %d\n", slot);
+        return -1;
+    }
+
+    if (slot == slotCount) {
+        slotCount++;
+    }
+    keys[slot].freqHz = stored.freqHz;
+    makeNameKey(stored.name, keys[slot].nameKey);
+    setSlotUsed(slot, true);
+    insertIntoIndexes(slot);
+
+    return slot;
+}
+
+/**
+ * Memória csatorna törlése
+ */
+bool MemoryStore::remove(uint16_t slot) {
+
+    MemoryRecord record;
+    if (!read(slot, record)) {
+        return false;
+    }
+
+    record.flags &= ~MEMORY_FLAG_USED;
+    if (!writeRecord(slot, record)) {
+        DEBUG("MemoryStore::remove() -> write error, slot: %d\n", slot);
+        return false;
+    }
+
+    setSlotUsed(slot, false);
+    removeFromIndexes(slot);
+
+    return true;
+}
@@ -0,0 +1,152 @@
+#ifndef __MEMORYSTORE_H
+#define __MEMORYSTORE_H
+
+#include <Arduino.h>
+
+#define MEMORY_STORE_FILE_NAME "/memories.bin"  // A memória csatornák fájlja a LittleFS-en
+#define MEMORY_STORE_MAX_ENTRIES 2000           // A memória csatornák maximális száma (a RAM index ~32 kByte)
+#define MEMORY_STORE_MAGIC 0x4D454D31           // 'MEM1' - fájl formátum azonosító, formátum váltáskor léptetni kell
+#define MEMORY_NAME_LENGTH 22                   // A név hossza (nincs feltétlenül lezárva)
+#define MEMORY_NAME_KEY_LENGTH 8                // A név szerinti rendezéshez a RAM-ban tartott név eleje
+
+#define MEMORY_FLAG_USED 0x01  // A rekord foglalt (törléskor csak ezt a bitet töröljük)
+
+/**
+ * Egy memória csatorna a fájlban (fix, 32 byte méretű)
+ */
+struct MemoryRecord {
+    uint32_t freqHz;                // Frekvencia [Hz]
+    uint8_t bandIdx;                // A sáv indexe a band táblában
+    uint8_t mod;                    // Demoduláció (FM, LSB, USB, AM, CW)
+    uint8_t bandwidth;              // Sávszélesség index
+    uint8_t flags;                  // MEMORY_FLAG_xxx
+    int16_t bfo;                    // BFO [Hz]
+    char name[MEMORY_NAME_LENGTH];  // Név (nullával kitöltve, nincs feltétlenül lezárva)
+};
+
+/**
+ * Memória csatornák tárolása flash fájlban
+ *
+ * A rekordok fix méretben, slot-onként vannak a LittleFS fájlban, új csatorna felvételekor / törlésekor
+ * csak az adott slot-ot írjuk. A RAM-ban slot-onként csak a frekvencia és a név eleje van, ebből két rendezett
+ * index készül (frekvencia és név szerint), így a keresés O(log n), a lapozás az indexben pedig azonnali.
+ *
+ * A fájl írása a LittleFS-en keresztül, letiltott megszakításokkal megy, nem a FlashWriter-en (lásd ott).
+ */
+class MemoryStore {
+
+   private:
+    // RAM-ban tartott adatok slot-onként
+    struct SlotKey {
+        uint32_t freqHz;
+        char nameKey[MEMORY_NAME_KEY_LENGTH];  // A név eleje nagybetűsítve
+    };
+
+    SlotKey keys[MEMORY_STORE_MAX_ENTRIES];
+    uint32_t usedSlots[(MEMORY_STORE_MAX_ENTRIES + 31) / 32];  // Foglalt slot-ok bittérképe
+    uint16_t slotCount = 0;                                    // A fájlban lévő slot-ok száma (foglalt + törölt)
+
+    // Rendezett indexek (slot számok)
+    uint16_t freqIndex[MEMORY_STORE_MAX_ENTRIES];
+    uint16_t nameIndex[MEMORY_STORE_MAX_ENTRIES];
+    uint16_t entryCount = 0;  // A foglalt slot-ok száma (az indexek hossza)
+
+    bool fsReady = false;
+
+    inline bool isSlotUsed(uint16_t slot) { return usedSlots[slot / 32] & ((uint32_t)1 << (slot % 32)); }
+    inline void setSlotUsed(uint16_t slot, bool used) {
+        if (used) {
+            usedSlots[slot / 32] |= (uint32_t)1 << (slot % 32);
+        } else {
+            usedSlots[slot / 32] &= ~((uint32_t)1 << (slot % 32));
+        }
+    }
+
+    /**
+     * A név rendezési kulcsának előállítása
+     */
+    static void makeNameKey(const char *name, char *key);
+
+    /**
+     * Két slot sorrendje frekvencia, illetve név szerint
+     */
+    int compareByFrequency(uint16_t slotA, uint16_t slotB);
+    int compareByName(uint16_t slotA, uint16_t slotB);
+
+    /**
+     * Beszúrási pozíció keresése a rendezett indexben
+     */
+    uint16_t lowerBoundByFrequency(uint32_t freqHz);
+    uint16_t lowerBoundByNameKey(const char *key);
+
+    /**
+     * Slot beszúrása / törlése a rendezett indexekből
+     */
+    void insertIntoIndexes(uint16_t slot);
+    void removeFromIndexes(uint16_t slot);
+
+    /**
+     * Egy rekord kiírása a fájlba
+     */
+    bool writeRecord(uint16_t slot, const MemoryRecord &record);
+
+   public:
+    /**
+     * Inicializálás: a fájl megnyitása és az indexek felépítése (a setup()-ból hívjuk)
+     */
+    void begin();
+
+    /**
+     * A memória csatornák száma
+     */
+    inline uint16_t getCount() const { return entryCount; }
+
+    /**
+     * Egy rekord beolvasása a fájlból
+     */
+    bool read(uint16_t slot, MemoryRecord &record);
+
+    /**
+     * Új memória csatorna felvétele (csak az új rekordot írjuk a fájlba)
+     * @return a slot száma, vagy -1, ha megtelt vagy írási hiba volt
+     */
+    int16_t add(const MemoryRecord &record);
+
+    /**
+     * Memória csatorna törlése (csak a rekord foglalt jelzőjét írjuk)
+     */
+    bool remove(uint16_t slot);
+
+    /**
+     * Frekvencia szerinti keresés
+     * @return az első, a freqHz-nél nem kisebb frekvenciájú csatorna pozíciója a frekvencia sorrendben (getCount(), ha nincs ilyen)
+     */
+    inline uint16_t findByFrequency(uint32_t freqHz) { return lowerBoundByFrequency(freqHz); }
+
+    /**
+     * Név szerinti keresés (a név első MEMORY_NAME_KEY_LENGTH karaktere, kis/nagybetű nem számít)
+     * @return az első, a névnél nem kisebb nevű csatorna pozíciója a név sorrendben (getCount(), ha nincs ilyen)
+     */
+    uint16_t findByName(const char *name);
+
+    /**
+     * A pontosan freqHz frekvenciájú csatorna keresése
+     * @return a slot száma, vagy -1, ha nincs ilyen
+     */
+    inline int16_t findSlotByFrequency(uint32_t freqHz) {
+        int16_t slot = getSlotByFrequencyPos(lowerBoundByFrequency(freqHz));
+        return (slot >= 0 and keys[slot].freqHz == freqHz) ? slot : -1;
+    }
+
+    /**
+     * Lapozás: a frekvencia / név sorrend adott pozícióján lévő slot
+     * @return a slot száma, vagy -1, ha a pozíció érvénytelen
+     */
+    inline int16_t getSlotByFrequencyPos(uint16_t pos) { return pos < entryCount ? freqIndex[pos] : -1; }
+    inline int16_t getSlotByNamePos(uint16_t pos) { return pos < entryCount ? nameIndex[pos] : -1; }
+};
+
+// Globális memória csatorna tár (a pico-radio.ino-ban példányosítjuk)
+extern MemoryStore memoryStore;
+
+#endif  //__MEMORYSTORE_H
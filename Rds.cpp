@@ -1,7 +1,18 @@
 #include "Rds.h"
 
+#include "AudioMute.h"
+#include "Config.h"
+#include "I2cTrace.h"
+#include "SignalSampler.h"
+
 #define RDS_GOOD_SNR 3  // Az RDS-re 'jó' vétel SNR értéke
 
+// AF váltás
+#define RDS_AF_CHECK_INTERVAL 10000  // Ilyen gyakran ellenőrizzük az AF jelölteket gyenge jelnél [msec]
+#define RDS_AF_TUNE_ESTIMATE 40      // Egy átállás + mérés becsült ideje az első mérésig [msec]
+#define RDS_AF_RSSI_HYSTERESIS 6     // Ennyivel kell jobbnak lennie az AF-nek a váltáshoz [dBuV]
+
+
 //-----------------------------------------------------------------------------------------------------------------
 /**
  * PTY típusok a PROGMEM-be töltve
@@ -79,8 +90,9 @@ int getLongestPtyStrLength() {
 /**
  * Konstruktor
  */
-Rds::Rds(TFT_eSPI &tft, SI4735 &si4735, uint16_t stationX, uint16_t stationY, uint16_t msgX, uint16_t msgY, uint16_t timeX, uint16_t timeY, uint16_t ptyX, uint16_t ptyY)
-    : tft(tft), si4735(si4735), stationX(stationX), stationY(stationY), msgX(msgX), msgY(msgY), timeX(timeX), timeY(timeY), ptyX(ptyX), ptyY(ptyY) {
+Rds::Rds(TFT_eSPI &tft, SI4735 &si4735, Band &band, uint16_t stationX, uint16_t stationY, uint16_t msgX, uint16_t msgY, uint16_t msgW, uint16_t timeX, uint16_t timeY, uint16_t ptyX,
+         uint16_t ptyY)
+    : tft(tft), rtSprite(&tft), si4735(si4735), band(band), stationX(stationX), stationY(stationY), msgX(msgX), msgY(msgY), msgW(msgW), timeX(timeX), timeY(timeY), ptyX(ptyX), ptyY(ptyY) {
 
     // Lekérjük a fontok méreteit (Fontos előtte beállítani a fontot!!)
     tft.setFreeFont();
@@ -97,116 +109,347 @@ Rds::Rds(TFT_eSPI &tft, SI4735 &si4735, uint16_t stationX, uint16_t stationY, ui
 
     // Megállapítjuk a leghosszabb karakterlánc hosszát a PTY PROGMEM tömbben
     ptyArrayMaxLength = getLongestPtyStrLength();
+
+    // RadioText doboz
+    msgCells = msgW / font1Width;
+    if (msgCells > MAX_MESSAGE_LENGTH) {
+        msgCells = MAX_MESSAGE_LENGTH;
+    }
+    memset(shownRt, ' ', sizeof(shownRt));
+
+    rtSprite.createSprite(msgW, font1Height);
+    rtSprite.setFreeFont();
+    rtSprite.setTextSize(1);
+    rtSprite.setTextDatum(TL_DATUM);
+    rtSprite.setTextColor(TFT_WHITE, TFT_BLACK);
+}
+
+/**
+ * Destruktor
+ * Képernyőváltáskor elmentjük az aktuális állomás adatait a cache-be
+ */
+Rds::~Rds() {
+    storeStation();
+    rtSprite.deleteSprite();
+}
+
+/**
+ * RadioText kirajzolása
+ * Ha elfér a dobozban, akkor csak a megváltozott karakter cellákat rajzoljuk újra,
+ * ha nem fér el, akkor a sprite-on keresztül görgetjük (a képernyő többi része nem változik)
+ *
+ * @param redraw minden cellát újra kell rajzolni
+ */
+void Rds::drawRadioText(bool redraw) {
+
+    const char *text = rdsDecoder.getRadioText();
+    uint8_t len = strlen(text);
+
+    if (len > msgCells) {
+        // Görgetés: a pozíciót megtartjuk, így a szöveg frissülésekor nem ugrik vissza az elejére
+        strcpy(rtScrollText, text);
+        rtScrollWidth = (len + RDS_RT_SCROLL_GAP_CHARS) * font1Width;
+        if (rtScrollPos >= rtScrollWidth) {
+            rtScrollPos = 0;
+        }
+        rtScrolling = true;
+        drawRtScrollFrame();
+
+        // A görgetés az egész dobozt felülírja, a cellák tartalma ismeretlen
+        memset(shownRt, 0, sizeof(shownRt));
+        return;
+    }
+
+    // Görgetésből jövünk -> minden cellát újra kell rajzolni
+    if (rtScrolling) {
+        rtScrolling = false;
+        rtScrollPos = 0;
+        redraw = true;
+    }
+
+    for (uint8_t i = 0; i < msgCells; i++) {
+        char c = i < len ? text[i] : ' ';
+        if (redraw or shownRt[i] != c) {
+            tft.drawChar(msgX + i * font1Width, msgY, c, TFT_WHITE, TFT_BLACK, 1);
+            shownRt[i] = c;
+        }
+    }
+}
+
+/**
+ * A görgetett RadioText aktuális képkockájának kirajzolása
+ * A szöveget kétszer rajzoljuk a sprite-ba, így a vége után folyamatosan jön az eleje
+ */
+void Rds::drawRtScrollFrame() {
+    rtSprite.fillSprite(TFT_BLACK);
+    rtSprite.drawString(rtScrollText, -rtScrollPos, 0);
+    rtSprite.drawString(rtScrollText, rtScrollWidth - rtScrollPos, 0);
+    rtSprite.pushSprite(msgX, msgY);
+}
+
+/**
+ * A hosszú RadioText görgetése
+ */
+void Rds::scrollRadioText() {
+
+    if (!rtScrolling or millis() - lastRtScroll < RDS_RT_SCROLL_INTERVAL_MSEC) {
+        return;
+    }
+    lastRtScroll = millis();
+
+    rtScrollPos += RDS_RT_SCROLL_STEP_PX;
+    if (rtScrollPos >= rtScrollWidth) {
+        rtScrollPos = 0;
+    }
+    drawRtScrollFrame();
+}
+
+/**
+ * A RAM pufferbe gyűjtött nyers RDS csoportok dekódolása
+ * (Dialóg alatt is hívjuk, így a dekóder állapota naprakész marad)
+ *
+ * @return true, ha a cache-ből előtöltött adatok vannak, amiket érdemes azonnal kirajzolni
+ */
+bool Rds::processGroups() {
+
+    RdsGroup group;
+    while (rdsGroupFifo.pop(group)) {
+        rdsDecoder.decodeGroup(group);
+    }
+
+    // Az első érvényes PI után megnézzük, hogy ismerjük-e már az állomást
+    if (stationCacheChecked or !rdsDecoder.hasPi()) {
+        return false;
+    }
+    stationCacheChecked = true;
+    stationFreq = si4735.getCurrentFrequency();
+
+    RdsCacheRecord record;
+    if (!rdsStationCache.lookup(stationFreq, rdsDecoder.getPi(), record)) {
+        return false;
+    }
+
+    DEBUG("Rds::processGroups() -> cache hit, PI: %04X\n", rdsDecoder.getPi());
+    rdsDecoder.seedStationData(record.pty, record.ps, nullptr, record.af, record.afCount);  // A RadioText-et nem tároljuk
+    return true;
+}
+
+/**
+ * Az aktuális állomás adatainak mentése a cache-be (ha már teljes az állomásnév)
+ */
+void Rds::storeStation() {
+    if (stationCacheChecked and rdsDecoder.hasPi() and rdsDecoder.hasStationName()) {
+        uint16_t afList[RDS_AF_MAX_COUNT];
+        uint8_t afCount = rdsDecoder.getAfCount();
+        for (uint8_t i = 0; i < afCount; i++) {
+            afList[i] = rdsDecoder.getAf(i);
+        }
+        rdsStationCache.store(stationFreq, rdsDecoder.getPi(), rdsDecoder.getPty(), rdsDecoder.getStationName(), afList, afCount);
+    }
+}
+
+/**
+ * Jobb AF keresése, ha az aktuális jel gyenge
+ * Rövid némított ablakban végigmérjük a jelölteket, a legerősebbre átállunk.
+ * Az ablak hossza (a visszaállással együtt) nem lépi túl a config.data.rdsAfMaxGapMsec-et,
+ * a kimaradt jelölteket a következő ellenőrzéskor mérjük meg.
+ *
+ * @param rssi az aktuális frekvencia RSSI-je
+ * @param minFreq a sáv alsó határa (a BandTable FM rekordjából)
+ * @param maxFreq a sáv felső határa
+ * @return az új frekvencia, ha átálltunk, egyébként 0
+ */
+uint16_t Rds::checkAlternativeFrequencies(uint8_t rssi, uint16_t minFreq, uint16_t maxFreq) {
+
+    if (config.data.rdsAfRssiThreshold == 0 or rssi >= config.data.rdsAfRssiThreshold) {
+        return 0;
+    }
+
+    if (!rdsDecoder.hasPi() or rdsDecoder.getAfCount() == 0 or millis() - lastAfCheck < RDS_AF_CHECK_INTERVAL) {
+        return 0;
+    }
+
+    Si4735State &chipState = band.getChipState();
+    uint16_t currentFreq = chipState.getTunedFrequency();
+    uint16_t bestFreq = 0;
+    uint8_t bestRssi = rssi + RDS_AF_RSSI_HYSTERESIS;
+    uint8_t afCount = rdsDecoder.getAfCount();
+
+    uint32_t windowStart = millis();
+    uint32_t tuneTime = RDS_AF_TUNE_ESTIMATE;  // A leghosszabb mért átállás ideje
+
+    I2cTrace::Caller traceCaller(I2cCaller::Rds);
+    audioMute.set(AudioMute::Reason::RdsAf, true);
+
+    for (uint8_t n = 0; n < afCount; n++) {
+
+        // A jelöltre és a visszaállásra is kell még idő
+        if (millis() - windowStart + 2 * tuneTime > (uint32_t)config.data.rdsAfMaxGapMsec) {
+            break;
+        }
+
+        uint8_t idx = (afScanIndex + n) % afCount;
+        afScanIndex = idx + 1;
+
+        uint16_t af = rdsDecoder.getAf(idx);
+        if (af == currentFreq or af < minFreq or af > maxFreq) {
+            continue;
+        }
+
+        // A chip állapotán át hangolunk: az STC-t nyugtázzuk és a frekvencia cache is követi
+        uint32_t tuneStart = millis();
+        chipState.beginTune(af);
+        chipState.waitTuneComplete();
+        SignalQuality afSignal = signalSampler.measure();  // Az AF-en mérünk, a csatorna snapshot-ja marad
+        uint8_t afRssi = afSignal.rssi;
+        uint8_t afSnr = afSignal.snr;
+
+        if (millis() - tuneStart > tuneTime) {
+            tuneTime = millis() - tuneStart;
+        }
+
+        if (afRssi >= bestRssi and afSnr >= RDS_GOOD_SNR) {
+            bestRssi = afRssi;
+            bestFreq = af;
+        }
+    }
+
+    // A legjobbra állunk, vagy vissza az eredetire
+    chipState.beginTune(bestFreq != 0 ? bestFreq : currentFreq);
+    chipState.waitTuneComplete();
+    audioMute.set(AudioMute::Reason::RdsAf, false);
+
+    // A mérés alatt más adók csoportjai is bekerülhettek a FIFO-ba
+    rdsGroupFifo.clear();
+
+    DEBUG("Rds::checkAlternativeFrequencies() -> gap: %d msec, rssi: %d, best AF: %d (rssi: %d)\n", millis() - windowStart, rssi, bestFreq, bestRssi);
+
+    lastAfCheck = millis();
+
+    // Az AF ugyanaz a PI, a dekóder állapota maradhat, csak a cache kulcsa változik
+    if (bestFreq != 0) {
+        stationFreq = bestFreq;
+    }
+
+    return bestFreq;
 }
 
 /**
  * RDS adatok megjelenítése
+ * Csak azt rajzoljuk újra, aminek a dekódernél megváltozott a verziója
  * (Az esetleges dialóg eltünése után a teljes képernyőt újra rajzolásakor kellhet -> forceDisplay = true)
  * @param forceDisplay erőből, ne csak a változáskor jelenítsen meg adatokat
  */
 void Rds::displayRds(bool forceDisplay) {
 
+    // Amíg nincs érvényes PI, addig nincs mit kiírni
+    if (!rdsDecoder.hasPi()) {
+        return;
+    }
+
+    // Ha a terület törölve lett, akkor mindent újra kell rajzolni
+    bool redraw = forceDisplay or !rdsDisplayed;
+
     tft.setFreeFont();
     tft.setTextDatum(BC_DATUM);
 
-    // Állomásnév
-    rdsStationName = si4735.getRdsText0A();
-    if (rdsStationName != NULL) {
+    // Állomásnév (mindig 8 karakter, így a háttérszín felülírja a régit)
+    if (redraw or shownPsVersion != rdsDecoder.getStationNameVersion()) {
+        shownPsVersion = rdsDecoder.getStationNameVersion();
         tft.setTextSize(2);
         tft.setTextColor(TFT_CYAN, TFT_BLACK);
         tft.setCursor(stationX, stationY);
-        tft.print(rdsStationName);
+        tft.print(rdsDecoder.getStationName());
     }
 
     // Info
-    rdsMsg = si4735.getRdsText2A();
-    if (rdsMsg != NULL) {
-        tft.setTextSize(1);
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.setCursor(msgX, msgY);
-        tft.print(rdsMsg);
+    if (redraw or shownRtVersion != rdsDecoder.getRadioTextVersion()) {
+        shownRtVersion = rdsDecoder.getRadioTextVersion();
+        drawRadioText(redraw);
     }
 
-    // Idő
-    char dateTime[20];
-    uint16_t year, month, day, hour, minute;
+    // Idő (helyi idő)
+    if (rdsDecoder.hasDateTime() and (redraw or shownCtVersion != rdsDecoder.getDateTimeVersion())) {
+        shownCtVersion = rdsDecoder.getDateTimeVersion();
 
-    bool rdsDateTimeSuccess = si4735.getRdsDateTime(&year, &month, &day, &hour, &minute);
-    // Ha izomból kell megjeleníteni vagy érvényes idő jött
-    if (forceDisplay or rdsDateTimeSuccess) {
-        // sprintf(dateTime, "%04d-%02d-%02d %02d:%02d", year, month, day, hour, minute);
-        //  DEBUG("RDS full datetime : %s  ", dateTime);
+        uint8_t hour, minute;
+        rdsDecoder.getLocalTime(hour, minute);
+
+        char dateTime[MAX_TIME_LENGTH + 1];
+        sprintf(dateTime, "%02d:%02d", hour, minute);
+        // DEBUG("RDS time : %s\n", dateTime);
 
         tft.setTextSize(1);
         tft.setTextDatum(BC_DATUM);
         tft.setTextColor(TFT_YELLOW, TFT_BLACK);
         tft.setCursor(timeX, timeY);
-        sprintf(dateTime, "%02d:%02d", hour, minute);
-        // DEBUG("RDS time : %s\n", dateTime);
         tft.print(dateTime);
     }
 
     // RDS program type (PTY)
-    uint8_t rdsPty = si4735.getRdsProgramType();
-    if (rdsPty < RDS_PTY_COUNT) {
-        const char *p = getPtyStrPointer(rdsPty);  // PTY String PROGMEM pointerének megszerzése
-
-        // Ha izomból kell megjeleníteni vagy változás van
-        if (forceDisplay or rdsProgramType != p) {
-            // clear RDS programType
-            tft.fillRect(ptyX, ptyY, font2Width * ptyArrayMaxLength, font2Height, TFT_BLACK);
-
-            // Elmentjük az új pointert
-            rdsProgramType = p;
-
-            // Kiírjuk a String-et a PROGMEM-ből
-            tft.setTextSize(2);
-            tft.setTextDatum(BC_DATUM);
-            tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-            tft.setCursor(ptyX, ptyY);
-            tft.print((const __FlashStringHelper *)rdsProgramType);
-        }
+    if (rdsDecoder.hasPty() and (redraw or shownPtyVersion != rdsDecoder.getPtyVersion())) {
+        shownPtyVersion = rdsDecoder.getPtyVersion();
+
+        // clear RDS programType
+        tft.fillRect(ptyX, ptyY, font2Width * ptyArrayMaxLength, font2Height, TFT_BLACK);
+
+        // Kiírjuk a String-et a PROGMEM-ből
+        tft.setTextSize(2);
+        tft.setTextDatum(BC_DATUM);
+        tft.setTextColor(TFT_YELLOW, TFT_BLACK);
+        tft.setCursor(ptyX, ptyY);
+        tft.print((const __FlashStringHelper *)getPtyStrPointer(rdsDecoder.getPty()));
     }
+
+    rdsDisplayed = true;
 }
 
 /**
  * RDS adatok megszerzése és megjelenítése
  */
 void Rds::checkRds() {
-
-    // Ha nincs RDS akkor nem megyünk tovább
-    si4735.getRdsStatus();
-    if (!si4735.getRdsReceived() or !si4735.getRdsSync() or !si4735.getRdsSyncFound()) {
-        return;
-    }
-
+    processGroups();
     displayRds();
 }
 
 /**
- *  RDS adatok törlése (csak FM módban hívható...nyílván....)
+ * Az RDS területek törlése a képernyőn
+ * A dekódolt adatok megmaradnak, a következő kirajzolás mindent újrarajzol
  */
-void Rds::clearRds() {
+void Rds::clearRdsArea() {
 
     // clear RDS rdsStationName
     tft.fillRect(stationX, stationY, font2Width * MAX_STATION_NAME_LENGTH, font2Height, TFT_BLACK);
     // tft.drawRect(stationX, stationY, font2Width * MAX_STATION_NAME_LENGTH, font2Height, TFT_YELLOW);
-    rdsStationName = NULL;
 
     // clear RDS rdsMsg
-    tft.fillRect(msgX, msgY, font1Width * MAX_MESSAGE_LENGTH, font1Height, TFT_BLACK);
-    // tft.drawRect(msgX, msgY, font1Width * MAX_MESSAGE_LENGTH, font1Height, TFT_YELLOW);
-    rdsMsg = NULL;
+    tft.fillRect(msgX, msgY, msgW, font1Height, TFT_BLACK);
+    // tft.drawRect(msgX, msgY, msgW, font1Height, TFT_YELLOW);
+    memset(shownRt, ' ', sizeof(shownRt));
+    rtScrolling = false;
+    rtScrollPos = 0;
 
     // clear RDS rdsTime
     tft.fillRect(timeX, timeY, font1Width * MAX_TIME_LENGTH, font1Height, TFT_BLACK);
     // tft.drawRect(timeX, timeY, font1Width * MAX_TIME_LENGTH, font1Height, TFT_YELLOW);
-    // this->rdsTime = NULL;
 
     // clear RDS programType
     tft.fillRect(ptyX, ptyY, font2Width * ptyArrayMaxLength, font2Height, TFT_BLACK);
     // tft.drawRect(ptyX, ptyY, font2Width * ptyArrayMaxLength, font2Height, TFT_YELLOW);
-    rdsProgramType = NULL;
+
+    rdsDisplayed = false;
+}
+
+/**
+ *  RDS adatok törlése (csak FM módban hívható...nyílván....)
+ *  Frekvencia váltáskor a dekóder állapotát is eldobjuk
+ */
+void Rds::clearRds() {
+    storeStation();
+    stationCacheChecked = false;
+    rdsGroupFifo.clear();
+    rdsDecoder.reset();
+    clearRdsArea();
 }
 
 /**
@@ -217,7 +460,8 @@ void Rds::showRDS(uint8_t snr) {
     // Ha 'jó' a vétel akkor rámozdulunk az RDS-re
     if (snr >= RDS_GOOD_SNR) {
         checkRds();
-    } else if (rdsStationName != NULL or rdsMsg != NULL) {
-        clearRds();  // töröljük az esetleges korábbi RDS adatokat
+    } else if (rdsDisplayed) {
+        // Gyenge vételnél csak a képernyőt töröljük, a szavazott karakterek megmaradnak
+        clearRdsArea();
     }
 }
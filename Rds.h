@@ -4,6 +4,10 @@
 #include <SI4735.h>
 #include <TFT_eSPI.h>
 
+#include "Band.h"
+#include "RdsDecoder.h"
+#include "RdsGroupFifo.h"
+#include "RdsStationCache.h"
 #include "utils.h"
 
 /**
@@ -12,23 +16,64 @@
 class Rds {
    private:
     TFT_eSPI &tft;
+    TFT_eSprite rtSprite;  // A görgetett RadioText sprite-ja (a doboz méretében)
     SI4735 &si4735;
+    Band &band;  // Az AF kereséshez a chip állapotán át hangolunk
 
-#define MAX_STATION_NAME_LENGTH 8
-    // Az SI4735 bufferét használjuk,
-    // ez csak ez jelző pointer a képernyő törlésének szükségességének jelzésére
-    char *rdsStationName = NULL;
-
-#define MAX_MESSAGE_LENGTH 64
-    // Az SI4735 bufferét használjuk,
-    // ez csak ez jelző pointer a képernyő törlésének szükségességének jelzésére
-    char *rdsMsg = NULL;
-
+#define MAX_STATION_NAME_LENGTH RDS_PS_LENGTH
+#define MAX_MESSAGE_LENGTH RDS_RT_LENGTH
 #define MAX_TIME_LENGTH 5
 
+#define RDS_RT_SCROLL_INTERVAL_MSEC 40  // A RadioText görgetésének üteme [msec]
+#define RDS_RT_SCROLL_STEP_PX 1         // Ütemenként ennyi pixelt görgetünk
+#define RDS_RT_SCROLL_GAP_CHARS 4       // A görgetett szöveg vége és az újrakezdés közti hely [karakter]
+
     // Program Type
-    uint8_t ptyArrayMaxLength;   // A RDS_PTY_ARRAY leghosszabb stringjének hossza, a képernyő törléshez
-    const char *rdsProgramType;  // RDS_PTY_ARRAY PROGMEM pointer a kiíráshoz
+    uint8_t ptyArrayMaxLength;  // A RDS_PTY_ARRAY leghosszabb stringjének hossza, a képernyő törléshez
+
+    // A nyers RDS csoportok dekódere
+    RdsDecoder rdsDecoder;
+
+    // A legutóbb kirajzolt adatok verziói, csak ezek változásakor rajzolunk
+    uint8_t shownPsVersion = 0;
+    uint8_t shownRtVersion = 0;
+    uint8_t shownCtVersion = 0;
+    uint8_t shownPtyVersion = 0;
+
+    // Van-e kirajzolt RDS adat a képernyőn
+    bool rdsDisplayed = false;
+
+    // Állomás cache
+    bool stationCacheChecked = false;  // Az aktuális PI-re már megnéztük a cache-t?
+    uint16_t stationFreq = 0;          // A PI dekódolásakor érvényes frekvencia
+
+    /**
+     * Az aktuális állomás adatainak mentése a cache-be
+     */
+    void storeStation();
+
+    // RadioText kijelzés
+    char shownRt[MAX_MESSAGE_LENGTH + 1];  // A képernyőn lévő (nem görgetett) karakterek, ezekhez képest rajzolunk
+    uint8_t msgCells;                      // Ennyi karakter fér a dobozba
+    bool rtScrolling = false;              // A szöveg nem fér el -> görgetjük
+    char rtScrollText[MAX_MESSAGE_LENGTH + 1];
+    uint16_t rtScrollWidth = 0;  // A görgetett szöveg szélessége a réssel együtt [px]
+    uint16_t rtScrollPos = 0;    // Az aktuális görgetési pozíció [px]
+    uint32_t lastRtScroll = 0;
+
+    /**
+     * RadioText kirajzolása: elférő szövegnél csak a változott karakter cellák, hosszabbnál görgetés
+     */
+    void drawRadioText(bool redraw);
+
+    /**
+     * A görgetett RadioText aktuális képkockájának kirajzolása
+     */
+    void drawRtScrollFrame();
+
+    // AF ellenőrzés
+    uint32_t lastAfCheck = 0;  // Az utolsó AF ellenőrzés időpontja
+    uint8_t afScanIndex = 0;   // Innen folytatjuk a jelöltek ellenőrzését a következő alkalommal
 
     // 1. font méretek
     uint8_t font1Height;
@@ -43,6 +88,7 @@ class Rds {
     uint16_t stationY;
     uint16_t msgX;
     uint16_t msgY;
+    uint16_t msgW;
     uint16_t timeX;
     uint16_t timeY;
     uint16_t ptyX;
@@ -53,11 +99,27 @@ class Rds {
      */
     void checkRds();
 
+    /**
+     * Az RDS területek törlése a képernyőn (a dekódolt adatok megmaradnak)
+     */
+    void clearRdsArea();
+
    public:
     /**
      * Konstruktor
      */
-    Rds(TFT_eSPI &Tft, SI4735 &si4735, uint16_t stationX, uint16_t stationY, uint16_t msgX, uint16_t msgY, uint16_t timeX, uint16_t timeY, uint16_t ptyX, uint16_t ptyY);
+    Rds(TFT_eSPI &Tft, SI4735 &si4735, Band &band, uint16_t stationX, uint16_t stationY, uint16_t msgX, uint16_t msgY, uint16_t msgW, uint16_t timeX, uint16_t timeY, uint16_t ptyX, uint16_t ptyY);
+
+    /**
+     * Destruktor
+     */
+    ~Rds();
+
+    /**
+     * A RAM pufferbe gyűjtött nyers RDS csoportok dekódolása
+     * @return true, ha a cache-ből előtöltött adatok vannak
+     */
+    bool processGroups();
 
     /**
      *  RDS adatok törlése (csak FM módban)
@@ -69,6 +131,17 @@ class Rds {
      */
     void showRDS(uint8_t snr);
 
+    /**
+     * Jobb AF keresése, ha az aktuális jel gyenge
+     * @return az új frekvencia, ha átálltunk, egyébként 0
+     */
+    uint16_t checkAlternativeFrequencies(uint8_t rssi, uint16_t minFreq, uint16_t maxFreq);
+
+    /**
+     * A hosszú RadioText görgetése (a displayLoop-ból gyakran hívjuk, a saját ütemében lép)
+     */
+    void scrollRadioText();
+
     /**
      * RDS adatok megjelenítése
      * (Az esetleges dialóg eltűnése után a teljes képernyőt újra rajzolásakor kellhet)
@@ -0,0 +1,529 @@
+#include "RdsDecoder.h"
+
+// Szavazási paraméterek
+#define RDS_CHAR_MAX_CONFIDENCE 12  // A bizalmi szint felső korlátja (ennyi 'ellenszavazat' kell a cseréhez)
+#define RDS_CHAR_SHOW_CONFIDENCE 2  // Ettől a bizalmi szinttől jelenítjük meg a karaktert
+#define RDS_PI_CONFIRM_COUNT 2      // Ennyi egyező PI kell az állomásváltáshoz
+#define RDS_PTY_CONFIRM_COUNT 2     // Ennyi egyező PTY kell az elfogadáshoz
+
+// AF kódok (EN 50067 3.2.1.6)
+#define RDS_AF_CODE_FIRST_FREQ 1    // 87.6MHz
+#define RDS_AF_CODE_LAST_FREQ 204   // 107.9MHz
+#define RDS_AF_CODE_COUNT_BASE 224  // 224..249: ennyi AF következik (kód - 224)
+#define RDS_AF_CODE_COUNT_LAST 249
+#define RDS_AF_CODE_LFMF 250  // LF/MF frekvencia következik
+
+/**
+ * A blokk hibaszintjéhez tartozó szavazati súly
+ * A javíthatatlan blokk nem szavazhat
+ */
+static inline uint8_t voteWeight(uint8_t ble) {
+    switch (ble) {
+        case RDS_BLE_NONE:
+            return 3;
+        case RDS_BLE_CORRECTED_1_2:
+            return 2;
+        case RDS_BLE_CORRECTED_3_5:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Két hibaszint közül a rosszabb
+ */
+static inline uint8_t worstBle(uint8_t ble1, uint8_t ble2) { return ble1 > ble2 ? ble1 : ble2; }
+
+/**
+ * Minden dekódolt adat törlése
+ */
+void RdsDecoder::reset() {
+
+    pi = 0;
+    piCandidate = 0;
+    piCandidateCount = 0;
+    piValid = false;
+
+    resetStationData();
+
+    groupsReceived = 0;
+    groupsDiscarded = 0;
+}
+
+/**
+ * Az állomáshoz kötött adatok törlése (PI váltáskor)
+ */
+void RdsDecoder::resetStationData() {
+
+    pty = 0;
+    ptyCandidate = 0;
+    ptyCandidateCount = 0;
+    ptyValid = false;
+
+    memset(ps, 0, sizeof(ps));
+    memset(rt, 0, sizeof(rt));
+    rtLength = RDS_RT_LENGTH;
+    rtAbFlag = 0;
+    rtAbFlagValid = false;
+    buildPsText();
+    buildRtText();
+
+    afCount = 0;
+    afListHead = 0;
+
+    ctValid = false;
+    ctYear = 0;
+    ctMonth = ctDay = ctHour = ctMinute = 0;
+    ctOffset = 0;
+
+    // A verziókat nem nullázzuk, csak léptetjük, így a kijelzés észreveszi a törlést
+    piVersion++;
+    ptyVersion++;
+    psVersion++;
+    rtVersion++;
+    ctVersion++;
+    afVersion++;
+}
+
+/**
+ * Karakter szavazás egy pozícióra
+ * Egyező karakter növeli, eltérő csökkenti a bizalmat; ha elfogy, az új karakter nyer
+ *
+ * @param slot a pozíció szavazási állapota
+ * @param c a beérkezett karakter
+ * @param ble a karaktert hordozó blokk hibaszintje
+ * @return true, ha a pozíción megjelenítendő karakter megváltozott
+ */
+bool RdsDecoder::voteChar(VotedChar &slot, uint8_t c, uint8_t ble) {
+
+    uint8_t weight = voteWeight(ble);
+    if (weight == 0) {
+        return false;
+    }
+
+    // Csak a nyomtatható ASCII karaktereket vesszük át, a többit szóközzel helyettesítjük
+    char ch = (c >= 0x20 and c < 0x7F) ? static_cast<char>(c) : ' ';
+
+    char prevShown = shownChar(slot);
+
+    if (slot.value == ch) {
+        slot.confidence = (slot.confidence + weight > RDS_CHAR_MAX_CONFIDENCE) ? RDS_CHAR_MAX_CONFIDENCE : slot.confidence + weight;
+    } else if (slot.confidence > weight) {
+        slot.confidence -= weight;
+    } else {
+        slot.value = ch;
+        slot.confidence = weight;
+    }
+
+    return shownChar(slot) != prevShown;
+}
+
+/**
+ * Egy szavazott karakter megjeleníthető értéke
+ * A még bizonytalan pozíciókon szóközt mutatunk
+ */
+char RdsDecoder::shownChar(const VotedChar &slot) { return (slot.value != 0 and slot.confidence >= RDS_CHAR_SHOW_CONFIDENCE) ? slot.value : ' '; }
+
+/**
+ * A PS szöveg újraépítése
+ */
+void RdsDecoder::buildPsText() {
+    for (uint8_t i = 0; i < RDS_PS_LENGTH; i++) {
+        psText[i] = shownChar(ps[i]);
+    }
+    psText[RDS_PS_LENGTH] = '\0';
+}
+
+/**
+ * Az RT szöveg újraépítése (a záró karakterig, a végéről a szóközök levágásával)
+ */
+void RdsDecoder::buildRtText() {
+    uint8_t len = 0;
+    for (uint8_t i = 0; i < rtLength; i++) {
+        rtText[i] = shownChar(rt[i]);
+        if (rtText[i] != ' ') {
+            len = i + 1;
+        }
+    }
+    rtText[len] = '\0';
+}
+
+/**
+ * Az állomásnév minden pozíciója megbízható már?
+ */
+bool RdsDecoder::hasStationName() const {
+    for (uint8_t i = 0; i < RDS_PS_LENGTH; i++) {
+        if (ps[i].value == 0 or ps[i].confidence < RDS_CHAR_SHOW_CONFIDENCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * PI dekódolása
+ * Az első hibátlan PI azonnal érvényes, az állomásváltáshoz viszont több egyező PI kell
+ */
+void RdsDecoder::decodePi(uint16_t blockA, uint8_t ble) {
+
+    if (ble > RDS_BLE_CORRECTED_1_2) {
+        return;
+    }
+
+    if (blockA == piCandidate) {
+        if (piCandidateCount < 0xFF) piCandidateCount++;
+    } else {
+        piCandidate = blockA;
+        piCandidateCount = 1;
+    }
+
+    if (piValid and pi == piCandidate) {
+        return;
+    }
+
+    bool accept = piValid ? (piCandidateCount >= RDS_PI_CONFIRM_COUNT) : (ble == RDS_BLE_NONE or piCandidateCount >= RDS_PI_CONFIRM_COUNT);
+    if (accept) {
+        // Másik állomás jött, a korábbi adatok érvénytelenek
+        if (piValid) {
+            resetStationData();
+        }
+        pi = piCandidate;
+        piValid = true;
+        piVersion++;
+    }
+}
+
+/**
+ * PTY dekódolása
+ */
+void RdsDecoder::decodePty(uint8_t value, uint8_t ble) {
+
+    if (ble > RDS_BLE_CORRECTED_1_2) {
+        return;
+    }
+
+    if (value == ptyCandidate) {
+        if (ptyCandidateCount < 0xFF) ptyCandidateCount++;
+    } else {
+        ptyCandidate = value;
+        ptyCandidateCount = 1;
+    }
+
+    if (ptyCandidateCount >= RDS_PTY_CONFIRM_COUNT and (!ptyValid or pty != ptyCandidate)) {
+        pty = ptyCandidate;
+        ptyValid = true;
+        ptyVersion++;
+    }
+}
+
+/**
+ * 0A/0B csoport: állomásnév (PS) szegmens a D blokkban
+ */
+void RdsDecoder::decodeGroup0(const RdsGroup &group) {
+
+    uint8_t segment = group.blocks[B] & 0x03;
+    uint8_t ble = worstBle(group.ble[B], group.ble[D]);
+
+    bool changed = voteChar(ps[segment * 2], group.blocks[D] >> 8, ble);
+    changed |= voteChar(ps[segment * 2 + 1], group.blocks[D] & 0xFF, ble);
+
+    if (changed) {
+        buildPsText();
+        psVersion++;
+    }
+
+    // 0A: a C blokkban két AF kód van (0B-ben ott a PI)
+    bool versionB = (group.blocks[B] >> 11) & 0x01;
+    if (!versionB and group.ble[C] <= RDS_BLE_CORRECTED_1_2) {
+        decodeAf(group.blocks[C] >> 8, group.blocks[C] & 0xFF);
+    }
+}
+
+/**
+ * Egy AF kód átalakítása frekvenciává (10kHz egységben)
+ * @return 0, ha a kód nem (FM) frekvencia
+ */
+static uint16_t afCodeToFreq(uint8_t code) {
+    if (code < RDS_AF_CODE_FIRST_FREQ or code > RDS_AF_CODE_LAST_FREQ) {
+        return 0;
+    }
+    return 8750 + code * 10;
+}
+
+/**
+ * Egy frekvencia felvétele az AF listára (ha még nincs rajta)
+ */
+void RdsDecoder::addAf(uint16_t freq) {
+
+    if (freq == 0 or afCount >= RDS_AF_MAX_COUNT) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < afCount; i++) {
+        if (afList[i] == freq) {
+            return;
+        }
+    }
+
+    afList[afCount++] = freq;
+    afVersion++;
+}
+
+/**
+ * AF kódpár dekódolása (A és B módszer)
+ *
+ * A módszer: a darabszám kód után egyszerűen felsorolja a frekvenciákat.
+ * B módszer: a darabszám kód után a hangolt frekvencia jön, majd a párok egyik tagja mindig ez a frekvencia.
+ * Ha a pár növekvő, akkor a másik tag ugyanazt a műsort sugározza, ha csökkenő, akkor regionális változat (azt kihagyjuk).
+ */
+void RdsDecoder::decodeAf(uint8_t code1, uint8_t code2) {
+
+    // Lista kezdete: darabszám + az első frekvencia
+    if (code1 >= RDS_AF_CODE_COUNT_BASE and code1 <= RDS_AF_CODE_COUNT_LAST) {
+        afListHead = afCodeToFreq(code2);
+        addAf(afListHead);
+        return;
+    }
+
+    // Az LF/MF frekvenciákkal nem foglalkozunk
+    if (code1 == RDS_AF_CODE_LFMF) {
+        return;
+    }
+
+    uint16_t freq1 = afCodeToFreq(code1);
+    uint16_t freq2 = afCodeToFreq(code2);
+
+    // B módszer: a pár egyik tagja a lista fejében lévő (hangolt) frekvencia
+    if (afListHead != 0 and freq1 != 0 and freq2 != 0 and freq1 != freq2 and (freq1 == afListHead or freq2 == afListHead)) {
+        if (freq1 < freq2) {
+            addAf(freq1 == afListHead ? freq2 : freq1);
+        }
+        return;
+    }
+
+    addAf(freq1);
+    addAf(freq2);
+}
+
+/**
+ * 2A/2B csoport: RadioText szegmens
+ * 2A: 4 karakter a C és D blokkban, 2B: 2 karakter a D blokkban
+ */
+void RdsDecoder::decodeGroup2(const RdsGroup &group, bool versionB) {
+
+    uint8_t segment = group.blocks[B] & 0x0F;
+    uint8_t abFlag = (group.blocks[B] >> 4) & 0x01;
+    bool changed = false;
+
+    // A/B flag váltás -> új szöveg jön, a régit töröljük (csak megbízható B blokk esetén)
+    if (group.ble[B] <= RDS_BLE_CORRECTED_1_2) {
+        if (rtAbFlagValid and abFlag != rtAbFlag) {
+            memset(rt, 0, sizeof(rt));
+            rtLength = RDS_RT_LENGTH;
+            changed = true;
+        }
+        rtAbFlag = abFlag;
+        rtAbFlagValid = true;
+    }
+
+    uint8_t chars[4];
+    uint8_t bles[4];
+    uint8_t count;
+    uint8_t pos;
+
+    if (versionB) {
+        count = 2;
+        pos = segment * 2;
+        if (rtLength > RDS_RT_LENGTH_B) {
+            rtLength = RDS_RT_LENGTH_B;
+        }
+        chars[0] = group.blocks[D] >> 8;
+        chars[1] = group.blocks[D] & 0xFF;
+        bles[0] = bles[1] = worstBle(group.ble[B], group.ble[D]);
+    } else {
+        count = 4;
+        pos = segment * 4;
+        chars[0] = group.blocks[C] >> 8;
+        chars[1] = group.blocks[C] & 0xFF;
+        chars[2] = group.blocks[D] >> 8;
+        chars[3] = group.blocks[D] & 0xFF;
+        bles[0] = bles[1] = worstBle(group.ble[B], group.ble[C]);
+        bles[2] = bles[3] = worstBle(group.ble[B], group.ble[D]);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+
+        // A 0x0D a szöveg végét jelzi
+        if (chars[i] == 0x0D) {
+            if (bles[i] <= RDS_BLE_CORRECTED_1_2 and rtLength != pos + i) {
+                rtLength = pos + i;
+                changed = true;
+            }
+            break;
+        }
+        changed |= voteChar(rt[pos + i], chars[i], bles[i]);
+    }
+
+    if (changed) {
+        buildRtText();
+        rtVersion++;
+    }
+}
+
+/**
+ * 4A csoport: dátum és idő (CT)
+ * Az idő kritikus adat, csak hibátlan vagy 1-2 bittel javított blokkokat fogadunk el
+ */
+void RdsDecoder::decodeGroup4A(const RdsGroup &group) {
+
+    if (group.ble[B] > RDS_BLE_CORRECTED_1_2 or group.ble[C] > RDS_BLE_CORRECTED_1_2 or group.ble[D] > RDS_BLE_CORRECTED_1_2) {
+        return;
+    }
+
+    uint16_t blockB = group.blocks[B];
+    uint16_t blockC = group.blocks[C];
+    uint16_t blockD = group.blocks[D];
+
+    int32_t mjd = (static_cast<int32_t>(blockB & 0x03) << 15) | (blockC >> 1);
+    uint8_t hour = ((blockC & 0x01) << 4) | (blockD >> 12);
+    uint8_t minute = (blockD >> 6) & 0x3F;
+    int8_t offset = blockD & 0x1F;
+    if (blockD & 0x20) {
+        offset = -offset;
+    }
+
+    if (mjd < 15079 or hour > 23 or minute > 59 or offset < -24 or offset > 24) {
+        return;
+    }
+
+    // MJD -> dátum, egész aritmetikával (EN 50067 G. melléklet)
+    int32_t yp = (mjd * 20 - 301564) / 7305;
+    int32_t ypDays = (yp * 1461) / 4;
+    int32_t mp = ((mjd - ypDays) * 10000 - 149561000) / 306001;
+    int32_t day = mjd - 14956 - ypDays - (mp * 306001) / 10000;
+    int32_t k = (mp == 14 or mp == 15) ? 1 : 0;
+
+    ctYear = 1900 + yp + k;
+    ctMonth = mp - 1 - k * 12;
+    ctDay = day;
+    ctHour = hour;
+    ctMinute = minute;
+    ctOffset = offset;
+    ctValid = true;
+    ctVersion++;
+}
+
+/**
+ * Egy nyers csoport feldolgozása
+ */
+void RdsDecoder::decodeGroup(const RdsGroup &group) {
+
+    groupsReceived++;
+
+    // A PI minden csoport A blokkjában benne van
+    decodePi(group.blocks[A], group.ble[A]);
+
+    // Javíthatatlan B blokk esetén a csoport típusa sem ismert, eldobjuk
+    if (group.ble[B] > RDS_BLE_CORRECTED_3_5) {
+        groupsDiscarded++;
+        return;
+    }
+
+    uint8_t groupType = group.blocks[B] >> 12;
+    bool versionB = (group.blocks[B] >> 11) & 0x01;
+
+    // A B verziójú csoportok C blokkjában is a PI van
+    if (versionB) {
+        decodePi(group.blocks[C], group.ble[C]);
+    }
+
+    // PTY minden csoport B blokkjában
+    decodePty((group.blocks[B] >> 5) & 0x1F, group.ble[B]);
+
+    switch (groupType) {
+        case 0:
+            decodeGroup0(group);
+            break;
+
+        case 2:
+            decodeGroup2(group, versionB);
+            break;
+
+        case 4:
+            if (!versionB) {
+                decodeGroup4A(group);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Az állomás adatainak előtöltése (pl.: a cache-ből, a PI dekódolása után)
+ * A karakterek a legkisebb megjeleníthető bizalmi szinttel kerülnek be,
+ * így az első eltérő élő karakter azonnal felülírja őket.
+ *
+ * @param ptyValue a PTY
+ * @param psText az állomásnév (RDS_PS_LENGTH hosszú, nem kell lezárni)
+ * @param rtText a RadioText (lezárt string), vagy nullptr
+ * @param afFreqs az alternatív frekvenciák listája, vagy nullptr
+ * @param afFreqCount a lista hossza
+ */
+void RdsDecoder::seedStationData(uint8_t ptyValue, const char *psText, const char *rtText, const uint16_t *afFreqs, uint8_t afFreqCount) {
+
+    for (uint8_t i = 0; i < RDS_PS_LENGTH; i++) {
+        // Ha már jött élő karakter az adott pozícióra, azt nem írjuk felül
+        if (ps[i].value == 0) {
+            ps[i].value = psText[i];
+            ps[i].confidence = RDS_CHAR_SHOW_CONFIDENCE;
+        }
+    }
+    buildPsText();
+    psVersion++;
+
+    if (!ptyValid) {
+        pty = ptyValue;
+        ptyValid = true;
+        ptyVersion++;
+    }
+
+    if (rtText != nullptr) {
+        for (uint8_t i = 0; i < RDS_RT_LENGTH and rtText[i] != '\0'; i++) {
+            if (rt[i].value == 0) {
+                rt[i].value = rtText[i];
+                rt[i].confidence = RDS_CHAR_SHOW_CONFIDENCE;
+            }
+        }
+        buildRtText();
+        rtVersion++;
+    }
+
+    // Az AF lista bővítése (a már vett frekvenciákat az addAf() kiszűri)
+    for (uint8_t i = 0; afFreqs != nullptr and i < afFreqCount; i++) {
+        addAf(afFreqs[i]);
+    }
+}
+
+/**
+ * A dekódolt UTC dátum és idő lekérése
+ */
+void RdsDecoder::getUtcDateTime(uint16_t &year, uint8_t &month, uint8_t &day, uint8_t &hour, uint8_t &minute) const {
+    year = ctYear;
+    month = ctMonth;
+    day = ctDay;
+    hour = ctHour;
+    minute = ctMinute;
+}
+
+/**
+ * A helyi idő (óra:perc) lekérése, az adó által küldött eltéréssel korrigálva
+ */
+void RdsDecoder::getLocalTime(uint8_t &hour, uint8_t &minute) const {
+    int16_t minutes = ctHour * 60 + ctMinute + ctOffset * 30;
+    minutes = (minutes % (24 * 60) + 24 * 60) % (24 * 60);
+    hour = minutes / 60;
+    minute = minutes % 60;
+}
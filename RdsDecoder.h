@@ -0,0 +1,185 @@
+#ifndef __RDSDECODER_H
+#define __RDSDECODER_H
+
+#include <cstdint>
+#include <cstring>
+
+#define RDS_PS_LENGTH 8     // Program Service (állomásnév) hossza
+#define RDS_RT_LENGTH 64    // RadioText maximális hossza (2A csoport)
+#define RDS_RT_LENGTH_B 32  // RadioText maximális hossza (2B csoport)
+#define RDS_AF_MAX_COUNT 25  // Az AF lista maximális hossza
+
+// Blokk hibaszintek (BLE - Block Error), ahogy az SI4735 FM_RDS_STATUS válaszában jönnek
+#define RDS_BLE_NONE 0           // Hibátlan blokk
+#define RDS_BLE_CORRECTED_1_2 1  // 1-2 bit hiba javítva
+#define RDS_BLE_CORRECTED_3_5 2  // 3-5 bit hiba javítva
+#define RDS_BLE_UNCORRECTABLE 3  // Javíthatatlan blokk
+
+/**
+ * Egy nyers RDS csoport: az A-D blokkok és a blokkonkénti hibaszintek
+ */
+struct RdsGroup {
+    uint16_t blocks[4];  // A, B, C, D blokkok
+    uint8_t ble[4];      // A blokkok hibaszintje (RDS_BLE_xxx)
+};
+
+/**
+ * Nyers RDS csoport dekóder
+ * A chip FIFO-jából kiolvasott csoportokból maga rakja össze a PI, PTY, PS, RT és CT adatokat.
+ * A karakterek pozíciónként súlyozott szavazással (a blokk hibaszintje szerint) állnak be,
+ * így gyenge vételnél sem jelennek meg a hibás karakterek.
+ *
+ * Szándékosan nincs Arduino függősége.
+ */
+class RdsDecoder {
+
+   public:
+    // Blokk indexek a RdsGroup-ban
+    enum Block { A = 0, B = 1, C = 2, D = 3 };
+
+   private:
+    // Egy karakter pozíció szavazási állapota
+    struct VotedChar {
+        char value;          // Az aktuálisan nyerő karakter
+        uint8_t confidence;  // A karakter 'bizalmi' szintje
+    };
+
+    // PI (Program Identification)
+    uint16_t pi;
+    uint16_t piCandidate;
+    uint8_t piCandidateCount;
+    bool piValid;
+
+    // PTY (Program Type)
+    uint8_t pty;
+    uint8_t ptyCandidate;
+    uint8_t ptyCandidateCount;
+    bool ptyValid;
+
+    // PS (Program Service - állomásnév)
+    VotedChar ps[RDS_PS_LENGTH];
+    char psText[RDS_PS_LENGTH + 1];
+
+    // RT (RadioText)
+    VotedChar rt[RDS_RT_LENGTH];
+    char rtText[RDS_RT_LENGTH + 1];
+    uint8_t rtLength;  // A 0x0D záró karakter pozíciója, vagy a maximális hossz
+    uint8_t rtAbFlag;  // A 'Text A/B' flag, változáskor törölni kell a szöveget
+    bool rtAbFlagValid;
+
+    // AF (Alternative Frequencies) - az aktuális PI-hez tartozó lista, 10kHz egységben
+    uint16_t afList[RDS_AF_MAX_COUNT];
+    uint8_t afCount;
+    uint16_t afListHead;  // A lista kezdő kódja utáni frekvencia (B módszernél a hangolt frekvencia)
+
+    // CT (Clock Time) - UTC + helyi eltérés
+    bool ctValid;
+    uint16_t ctYear;
+    uint8_t ctMonth;
+    uint8_t ctDay;
+    uint8_t ctHour;
+    uint8_t ctMinute;
+    int8_t ctOffset;  // Helyi idő eltérése félórákban
+
+    // Változásszámlálók, a kijelzés csak ezek változásakor frissít
+    uint8_t piVersion = 0;
+    uint8_t ptyVersion = 0;
+    uint8_t psVersion = 0;
+    uint8_t rtVersion = 0;
+    uint8_t ctVersion = 0;
+    uint8_t afVersion = 0;
+
+    // Statisztika
+    uint32_t groupsReceived;   // Összes beérkezett csoport
+    uint32_t groupsDiscarded;  // Eldobott csoportok (javíthatatlan B blokk)
+
+    /**
+     * Karakter szavazás egy pozícióra
+     * @return true, ha a pozíción lévő (megjeleníthető) karakter megváltozott
+     */
+    bool voteChar(VotedChar &slot, uint8_t c, uint8_t ble);
+
+    /**
+     * Egy szavazott karakter megjeleníthető értéke
+     */
+    static char shownChar(const VotedChar &slot);
+
+    /**
+     * A PS/RT szövegek újraépítése a szavazott karakterekből
+     */
+    void buildPsText();
+    void buildRtText();
+
+    /**
+     * Az állomáshoz kötött adatok törlése (PI váltáskor)
+     */
+    void resetStationData();
+
+    /**
+     * Csoport típusonkénti dekódolás
+     */
+    void decodePi(uint16_t blockA, uint8_t ble);
+    void decodePty(uint8_t value, uint8_t ble);
+    void decodeGroup0(const RdsGroup &group);
+    void decodeAf(uint8_t code1, uint8_t code2);
+    void addAf(uint16_t freq);
+    void decodeGroup2(const RdsGroup &group, bool versionB);
+    void decodeGroup4A(const RdsGroup &group);
+
+   public:
+    /**
+     * Konstruktor
+     */
+    RdsDecoder() { reset(); }
+
+    /**
+     * Minden dekódolt adat törlése (pl.: átálláskor)
+     */
+    void reset();
+
+    /**
+     * Egy nyers csoport feldolgozása
+     */
+    void decodeGroup(const RdsGroup &group);
+
+    /**
+     * Az állomás adatainak előtöltése (pl.: a cache-ből), az élő adatok ezt megerősítik vagy felülírják
+     */
+    void seedStationData(uint8_t ptyValue, const char *psText, const char *rtText, const uint16_t *afFreqs = nullptr, uint8_t afFreqCount = 0);
+
+    // PI
+    inline bool hasPi() const { return piValid; }
+    inline uint16_t getPi() const { return pi; }
+    inline uint8_t getPiVersion() const { return piVersion; }
+
+    // PTY
+    inline bool hasPty() const { return ptyValid; }
+    inline uint8_t getPty() const { return pty; }
+    inline uint8_t getPtyVersion() const { return ptyVersion; }
+
+    // PS
+    inline const char *getStationName() const { return psText; }
+    inline uint8_t getStationNameVersion() const { return psVersion; }
+    bool hasStationName() const;
+
+    // RT
+    inline const char *getRadioText() const { return rtText; }
+    inline uint8_t getRadioTextVersion() const { return rtVersion; }
+
+    // AF
+    inline uint8_t getAfCount() const { return afCount; }
+    inline uint16_t getAf(uint8_t idx) const { return afList[idx]; }
+    inline uint8_t getAfVersion() const { return afVersion; }
+
+    // CT
+    inline bool hasDateTime() const { return ctValid; }
+    inline uint8_t getDateTimeVersion() const { return ctVersion; }
+    void getUtcDateTime(uint16_t &year, uint8_t &month, uint8_t &day, uint8_t &hour, uint8_t &minute) const;
+    void getLocalTime(uint8_t &hour, uint8_t &minute) const;
+
+    // Statisztika
+    inline uint32_t getGroupsReceived() const { return groupsReceived; }
+    inline uint32_t getGroupsDiscarded() const { return groupsDiscarded; }
+};
+
+#endif  //__RDSDECODER_H
@@ -0,0 +1,132 @@
+#include "RdsGroupFifo.h"
+
+#include "I2cTrace.h"
+#include "utils.h"
+
+// FM_RDS_STATUS parancs argumentum bitjei és válasz mérete
+#define FM_RDS_STATUS_INTACK 0x01      // A legrégebbi csoport kivétele a FIFO-ból (és az RDSINT törlése)
+#define FM_RDS_STATUS_MTFIFO 0x02      // A FIFO ürítése
+#define FM_RDS_STATUS_STATUSONLY 0x04  // Csak az állapot lekérdezése, a FIFO nem változik
+#define FM_RDS_STATUS_RESP_SIZE 13     // A válasz mérete bájtban
+#define RDS_FIFO_MAX_GROUPS 25         // A chip RDS FIFO-jának mérete (csoport)
+
+// Megszakítás beállítások
+#define GPO_IEN_RDSIEN 0x0004             // GPO_IEN: RDS megszakítás engedélyezése
+#define FM_RDS_INT_SOURCE_RDSRECV 0x0001  // FM_RDS_INT_SOURCE: megszakítás, ha a FIFO-ban legalább FM_RDS_INT_FIFO_COUNT csoport van
+
+/**
+ * A chip RDS megszakításának engedélyezése
+ */
+void RdsGroupFifo::enableInterrupt() {
+#ifdef __USE_RDS_INTERRUPT
+    si4735.setProperty(FM_RDS_INT_FIFO_COUNT, RDS_FIFO_INT_GROUP_COUNT);
+    si4735.setProperty(FM_RDS_INT_SOURCE, FM_RDS_INT_SOURCE_RDSRECV);
+    si4735.setProperty(GPO_IEN, GPO_IEN_RDSIEN);
+#endif
+}
+
+/**
+ * A chip FIFO kiolvasása a RAM pufferbe
+ * Előbb csak a FIFO állapotát kérdezzük le (STATUSONLY), majd egyenként kivesszük (INTACK) a benne lévő csoportokat
+ */
+void RdsGroupFifo::drainChipFifo() {
+
+    uint8_t arg = FM_RDS_STATUS_STATUSONLY;
+    uint8_t resp[FM_RDS_STATUS_RESP_SIZE];
+
+    {
+        I2cTrace::Scope trace(FM_RDS_STATUS, 2 + FM_RDS_STATUS_RESP_SIZE);
+        si4735.waitToSend();
+        si4735.sendCommand(FM_RDS_STATUS, 1, &arg);
+        si4735.waitToSend();
+        si4735.getCommandResponse(FM_RDS_STATUS_RESP_SIZE, resp);
+    }
+
+    uint8_t fifoUsed = resp[3] > RDS_FIFO_MAX_GROUPS ? RDS_FIFO_MAX_GROUPS : resp[3];
+
+    for (uint8_t i = 0; i < fifoUsed; i++) {
+
+        arg = FM_RDS_STATUS_INTACK;
+        {
+            I2cTrace::Scope trace(FM_RDS_STATUS, 2 + FM_RDS_STATUS_RESP_SIZE);
+            si4735.waitToSend();
+            si4735.sendCommand(FM_RDS_STATUS, 1, &arg);
+            si4735.waitToSend();
+            si4735.getCommandResponse(FM_RDS_STATUS_RESP_SIZE, resp);
+        }
+
+        // Ha tele a puffer, akkor a legrégebbit dobjuk el
+        if (available() == RDS_GROUP_BUFFER_SIZE - 1) {
+            tail = (tail + 1) & (RDS_GROUP_BUFFER_SIZE - 1);
+            overflowCount++;
+        }
+
+        RdsGroup &group = buffer[head];
+
+        // Blokkok: resp[4..11], a felső bájt van elöl
+        for (uint8_t b = 0; b < 4; b++) {
+            group.blocks[b] = (resp[4 + b * 2] << 8) | resp[5 + b * 2];
+        }
+
+        // Hibaszintek: resp[12] -> BLEA(7:6), BLEB(5:4), BLEC(3:2), BLED(1:0)
+        group.ble[RdsDecoder::A] = (resp[12] >> 6) & 0x03;
+        group.ble[RdsDecoder::B] = (resp[12] >> 4) & 0x03;
+        group.ble[RdsDecoder::C] = (resp[12] >> 2) & 0x03;
+        group.ble[RdsDecoder::D] = resp[12] & 0x03;
+
+        head = (head + 1) & (RDS_GROUP_BUFFER_SIZE - 1);
+    }
+}
+
+/**
+ * A loop()-ból hívjuk: ha jött megszakítás, vagy letelt az időzítés, akkor kiürítjük a chip FIFO-t
+ */
+void RdsGroupFifo::loop() {
+
+#ifdef __USE_RDS_INTERRUPT
+    // Az elveszett megszakítás él miatt ritkán azért ránézünk magunktól is
+    bool due = irqPending or (millis() - lastService >= RDS_FIFO_SAFETY_INTERVAL);
+#else
+    bool due = millis() - lastService >= RDS_FIFO_POLL_INTERVAL;
+#endif
+
+    if (!due) {
+        return;
+    }
+
+    irqPending = false;
+    drainChipFifo();
+    lastService = millis();
+}
+
+/**
+ * A legrégebbi csoport kivétele a RAM pufferből
+ */
+bool RdsGroupFifo::pop(RdsGroup &group) {
+
+    if (head == tail) {
+        return false;
+    }
+
+    group = buffer[tail];
+    tail = (tail + 1) & (RDS_GROUP_BUFFER_SIZE - 1);
+    return true;
+}
+
+/**
+ * A RAM puffer és a chip FIFO törlése (pl.: frekvencia váltáskor)
+ */
+void RdsGroupFifo::clear() {
+
+    uint8_t arg = FM_RDS_STATUS_MTFIFO | FM_RDS_STATUS_INTACK;
+    uint8_t resp[FM_RDS_STATUS_RESP_SIZE];
+
+    I2cTrace::Scope trace(FM_RDS_STATUS, 2 + FM_RDS_STATUS_RESP_SIZE);
+    si4735.waitToSend();
+    si4735.sendCommand(FM_RDS_STATUS, 1, &arg);
+    si4735.waitToSend();
+    si4735.getCommandResponse(FM_RDS_STATUS_RESP_SIZE, resp);
+
+    head = tail = 0;
+    irqPending = false;
+}
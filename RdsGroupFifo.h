@@ -0,0 +1,93 @@
+#ifndef __RDSGROUPFIFO_H
+#define __RDSGROUPFIFO_H
+
+#include <SI4735.h>
+
+#include "RdsDecoder.h"
+
+// Az SI4735 GPO2/INT lábának megszakítását használjuk az RDS FIFO kiürítésére
+// (Ha nincs bekötve az INT láb, akkor ezt ki kell kommentezni -> csak időzített lekérdezés lesz)
+#define __USE_RDS_INTERRUPT
+
+#define RDS_GROUP_BUFFER_SIZE 64       // A RAM puffer mérete (csoport), 2 hatványa kell legyen!
+#define RDS_FIFO_INT_GROUP_COUNT 1     // Ennyi csoport után kérünk megszakítást a chiptől (1 -> a PI azonnal megjön)
+#define RDS_FIFO_POLL_INTERVAL 200     // Megszakítás nélkül ilyen gyakran ürítjük a chip FIFO-t [msec]
+#define RDS_FIFO_SAFETY_INTERVAL 1000  // Megszakítással is ilyen gyakran ránézünk (elveszett él esetére) [msec]
+
+/**
+ * Az SI4735 RDS FIFO-jának kiürítése egy RAM gyűrűs pufferbe
+ * A chip FIFO-ja csak 25 csoportos (~2mp), ezért a loop()-ból ürítjük, nem a képernyő frissítési ciklusából.
+ * A megszakítás kezelő csak jelez, az I2C forgalom mindig a loop()-ban történik.
+ */
+class RdsGroupFifo {
+
+   private:
+    SI4735 &si4735;
+
+    // Gyűrűs puffer
+    RdsGroup buffer[RDS_GROUP_BUFFER_SIZE];
+    uint8_t head = 0;  // Ide írunk
+    uint8_t tail = 0;  // Innen olvasunk
+
+    // A megszakítás kezelő ezt állítja be
+    volatile bool irqPending = false;
+
+    // Utolsó chip FIFO kiürítés időpontja
+    uint32_t lastService = 0;
+
+    // Statisztika
+    uint32_t overflowCount = 0;  // Eldobott (felülírt) csoportok száma
+
+    /**
+     * A chip FIFO kiolvasása a RAM pufferbe
+     */
+    void drainChipFifo();
+
+   public:
+    /**
+     * Konstruktor
+     */
+    RdsGroupFifo(SI4735 &si4735) : si4735(si4735) {}
+
+    /**
+     * Megszakítás jelzése (a megszakítás kezelőből hívjuk, csak a flag-et állítja!)
+     */
+    inline void setIrqPending() { irqPending = true; }
+
+    /**
+     * A chip RDS megszakításának engedélyezése
+     * (A chip bekapcsolásakor a property-k törlődnek, ezért minden setFM() után újra kell hívni)
+     */
+    void enableInterrupt();
+
+    /**
+     * A loop()-ból hívjuk: ha jött megszakítás, vagy letelt az időzítés, akkor kiürítjük a chip FIFO-t
+     */
+    void loop();
+
+    /**
+     * A legrégebbi csoport kivétele a RAM pufferből
+     * @return false, ha üres a puffer
+     */
+    bool pop(RdsGroup &group);
+
+    /**
+     * A RAM puffer és a chip FIFO törlése (pl.: frekvencia váltáskor)
+     */
+    void clear();
+
+    /**
+     * A pufferben lévő csoportok száma
+     */
+    inline uint8_t available() const { return (head - tail) & (RDS_GROUP_BUFFER_SIZE - 1); }
+
+    /**
+     * A puffer túlcsordulása miatt eldobott csoportok száma
+     */
+    inline uint32_t getOverflowCount() const { return overflowCount; }
+};
+
+// Globális RDS FIFO (a pico-radio.ino-ban példányosítjuk)
+extern RdsGroupFifo rdsGroupFifo;
+
+#endif  //__RDSGROUPFIFO_H
@@ -0,0 +1,236 @@
+#include "RdsStationCache.h"
+
+#include <LittleFS.h>
+
+#include "utils.h"
+
+#define RDS_CACHE_HEADER_SIZE sizeof(uint32_t)  // A fájl elején lévő magic mérete
+
+/**
+ * Inicializálás: a fájl megnyitása és az index felépítése
+ */
+void RdsStationCache::begin() {
+
+    fsReady = LittleFS.begin();
+    if (!fsReady) {
+        DEBUG("RdsStationCache::begin() -> LittleFS mount error\n");
+        return;
+    }
+
+    entryCount = 0;
+    useCounter = 0;
+
+    File file = LittleFS.open(RDS_CACHE_FILE_NAME, "r");
+    uint32_t magic = 0;
+    if (file) {
+        file.read((uint8_t *)&magic, sizeof(magic));
+    }
+
+    // Nincs még fájl, vagy más a formátuma -> újat kezdünk
+    if (magic != RDS_CACHE_MAGIC) {
+        if (file) {
+            file.close();
+        }
+        file = LittleFS.open(RDS_CACHE_FILE_NAME, "w");
+        magic = RDS_CACHE_MAGIC;
+        file.write((const uint8_t *)&magic, sizeof(magic));
+        file.close();
+        DEBUG("RdsStationCache::begin() -> new cache file created\n");
+        return;
+    }
+
+    // Index felépítése
+    RdsCacheRecord record;
+    while (entryCount < RDS_CACHE_MAX_ENTRIES and file.read((uint8_t *)&record, sizeof(record)) == sizeof(record)) {
+        IndexEntry &entry = index[entryCount++];
+        entry.freq = record.freq;
+        entry.pi = record.pi;
+        entry.lastUsed = record.lastUsed;
+        entry.pty = record.pty;
+        memcpy(entry.ps, record.ps, RDS_PS_LENGTH);
+
+        if (record.lastUsed > useCounter) {
+            useCounter = record.lastUsed;
+        }
+    }
+    file.close();
+
+    DEBUG("RdsStationCache::begin() -> %d stations loaded\n", entryCount);
+}
+
+/**
+ * Rekord keresése az indexben
+ */
+int16_t RdsStationCache::find(uint16_t freq, uint16_t pi) {
+    for (uint16_t i = 0; i < entryCount; i++) {
+        if (index[i].freq == freq and index[i].pi == pi) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Egy rekord kiírása a fájlba
+ */
+bool RdsStationCache::writeRecord(uint16_t slot, const RdsCacheRecord &record) {
+
+    File file = LittleFS.open(RDS_CACHE_FILE_NAME, "r+");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = file.seek(RDS_CACHE_HEADER_SIZE + slot * sizeof(RdsCacheRecord)) and file.write((const uint8_t *)&record, sizeof(record)) == sizeof(record);
+    file.close();
+
+    return ok;
+}
+
+/**
+ * Egy rekord beolvasása a fájlból
+ */
+bool RdsStationCache::readRecord(uint16_t slot, RdsCacheRecord &record) {
+
+    File file = LittleFS.open(RDS_CACHE_FILE_NAME, "r");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = file.seek(RDS_CACHE_HEADER_SIZE + slot * sizeof(RdsCacheRecord)) and file.read((uint8_t *)&record, sizeof(record)) == sizeof(record);
+    file.close();
+
+    return ok;
+}
+
+/**
+ * Állomás keresése
+ */
+bool RdsStationCache::lookup(uint16_t freq, uint16_t pi, RdsCacheRecord &record) {
+
+    if (!fsReady) {
+        return false;
+    }
+
+    // A még nem mentett rekord a legfrissebb
+    for (int8_t i = pendingCount - 1; i >= 0; i--) {
+        if (pending[i].freq == freq and pending[i].pi == pi) {
+            record = pending[i];
+            return true;
+        }
+    }
+
+    int16_t slot = find(freq, pi);
+
+    // Nincs pontos találat -> ugyanaz a PI másik frekvencián (a legutóbb használt)
+    if (slot < 0) {
+        for (uint16_t i = 0; i < entryCount; i++) {
+            if (index[i].pi == pi and (slot < 0 or index[i].lastUsed > index[slot].lastUsed)) {
+                slot = i;
+            }
+        }
+    }
+
+    if (slot < 0 or !readRecord(slot, record)) {
+        return false;
+    }
+
+    // Az LRU sorrendet csak a RAM-ban frissítjük (a flash-be csak a rekord következő, változás miatti mentésekor kerül)
+    index[slot].lastUsed = ++useCounter;
+
+    return true;
+}
+
+/**
+ * Állomás adatainak feljegyzése mentésre
+ * Az állomásváltáskor hívjuk, ezért itt nem nyúlunk a fájlhoz
+ */
+void RdsStationCache::store(uint16_t freq, uint16_t pi, uint8_t pty, const char *ps, const uint16_t *af, uint8_t afCount) {
+
+    if (!fsReady) {
+        return;
+    }
+
+    // Ugyanaz az állomás már vár: azt frissítjük, különben új hely kell (tele sornál a legrégebbit eldobjuk)
+    uint8_t idx = 0;
+    while (idx < pendingCount and (pending[idx].freq != freq or pending[idx].pi != pi)) {
+        idx++;
+    }
+    if (idx == pendingCount) {
+        if (pendingCount == RDS_CACHE_PENDING_SIZE) {
+            DEBUG("RdsStationCache::store() -> pending queue full, PI %04X dropped\n", pending[0].pi);
+            memmove(&pending[0], &pending[1], (RDS_CACHE_PENDING_SIZE - 1) * sizeof(RdsCacheRecord));
+            pendingCount--;
+        }
+        idx = pendingCount++;
+    }
+
+    RdsCacheRecord &record = pending[idx];
+    memset(&record, 0, sizeof(record));
+    record.freq = freq;
+    record.pi = pi;
+    record.pty = pty;
+    memcpy(record.ps, ps, RDS_PS_LENGTH);
+    record.afCount = min(afCount, (uint8_t)RDS_AF_MAX_COUNT);
+    memcpy(record.af, af, record.afCount * sizeof(uint16_t));
+
+    lastStore = millis();
+}
+
+/**
+ * A függő rekordok mentése, hívásonként legfeljebb egy
+ */
+void RdsStationCache::loop() {
+
+    if (pendingCount == 0 or millis() - lastStore < RDS_CACHE_WRITE_DELAY_MSEC) {
+        return;
+    }
+
+    writeStation(pending[0]);
+    pendingCount--;
+    memmove(&pending[0], &pending[1], pendingCount * sizeof(RdsCacheRecord));
+}
+
+/**
+ * Egy rekord mentése a fájlba (csak akkor írunk a flash-be, ha változott valami)
+ */
+void RdsStationCache::writeStation(const RdsCacheRecord &pendingRecord) {
+
+    RdsCacheRecord record = pendingRecord;
+    int16_t slot = find(record.freq, record.pi);
+
+    if (slot >= 0) {
+        // Ha nem változott semmi, akkor nem koptatjuk a flash-t
+        RdsCacheRecord stored;
+        if (index[slot].pty == record.pty and memcmp(index[slot].ps, record.ps, RDS_PS_LENGTH) == 0 and readRecord(slot, stored) and
+            stored.afCount == record.afCount and memcmp(stored.af, record.af, record.afCount * sizeof(uint16_t)) == 0) {
+            index[slot].lastUsed = ++useCounter;
+            return;
+        }
+
+    } else if (entryCount < RDS_CACHE_MAX_ENTRIES) {
+        // Van még hely, a végére írunk
+        slot = entryCount++;
+
+    } else {
+        // Megtelt, a legrégebben használt rekordot írjuk felül
+        slot = 0;
+        for (uint16_t i = 1; i < entryCount; i++) {
+            if (index[i].lastUsed < index[slot].lastUsed) {
+                slot = i;
+            }
+        }
+    }
+
+    record.lastUsed = ++useCounter;
+
+    IndexEntry &entry = index[slot];
+    entry.freq = record.freq;
+    entry.pi = record.pi;
+    entry.lastUsed = record.lastUsed;
+    entry.pty = record.pty;
+    memcpy(entry.ps, record.ps, RDS_PS_LENGTH);
+
+    if (!writeRecord(slot, record)) {
+        DEBUG("RdsStationCache::writeStation() -> write error, slot: %d\n", slot);
+    }
+}
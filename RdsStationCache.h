@@ -0,0 +1,119 @@
+#ifndef __RDSSTATIONCACHE_H
+#define __RDSSTATIONCACHE_H
+
+#include <Arduino.h>
+
+#include "RdsDecoder.h"
+
+#define RDS_CACHE_FILE_NAME "/rdscache.bin"  // A cache fájl neve a LittleFS-en
+#define RDS_CACHE_MAX_ENTRIES 256            // A cache maximális mérete (rekord)
+#define RDS_CACHE_MAGIC 0x52445333           // 'RDS3' - fájl formátum azonosító, formátum váltáskor léptetni kell
+#define RDS_CACHE_PENDING_SIZE 4             // Ennyi állomás várhat mentésre (ha több, a legrégebbit eldobjuk)
+#define RDS_CACHE_WRITE_DELAY_MSEC 5000      // Az utolsó store() után ennyivel írunk, üresjáratban
+
+/**
+ * Egy cache rekord a fájlban (fix méretű)
+ */
+struct RdsCacheRecord {
+    uint16_t freq;                  // Frekvencia (10kHz egységben, ahogy az si4735 használja)
+    uint16_t pi;                    // PI kód
+    uint32_t lastUsed;              // LRU számláló (a mentés ideje, lásd lent)
+    uint8_t pty;                    // Program típus
+    char ps[RDS_PS_LENGTH];         // Állomásnév (nincs lezárva)
+    uint8_t afCount;                // Az AF lista hossza
+    uint16_t af[RDS_AF_MAX_COUNT];  // Alternatív frekvenciák (10kHz egységben)
+};
+
+/**
+ * PI kód + frekvencia alapú RDS állomás cache
+ * Átálláskor a PI dekódolása után azonnal megjeleníthető a legutóbbi PS/PTY, ezt aztán az élő adatok megerősítik vagy felülírják.
+ * Az AF listát is megőrizzük, így gyenge jelnél az AF keresés a 0A csoportok újbóli vétele nélkül indulhat.
+ * A RadioText-et nem tároljuk: szinte folyamatosan változik, így szinte minden állomásváltás írással járna.
+ *
+ * A rekordok fix méretben a LittleFS fájlban vannak, a RAM-ban csak a kereséshez szükséges index van (az AF lista a fájlban marad).
+ * Ha megtelt, akkor a legrégebben használt rekord helyére írunk.
+ *
+ * A store() nem ír: az állomásváltáskor (a hangolás útján) csak a RAM-ban jegyezzük fel a rekordot, a fájlba a loop() írja
+ * üresjáratban, az utolsó store() után RDS_CACHE_WRITE_DELAY_MSEC-el.
+ *
+ * Az LRU számláló a fájlba csak a rekord mentésekor kerül: a keresés (és a változatlan mentés) csak a RAM indexben
+ * frissíti, hogy egy állomásváltás ne járjon flash írással. Így egy futás alatt a tényleges használat, újraindítás után
+ * viszont az utolsó mentés ideje szerint dobjuk el a legrégebbi rekordot.
+ *
+ * A fájl írása a LittleFS-en keresztül, letiltott megszakításokkal megy, nem a FlashWriter-en (lásd ott).
+ */
+class RdsStationCache {
+
+   private:
+    // RAM index egy eleme
+    struct IndexEntry {
+        uint16_t freq;
+        uint16_t pi;
+        uint32_t lastUsed;
+        uint8_t pty;
+        char ps[RDS_PS_LENGTH];
+    };
+
+    IndexEntry index[RDS_CACHE_MAX_ENTRIES];
+    uint16_t entryCount = 0;
+    uint32_t useCounter = 0;  // A legnagyobb kiosztott LRU érték
+    bool fsReady = false;
+
+    // Mentésre váró rekordok (a legrégebbi elöl)
+    RdsCacheRecord pending[RDS_CACHE_PENDING_SIZE];
+    uint8_t pendingCount = 0;
+    uint32_t lastStore = 0;
+
+    /**
+     * Rekord keresése az indexben
+     * @return a rekord indexe, vagy -1
+     */
+    int16_t find(uint16_t freq, uint16_t pi);
+
+    /**
+     * Egy rekord kiírása a fájlba
+     */
+    bool writeRecord(uint16_t slot, const RdsCacheRecord &record);
+
+    /**
+     * Egy rekord beolvasása a fájlból
+     */
+    bool readRecord(uint16_t slot, RdsCacheRecord &record);
+
+    /**
+     * Egy rekord mentése a fájlba (csak akkor írunk a flash-be, ha változott valami)
+     */
+    void writeStation(const RdsCacheRecord &record);
+
+   public:
+    /**
+     * Inicializálás: a fájl megnyitása és az index felépítése (a setup()-ból hívjuk)
+     */
+    void begin();
+
+    /**
+     * Állomás keresése
+     * Elsősorban a frekvencia + PI egyezést keressük, ha az nincs, akkor a más frekvencián fogott azonos PI-t (ugyanaz az adó lánc)
+     *
+     * @param freq a frekvencia
+     * @param pi a PI kód
+     * @param record ide kerül a megtalált rekord
+     * @return true, ha volt találat
+     */
+    bool lookup(uint16_t freq, uint16_t pi, RdsCacheRecord &record);
+
+    /**
+     * Állomás adatainak feljegyzése mentésre (a fájlba a loop() írja)
+     */
+    void store(uint16_t freq, uint16_t pi, uint8_t pty, const char *ps, const uint16_t *af, uint8_t afCount);
+
+    /**
+     * A függő rekordok mentése (üresjáratban, hangolás és szkennelés nélkül hívjuk), hívásonként legfeljebb egy rekord
+     */
+    void loop();
+};
+
+// Globális RDS állomás cache (a pico-radio.ino-ban példányosítjuk)
+extern RdsStationCache rdsStationCache;
+
+#endif  //__RDSSTATIONCACHE_H
@@ -9,6 +9,8 @@
 
 #include "RotaryEncoder.h"
 
+#include "utils.h"
+
 // ----------------------------------------------------------------------------
 // Gomb konfiguráció (értékek 1ms-os időzítő szolgáltatás hívásokhoz)
 //
@@ -17,21 +19,20 @@
 #define ENC_HOLDTIME 1200        // a gomb lenyomva tartásának jelentése 1.2s után
 
 // ----------------------------------------------------------------------------
-// Gyorsulás konfiguráció (1000Hz-es ::service() hívásokhoz)
-// #define ENC_ACCEL_TOP 3072  // max. gyorsulás: *12 (val >> 8)
-#define ENC_ACCEL_TOP 6400  // max. gyorsulás: *25 (val >> 8)
-#define ENC_ACCEL_INC 50    // gyorsulás növelése
-#define ENC_ACCEL_DEC 2     // lassítás mértéke
+// Alapértelmezett gyorsítási görbe (a két lépés közötti időből számolt sebesség alapján)
+// 5 lépés/sec alatt nincs gyorsítás, 50 lépés/sec felett 25-szörös
+static constexpr RotaryEncoder::AccelerationPoint DEFAULT_ACCELERATION_POINTS[] = {{5, 1}, {50, 25}};
+const RotaryEncoder::AccelerationCurve RotaryEncoder::DEFAULT_ACCELERATION_CURVE = {DEFAULT_ACCELERATION_POINTS, ARRAY_ITEM_COUNT(DEFAULT_ACCELERATION_POINTS)};
 
 // ----------------------------------------------------------------------------
 
-#if ENC_DECODER != ENC_NORMAL
+#if ENC_DECODER == ENC_FLAKY
 #ifdef ENC_HALFSTEP
 // dekódolási táblázat hibás léptető hardverhez (fél felbontás)
-const int8_t ClickEncoder::table[16] __attribute__((__progmem__)) = {0, 0, -1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, -1, 0, 0};
+int8_t RotaryEncoder::table[16] = {0, 0, -1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, -1, 0, 0};
 #else
 // dekódolási táblázat normál hardverhez
-const int8_t ClickEncoder::table[16] __attribute__((__progmem__)) = {0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, -1, 1, 0};
+int8_t RotaryEncoder::table[16] = {0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, -1, 1, 0};
 #endif
 #endif
 
@@ -46,9 +47,9 @@ RotaryEncoder::RotaryEncoder(uint8_t A, uint8_t B, uint8_t BTN, uint8_t stepsPer
       pinsActive(pinsActive),
       doubleClickEnabled(true),
       accelerationEnabled(true),
+      pAccelerationCurve(&DEFAULT_ACCELERATION_CURVE),
       delta(0),
       last(0),
-      acceleration(0),
       buttonState(ButtonState::Open) {
 
     uint8_t mode = (pinsActive == LOW) ? INPUT_PULLUP : INPUT;
@@ -63,90 +64,200 @@ RotaryEncoder::RotaryEncoder(uint8_t A, uint8_t B, uint8_t BTN, uint8_t stepsPer
     if (digitalRead(pinB) == pinsActive) {
         last ^= 1;
     }
+
+#if ENC_DECODER == ENC_PIO
+    pioReady = pioBegin();
+    if (!pioReady) {
+        DEBUG("RotaryEncoder -> PIO decoder not available, falling back to ENC_NORMAL\n");
+    }
+#endif
 }
 
+#if ENC_DECODER == ENC_PIO
+// ----------------------------------------------------------------------------
+// PIO kvadratúra dekóder
+//
+// Az állapotgép folyamatosan mintavételezi a két lábat, az előző és az aktuális állapotból (4 bit) egy ugrótáblával
+// dönti el, hogy léptetni kell-e az Y számlálót, és minden körben (blokkolás nélkül) beírja az Y-t az RX FIFO-ba.
+// A FIFO így a kiürítése után néhány tíz usec alatt megtelik, és a további (frissebb) értékek elvesznek: a service() ezért
+// eldobja a bent lévőket, és megvárja a következőt (pico-examples quadrature_encoder_get_count() mintája).
+// A számolás teljesen hardveres, a service() csak kiolvassa a számláló friss értékét (nem marad le gyors tekerésnél sem).
+// A program a 0. címre kell kerüljön, mert a 'mov pc, isr' az ugrótábla indexével abszolút címre ugrik.
+//
+#define ENC_PIO_DEC_ADDR 16     // decrement: jmp y--, update
+#define ENC_PIO_UPDATE_ADDR 17  // update (wrap target): mov isr, y / push noblock
+#define ENC_PIO_INC_ADDR 23     // increment: mov y, ~y / jmp y--, +1 / mov y, ~y
+#define ENC_PIO_WRAP_ADDR 25    // Az utolsó utasítás
+#define ENC_PIO_PROGRAM_LENGTH 26
+#define ENC_PIO_CLKDIV 125.0f  // 125MHz / 125 = 1MHz állapotgép órajel (kb. 8 utasítás mintánként -> ~125kHz mintavétel)
+#define ENC_PIO_FRESH_TIMEOUT_USEC 50  // Legfeljebb ennyit várunk a friss értékre (egy kör ~8 usec)
+
 /**
- * Megszakításból hívogatjuk 1msec-enként
+ * A PIO dekóder indítása
  */
-void RotaryEncoder::service() {
-    bool moved = false;
-    unsigned long now = millis();
-
-    if (accelerationEnabled) {  // lassítás minden ciklusban
-        acceleration -= ENC_ACCEL_DEC;
-        if (acceleration & 0x8000) {  // MSB be van állítva, túlcsordulás kezelése
-            acceleration = 0;
+bool RotaryEncoder::pioBegin() {
+
+    static uint16_t instructions[ENC_PIO_PROGRAM_LENGTH];
+
+    // Ugrótábla: index = előző állapot (2 bit) << 2 | aktuális állapot (2 bit), a 00 -> 01 -> 11 -> 10 sorrend a növekvő irány
+    static const uint8_t transition[16] = {
+        ENC_PIO_UPDATE_ADDR, ENC_PIO_INC_ADDR,    ENC_PIO_DEC_ADDR,    ENC_PIO_UPDATE_ADDR,  // 00 -> 00, 01, 10, 11
+        ENC_PIO_DEC_ADDR,    ENC_PIO_UPDATE_ADDR, ENC_PIO_UPDATE_ADDR, ENC_PIO_INC_ADDR,     // 01 -> 00, 01, 10, 11
+        ENC_PIO_INC_ADDR,    ENC_PIO_UPDATE_ADDR, ENC_PIO_UPDATE_ADDR, ENC_PIO_DEC_ADDR,     // 10 -> 00, 01, 10, 11
+        ENC_PIO_UPDATE_ADDR, ENC_PIO_DEC_ADDR,    ENC_PIO_INC_ADDR,    ENC_PIO_UPDATE_ADDR,  // 11 -> 00, 01, 10, 11
+    };
+    for (uint8_t i = 0; i < 16; i++) {
+        instructions[i] = pio_encode_jmp(transition[i]);
+    }
+    instructions[16] = pio_encode_jmp_y_dec(ENC_PIO_UPDATE_ADDR);  // decrement
+    instructions[17] = pio_encode_mov(pio_isr, pio_y);             // update: a számláló a FIFO-ba
+    instructions[18] = pio_encode_push(false, false);              // push noblock: tele FIFO esetén eldobjuk
+    instructions[19] = pio_encode_out(pio_isr, 2);                 // Az előző állapot (2 bit) az ISR-be
+    instructions[20] = pio_encode_in(pio_pins, 2);                 // Mellé az aktuális állapot
+    instructions[21] = pio_encode_mov(pio_osr, pio_isr);           // A következő körhöz
+    instructions[22] = pio_encode_mov(pio_pc, pio_isr);            // Ugrás az ugrótáblába
+    instructions[23] = pio_encode_mov_not(pio_y, pio_y);           // increment: y = ~(~y - 1) = y + 1
+    instructions[24] = pio_encode_jmp_y_dec(ENC_PIO_WRAP_ADDR);    // y-- (mindkét ágon a következő utasítás)
+    instructions[25] = pio_encode_mov_not(pio_y, pio_y);           // Innen a wrap az update-re visz
+
+    pio_program_t program = {};
+    program.instructions = instructions;
+    program.length = ENC_PIO_PROGRAM_LENGTH;
+    program.origin = 0;
+
+    // A két lábnak egymás mellett kell lennie, az alacsonyabb az 0. bit
+    uint8_t base = min(pinA, pinB);
+    if (abs((int)pinA - (int)pinB) != 1) {
+        DEBUG("RotaryEncoder::pioBegin() -> the encoder pins are not consecutive!\n");
+        return false;
+    }
+    pioReversed = pinA < pinB;
+
+    pio = pio0;
+    if (!pio_can_add_program_at_offset(pio, &program, 0)) {
+        pio = pio1;
+        if (!pio_can_add_program_at_offset(pio, &program, 0)) {
+            DEBUG("RotaryEncoder::pioBegin() -> no free PIO program space at offset 0!\n");
+            return false;
         }
     }
+    int claimed = pio_claim_unused_sm(pio, false);
+    if (claimed < 0) {
+        DEBUG("RotaryEncoder::pioBegin() -> no free PIO state machine!\n");
+        return false;
+    }
+    sm = claimed;
+    pio_add_program_at_offset(pio, &program, 0);
 
-#if ENC_DECODER == ENC_FLAKY
+    // Csak bemenetek, a felhúzó ellenállásokat a konstruktor már beállította
+    pio_sm_set_consecutive_pindirs(pio, sm, base, 2, false);
+
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, ENC_PIO_UPDATE_ADDR, ENC_PIO_WRAP_ADDR);
+    sm_config_set_in_pins(&c, base);
+    sm_config_set_in_shift(&c, false, false, 32);  // Balra léptetés (előző << 2 | aktuális), nincs autopush
+    sm_config_set_out_shift(&c, true, false, 32);  // Jobbra léptetés: az OSR alsó 2 bitje az aktuális állapot
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&c, ENC_PIO_CLKDIV);
+
+    pio_sm_init(pio, sm, ENC_PIO_UPDATE_ADDR, &c);
+
+    // Az Y számláló kezdőértéke nem definiált: indulás előtt nullázzuk, ehhez mérjük a lépéseket
+    pio_sm_exec(pio, sm, pio_encode_set(pio_y, 0));
+    pioLastCount = 0;
+
+    pio_sm_set_enabled(pio, sm, true);
+    return true;
+}
+#endif
+
+/**
+ * Megszakításból hívogatjuk 1msec-enként
+ * RAM-ban fut: flash-ben lévő függvényt (digitalRead(), millis()) nem hívhat
+ */
+void __not_in_flash_func(RotaryEncoder::service)() {
+    uint32_t now = timer_hw->timerawl;
+
+#if ENC_DECODER == ENC_PIO
+    if (pioReady) {
+        // A FIFO-ban lévő értékek elavultak (a tele FIFO a frissebbeket eldobta): kiürítjük, és a következő kört megvárjuk
+        uint8_t stale = (pio->flevel >> (PIO_FLEVEL_RX0_LSB + sm * 8)) & (PIO_FLEVEL_RX0_BITS >> PIO_FLEVEL_RX0_LSB);
+        while (stale--) {
+            (void)(uint32_t)pio->rxf[sm];
+        }
+        uint32_t count = pioLastCount;
+        while (pio->fstat & (1u << (PIO_FSTAT_RXEMPTY_LSB + sm))) {
+            if (timer_hw->timerawl - now > ENC_PIO_FRESH_TIMEOUT_USEC) {
+                break;
+            }
+        }
+        if (!(pio->fstat & (1u << (PIO_FSTAT_RXEMPTY_LSB + sm)))) {
+            count = pio->rxf[sm];
+        }
+        int16_t moved = (int16_t)(count - pioLastCount);
+        pioLastCount = count;
+        delta += pioReversed ? -moved : moved;
+    } else {
+        decodePins();  // A PIO dekóder nem indult el
+    }
+#elif ENC_DECODER == ENC_FLAKY
     last = (last << 2) & 0x0F;
 
-    if (digitalRead(pinA) == pinsActive) {
+    if (isPinActive(pinA)) {
         last |= 2;
     }
 
-    if (digitalRead(pinB) == pinsActive) {
+    if (isPinActive(pinB)) {
         last |= 1;
     }
 
-    uint8_t tbl = pgm_read_byte(&table[last]);
+    int8_t tbl = table[last];
     if (tbl) {
         delta += tbl;
-        moved = true;
     }
 #elif ENC_DECODER == ENC_NORMAL
-    int8_t curr = 0;
-
-    if (digitalRead(pinA) == pinsActive) {
-        curr = 3;
-    }
-
-    if (digitalRead(pinB) == pinsActive) {
-        curr ^= 1;
-    }
-
-    int8_t diff = last - curr;
-
-    if (diff & 1) {  // 0. bit = lépés
-        last = curr;
-        delta += (diff & 2) - 1;  // 1. bit = irány (+/-)
-        moved = true;
-    }
+    decodePins();
 #else
-#error "Hiba: definiáld az ENC_DECODER-t ENC_NORMAL-ra vagy ENC_FLAKY-re"
+#error "Hiba: definiáld az ENC_DECODER-t ENC_NORMAL-ra, ENC_FLAKY-re vagy ENC_PIO-ra"
 #endif
 
-    if (accelerationEnabled && moved) {
-        // növeli a gyorsítót, ha az enkóder el lett mozdítva
-        if (acceleration <= (ENC_ACCEL_TOP - ENC_ACCEL_INC)) {
-            acceleration += ENC_ACCEL_INC;
-        }
+    // Egész lépésenként (stepsPerNotch impulzus) összegyűlt lépések egy forgatás eseményben, az előző lépés óta eltelt idővel
+    // Ha egy hívás alatt több lépés gyűlt össze (gyors tekerés, PIO), az eltelt időt a read() osztja szét közöttük.
+    // Itt nem osztunk: a Cortex-M0+ osztó rutinja (__aeabi_uidiv) a flash-ben van, a service() pedig a flash írás alatt is fut
+    int8_t direction = delta > 0 ? 1 : -1;
+    uint8_t detents = 0;
+    while (delta * direction >= steps) {
+        delta -= direction * steps;
+        detents++;
+    }
+    if (detents > 0) {
+        events.push({EncoderEvent::Rotation, direction, ButtonState::Open, now, now - lastDetentUsec, detents});
+        lastDetentUsec = now;
     }
 
     // gomb kezelése
-    if (pinBTN > 0                                         // csak akkor ellenőrizzük a gombot, ha megadtuk a lábát
-        && (now - lastButtonCheck) >= ENC_BUTTONINTERVAL)  // a gomb ellenőrzése elegendő 10-30ms-ként
+    if (pinBTN > 0                                                // csak akkor ellenőrizzük a gombot, ha megadtuk a lábát
+        && (now - lastButtonCheck) >= ENC_BUTTONINTERVAL * 1000)  // a gomb ellenőrzése elegendő 10-30ms-ként
     {
         lastButtonCheck = now;
 
-        if (digitalRead(pinBTN) == pinsActive) {  // a gomb le van nyomva
+        if (isPinActive(pinBTN)) {  // a gomb le van nyomva
             keyDownTicks++;
-            if (keyDownTicks > (ENC_HOLDTIME / ENC_BUTTONINTERVAL)) {
-                buttonState = ButtonState::Held;
+            if (keyDownTicks > (ENC_HOLDTIME / ENC_BUTTONINTERVAL) and buttonState != ButtonState::Held) {
+                setButtonState(ButtonState::Held, now);
             }
         }
 
-        if (digitalRead(pinBTN) == !pinsActive) {  // most engedték fel a gombot
+        if (!isPinActive(pinBTN)) {  // most engedték fel a gombot
             if (keyDownTicks /*> ENC_BUTTONINTERVAL*/) {
                 if (buttonState == ButtonState::Held) {
-                    buttonState = ButtonState::Released;
+                    setButtonState(ButtonState::Released, now);
                     doubleClickTicks = 0;
                 } else {
 #define ENC_SINGLECLICKONLY 1
                     if (doubleClickTicks > ENC_SINGLECLICKONLY) {  // megakadályozza az aktiválást egyszrű kattintás módban
                         if (doubleClickTicks < (ENC_DOUBLECLICKTIME / ENC_BUTTONINTERVAL)) {
-                            buttonState = ButtonState::DoubleClicked;
+                            setButtonState(ButtonState::DoubleClicked, now);
                             doubleClickTicks = 0;
                         }
                     } else {
@@ -161,84 +272,76 @@ void RotaryEncoder::service() {
         if (doubleClickTicks > 0) {
             doubleClickTicks--;
             if (--doubleClickTicks == 0) {
-                buttonState = ButtonState::Clicked;
+                setButtonState(ButtonState::Clicked, now);
             }
         }
     }
 }
 
 /**
- * Tekergetés értékének lekérése
+ * A sebességtől függő gyorsítási szorzó az aktuális görbéből (lineáris interpoláció a pontok között)
  */
-int16_t RotaryEncoder::getValue(void) {
-    int16_t val;
+uint16_t RotaryEncoder::accelerationFactor(uint16_t velocity) {
 
-    cli();
-    val = delta;
+    const AccelerationPoint *points = pAccelerationCurve->points;
+    uint8_t count = pAccelerationCurve->count;
 
-    if (steps == 2) {
-        delta = val & 1;
-    } else if (steps == 4) {
-        delta = val & 3;
-    } else {
-        delta = 0;  // alapértelmezés szerint 1 lépés minden beugró ponthoz
+    if (!accelerationEnabled or count == 0) {
+        return 1;
     }
-
-    sei();
-
-    if (steps == 4) val >>= 2;
-    if (steps == 2) val >>= 1;
-
-    int16_t r = 0;
-    int16_t accel = ((accelerationEnabled) ? (acceleration >> 8) : 0);
-
-    if (val < 0) {
-        r -= 1 + accel;
-    } else if (val > 0) {
-        r += 1 + accel;
+    if (velocity <= points[0].velocity) {
+        return points[0].factor;
     }
-    return r;
-}
 
-#ifndef WITHOUT_BUTTON
-/**
- * Gomb állapotának lekérése
- */
-RotaryEncoder::ButtonState RotaryEncoder::getButton(void) {
-    ButtonState ret = buttonState;
-    if (buttonState != ButtonState::Held) {
-        buttonState = ButtonState::Open;  // visszaállítás
+    for (uint8_t i = 1; i < count; i++) {
+        if (velocity < points[i].velocity) {
+            const AccelerationPoint &lo = points[i - 1];
+            const AccelerationPoint &hi = points[i];
+            return lo.factor + (int32_t)(velocity - lo.velocity) * (hi.factor - lo.factor) / (hi.velocity - lo.velocity);
+        }
     }
-    return ret;
+
+    return points[count - 1].factor;
 }
-#endif
 
 // ----------------------------------------------------------------------------
 //
-// Az enkóder állapotának lekérdezése
+// Az enkóder eseményeinek lekérdezése
 //
 RotaryEncoder::EncoderState RotaryEncoder::read() {
 
-    EncoderState result = {Direction::None, ButtonState::Open, 0};
+    EncoderState result = {Direction::None, ButtonState::Open, 0, 0, 0};
+    int32_t value = 0;  // Nagy szorzóknál az int16_t túlcsordulhatna
 
-    // Gomb állapotának lekérdezése
-    result.buttonState = getButton();
+    EncoderEvent event;
+    while (events.peek(event)) {
 
-    // Forgás detektálása, csak akkor figyeljük a forgást, ha a gomb nincs lenyomva/tartva
-    if (result.buttonState != ButtonState::Held) {
-
-        // Olvassuk ki a lépés értékét (ez már tartalmazhatja a gyorsítást)
-        int16_t currentStep = getValue();
-
-        // Ha volt elmozdulás (getValue() nem 0-t adott vissza)
-        if (currentStep != 0) {
+        if (event.type == EncoderEvent::Button) {
+            // A gomb eseményt a korábbi forgatástól külön adjuk vissza
+            if (result.detents == 0) {
+                events.pop(event);
+                result.buttonState = event.buttonState;
+            }
+            break;
+        }
+        events.pop(event);
+
+        // Sebesség a két lépés közötti időből (az első lépésnél / hosszú szünet után 0)
+        // Az egy hívás alatt összegyűlt lépések között az eltelt időt egyenlően osztjuk szét, különben végtelen sebességet kapnának
+        uint32_t interval = event.intervalUsec / event.detents;
+        uint16_t velocity = interval > 0 and interval < 1000000 ? 1000000 / interval : 0;
+        if (velocity > result.velocity) {
+            result.velocity = velocity;
+        }
 
-            // Irány meghatározása a currentStep előjele alapján
-            result.direction = (currentStep > 0) ? Direction::Up : Direction::Down;
+        result.detents += event.direction * event.detents;
+        value += event.direction * event.detents * accelerationFactor(velocity);
+    }
+    result.value = constrain(value, INT16_MIN, INT16_MAX);
 
-            // Az aktuális értéket ELŐJELHELYESEN adjuk vissza
-            result.value = currentStep;
-        }
+    // Irány meghatározása az érték előjele alapján
+    if (result.value != 0) {
+        result.direction = (result.value > 0) ? Direction::Up : Direction::Down;
     }
 
     return result;
@@ -10,15 +10,21 @@
  */
 
 #include <Arduino.h>
+#include <hardware/structs/sio.h>
+#include <hardware/timer.h>
+
+#include "SpscQueue.h"
 
 #define ROTARY_ENCODER_STEPS_PER_NOTCH 2  // Impulzusok száma egy lépéshez, Rotary függő ezt ki kell kísérletezni!!
 
 #define ROTARY_ENCODER_RECOMMENDED_SERVICE_INTERVAL_MSEC 1  // A javasolt service() hívás periódus idő = 1msec
+#define ROTARY_ENCODER_EVENT_QUEUE_SIZE 32                   // A service() és a read() közötti esemény sor mérete (2 hatványa)
 
 // ----------------------------------------------------------------------------
 
 #define ENC_NORMAL (1 << 1)  // use Peter Danneger's decoder
 #define ENC_FLAKY (1 << 2)   // use Table-based decoder
+#define ENC_PIO (1 << 3)     // RP2040 PIO állapotgép dekódol és számol, a megszakítás csak kiolvassa (az A/B lábak egymás mellett legyenek!)
 
 // ----------------------------------------------------------------------------
 
@@ -26,6 +32,10 @@
 #define ENC_DECODER ENC_NORMAL
 #endif
 
+#if ENC_DECODER == ENC_PIO
+#include <hardware/pio.h>
+#endif
+
 #if ENC_DECODER == ENC_FLAKY
 #ifndef ENC_HALFSTEP
 #define ENC_HALFSTEP 1  // use table for half step per default
@@ -55,36 +65,112 @@ class RotaryEncoder {
     struct EncoderState {
         Direction direction;
         ButtonState buttonState;
-        int16_t value;  // aktuális érték
+        int16_t value;      // aktuális érték (gyorsítással)
+        int16_t detents;    // a megtett lépések száma (gyorsítás nélkül)
+        uint16_t velocity;  // a forgatás sebessége (lépés/sec, a két lépés közötti időből)
     };
 
+    // Az ISR által a sorba tett esemény
+    struct EncoderEvent {
+        enum Type : uint8_t { Rotation, Button };
+        Type type;
+        int8_t direction;         // Rotation: +1 / -1
+        ButtonState buttonState;  // Button: az új állapot
+        uint32_t timeUsec;        // Az esemény ideje (timer usec)
+        uint32_t intervalUsec;    // Rotation: az előző esemény lépése óta eltelt idő (a detents lépésre együtt)
+        uint8_t detents;          // Rotation: az egy service() hívás alatt összegyűlt lépések száma
+    };
+
+    // A gyorsítási görbe egy pontja: ekkora sebességnél (lépés/sec) ennyi a szorzó
+    struct AccelerationPoint {
+        uint16_t velocity;
+        uint16_t factor;
+    };
+
+    // Szakaszonként lineáris gyorsítási görbe (a pontok sebesség szerint növekvő sorrendben)
+    // Az első pont alatt az első, az utolsó felett az utolsó pont szorzója érvényes
+    struct AccelerationCurve {
+        const AccelerationPoint *points;
+        uint8_t count;
+    };
+
+    // Az alapértelmezett görbe (ha a fogyasztó nem ad meg sajátot)
+    static const AccelerationCurve DEFAULT_ACCELERATION_CURVE;
+
    private:
     const uint8_t pinA;
     const uint8_t pinB;
     const uint8_t pinBTN;
     const bool pinsActive;
-    volatile int16_t delta;
+    volatile int16_t delta;  // A még egész lépéssé nem állt impulzusok
     volatile int16_t last;
     uint8_t steps;
-    volatile uint16_t acceleration;
     bool accelerationEnabled;
-#if ENC_DECODER != ENC_NORMAL
-    static const int8_t table[16];
+    const AccelerationCurve *pAccelerationCurve;  // A read() által használt görbe
+
+    SpscQueue<EncoderEvent, ROTARY_ENCODER_EVENT_QUEUE_SIZE> events;  // service() -> read()
+    uint32_t lastDetentUsec = 0;                                      // Az utolsó lépés ideje (a sebességhez)
+#if ENC_DECODER == ENC_FLAKY
+    static int8_t table[16];  // RAM-ban (nem const, így nem a flash .rodata-ba kerül): a service() a flash írás alatt is olvassa
+#endif
+#if ENC_DECODER == ENC_PIO
+    PIO pio;                    // A dekóder PIO blokkja
+    uint sm;                    // A dekóder állapotgépe
+    bool pioReversed;           // A lábak sorrendje miatt fordított a számlálás iránya
+    uint32_t pioLastCount = 0;  // A számláló legutóbb kiolvasott értéke
+    bool pioReady = false;      // Fut a PIO dekóder? (ha nem indult el, a service() a lábakat olvassa, ENC_NORMAL)
+
+    /**
+     * A PIO dekóder indítása
+     * @return false, ha nem indítható (a lábak nincsenek egymás mellett, nincs szabad programhely vagy állapotgép)
+     */
+    bool pioBegin();
 #endif
-    volatile ButtonState buttonState;
+    ButtonState buttonState;
     bool doubleClickEnabled;
     uint16_t keyDownTicks = 0;
     uint8_t doubleClickTicks = 0;
-    unsigned long lastButtonCheck = 0;
+    uint32_t lastButtonCheck = 0;  // usec
 
     /**
-     * Tekergetés állapot lekérdezése
+     * A láb aktív? (közvetlenül a SIO regiszterből, a service() RAM-ból fut, a flash-ben lévő digitalRead() nem használható)
      */
-    int16_t getValue(void);
+    __force_inline bool isPinActive(uint8_t pin) { return ((sio_hw->gpio_in >> pin) & 1) == pinsActive; }
+
     /**
-     * Gomb állapot lekérdezése
+     * Peter Danneger dekódere: a lábak aktuális állapotából a lépés (ENC_NORMAL, és az ENC_PIO tartaléka)
      */
-    ButtonState getButton(void);
+    __force_inline void decodePins() {
+        int8_t curr = 0;
+
+        if (isPinActive(pinA)) {
+            curr = 3;
+        }
+
+        if (isPinActive(pinB)) {
+            curr ^= 1;
+        }
+
+        int8_t diff = last - curr;
+
+        if (diff & 1) {  // 0. bit = lépés
+            last = curr;
+            delta += (diff & 2) - 1;  // 1. bit = irány (+/-)
+        }
+    }
+
+    /**
+     * Gomb állapot váltás és az esemény sorba tétele (a service()-ből)
+     */
+    __force_inline void setButtonState(ButtonState state, uint32_t now) {
+        buttonState = state;
+        events.push({EncoderEvent::Button, 0, state, now, 0, 0});
+    }
+
+    /**
+     * A sebességtől függő gyorsítási szorzó az aktuális görbéből
+     */
+    uint16_t accelerationFactor(uint16_t velocity);
 
    public:
     /**
@@ -94,21 +180,23 @@ class RotaryEncoder {
 
     /**
      * Ezt a függvényt hívja meg a megszakítás vagy az időzítő rutin
+     * RAM-ból fut, így a flash írás alatt is hívható (EncoderTimer)
      */
     void service();
 
     /**
      * Gyorsulás engedélyezése/letiltása
      */
-    void setAccelerationEnabled(const bool &enabled) {
-        accelerationEnabled = enabled;
-        if (accelerationEnabled == false) {
-            acceleration = 0;
-        }
-    }
+    void setAccelerationEnabled(const bool &enabled) { accelerationEnabled = enabled; }
 
     const bool getAccelerationEnabled() { return accelerationEnabled; }
 
+    /**
+     * A gyorsítási görbe kiválasztása (a read() előtt, az aktuális fogyasztónak megfelelően)
+     * A görbének a használat alatt élnie kell (statikus/constexpr tömb)
+     */
+    void setAccelerationCurve(const AccelerationCurve &curve) { pAccelerationCurve = &curve; }
+
     /**
      * Dupla kattintás engedélyezése/letiltása
      */
@@ -117,9 +205,21 @@ class RotaryEncoder {
     const bool getDoubleClickEnabled() { return doubleClickEnabled; }
 
     /**
-     * Az enkóder jelenlegi állapotának lekérdezése
+     * A következő esemény(ek) lekérdezése a sorból
+     * Az egymás utáni forgatás eseményeket összevonjuk, a gomb eseményeket egyenként adjuk vissza (nem olvadnak össze).
+     * A hívó a hasPendingEvents()-ig hívja, hogy minden esemény feldolgozásra kerüljön.
      */
     EncoderState read();
+
+    /**
+     * Van még feldolgozatlan esemény?
+     */
+    inline bool hasPendingEvents() const { return !events.isEmpty(); }
+
+    /**
+     * A tele sor miatt elveszett események száma
+     */
+    inline uint16_t getLostEventCount() const { return events.getOverflowCount(); }
 };
 
 #endif  // ROTARYENCODER_H
@@ -1,5 +1,6 @@
 #include "SetupDisplay.h"
 
+#include "I2cTrace.h"
 #include "MultiButtonDialog.h"
 #include "ValueChangeDialog.h"
 
@@ -11,6 +12,9 @@ SetupDisplay::SetupDisplay(TFT_eSPI &tft, SI4735 &si4735, Band &band) : DisplayB
     // Horizontális képernyőgombok definiálása
     DisplayBase::BuildButtonData horizontalButtonsData[] = {
         {"Bright", TftButton::ButtonType::Pushable},                             //
+        {"AF Thr", TftButton::ButtonType::Pushable},                             //
+        {"AF Gap", TftButton::ButtonType::Pushable},                             //
+        {"Prio T", TftButton::ButtonType::Pushable},                             //
         {"Exit", TftButton::ButtonType::Pushable, TftButton::ButtonState::Off},  //
     };
 
@@ -39,6 +43,35 @@ void SetupDisplay::drawScreen() {
     tft.setTextDatum(MC_DATUM);  // Középre igazítás
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
     tft.drawString("Setup display", tft.width() / 2, tft.height() / 2);
+
+    // I2C forgalom képernyőnként (az indulás óta)
+    drawI2cTraceStats();
+}
+
+/**
+ * Az I2C forgalom statisztika kirajzolása képernyőnként
+ */
+void SetupDisplay::drawI2cTraceStats() {
+
+    tft.setTextSize(1);
+    tft.setTextDatum(TL_DATUM);
+    tft.setTextColor(TFT_SILVER, TFT_BLACK);
+
+    uint16_t lineHeight = tft.fontHeight();
+    uint16_t y = tft.height() / 2 + 2 * lineHeight;
+    tft.drawString("I2C bus (tx / bytes / time / peak burst)", 10, y);
+
+    char buffer[64];
+    for (uint8_t i = 0; i < I2C_TRACE_SCREEN_COUNT; i++) {
+        const I2cTraceStats &stats = I2cTrace::getScreenStats(i);
+        if (stats.count == 0) {
+            continue;
+        }
+        y += lineHeight;
+        snprintf(buffer, sizeof(buffer), "%-12s %6lu %7lu %6lums %5luus", I2cTrace::getScreenName(i) ? I2cTrace::getScreenName(i) : "?", stats.count, stats.bytes,
+                 stats.totalUsec / 1000, stats.peakBurstUsec);
+        tft.drawString(buffer, 10, y);
+    }
 }
 
 /**
@@ -55,6 +88,18 @@ void SetupDisplay::processScreenButtonTouchEvent(TftButton::ButtonTouchEvent &ev
             new ValueChangeDialog(this, DisplayBase::tft, 270, 150, F("TFT Brightness"), F("Value:"),                                                                         //
                                   &config.data.tftBackgroundBrightness, (uint8_t)TFT_BACKGROUND_LED_MIN_BRIGHTNESS, (uint8_t)TFT_BACKGROUND_LED_MAX_BRIGHTNESS, (uint8_t)10,  //
                                   [this](uint8_t newBrightness) { analogWrite(PIN_TFT_BACKGROUND_LED, newBrightness); });
+    } else if (STREQ("AF Thr", event.label)) {
+        // Ez alatti RSSI esetén keresünk jobb AF-et, 0 -> kikapcsolva
+        DisplayBase::pDialog = new ValueChangeDialog(this, DisplayBase::tft, 270, 150, F("RDS AF RSSI threshold"), F("dBuV (0=off):"),  //
+                                                     &config.data.rdsAfRssiThreshold, (uint8_t)0, (uint8_t)60, (uint8_t)1);
+    } else if (STREQ("AF Gap", event.label)) {
+        // Az AF ellenőrzés alatti hangkimaradás felső korlátja
+        DisplayBase::pDialog = new ValueChangeDialog(this, DisplayBase::tft, 270, 150, F("RDS AF max audio gap"), F("msec:"),  //
+                                                     &config.data.rdsAfMaxGapMsec, 50, 500, 10);
+    } else if (STREQ("Prio T", event.label)) {
+        // A memória szkennelés alatt ilyen gyakran nézzük meg a prioritásos csatornát, 0 -> kikapcsolva
+        DisplayBase::pDialog = new ValueChangeDialog(this, DisplayBase::tft, 270, 150, F("Priority channel check"), F("sec (0=off):"),  //
+                                                     &config.data.memScanPrioritySec, (uint8_t)0, (uint8_t)60, (uint8_t)1);
     }
 }
 
@@ -8,6 +8,11 @@ class SetupDisplay : public DisplayBase {
    private:
     DisplayBase::DisplayType prevDisplay = DisplayBase::DisplayType::none;
 
+    /**
+     * Az I2C forgalom statisztika kirajzolása képernyőnként
+     */
+    void drawI2cTraceStats();
+
    protected:
     /**
      * Rotary encoder esemény lekezelése
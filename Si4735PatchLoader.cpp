@@ -0,0 +1,110 @@
+#include "Si4735PatchLoader.h"
+
+#include "I2cTrace.h"
+#include "utils.h"
+
+#define SI4735_STATUS_CTS 0x80  // Clear To Send
+#define SI4735_STATUS_ERR 0x40  // Parancs hiba
+
+// A kipróbált I2C sebességek, a leggyorsabbtól
+static const uint32_t PATCH_I2C_CLOCKS[] = {1000000, 800000, 600000, 400000, SI4735_I2C_STANDARD_CLOCK};
+
+/**
+ * Várakozás a CTS-re (szoros pollozás, nincs fix várakozás)
+ */
+bool Si4735PatchLoader::waitCts() {
+
+    uint32_t start = micros();
+    while (true) {
+        if (wire.requestFrom(address, (uint8_t)1) != 1) {
+            return false;  // NACK
+        }
+        uint8_t status = wire.read();
+
+        if (status & SI4735_STATUS_CTS) {
+            return !(status & SI4735_STATUS_ERR);
+        }
+
+        if (micros() - start > SI4735_CTS_TIMEOUT_USEC) {
+            return false;
+        }
+    }
+}
+
+/**
+ * A busz ellenőrzése az aktuális sebességen
+ * A patchPowerUp után a chip tétlen, minden olvasásnak CTS-t és hibamentes státuszt kell adnia
+ */
+bool Si4735PatchLoader::probeBus() {
+    for (uint8_t i = 0; i < SI4735_BUS_PROBE_READS; i++) {
+        I2cTrace::Scope trace(I2C_TRACE_CMD_STATUS_READ, I2C_TRACE_BYTES_STATUS_READ);
+        if (!waitCts()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * A patch letöltése az aktuális sebességen
+ */
+bool Si4735PatchLoader::downloadAtCurrentClock(const uint8_t *patch, uint16_t size) {
+
+    for (uint16_t offset = 0; offset + SI4735_PATCH_LINE_SIZE <= size; offset += SI4735_PATCH_LINE_SIZE) {
+
+        // Egy sor a feldolgozásával együtt (a sor első bájtja a parancs: PATCH_ARGS vagy PATCH_DATA)
+        I2cTrace::Scope trace(patch[offset], I2C_TRACE_BYTES_PATCH_LINE);
+
+        wire.beginTransmission(address);
+        wire.write(patch + offset, SI4735_PATCH_LINE_SIZE);
+        if (wire.endTransmission() != 0) {
+            DEBUG("Si4735PatchLoader -> NACK at offset %d\n", offset);
+            return false;
+        }
+
+        // A sor feldolgozása (és annak ERR bitje)
+        if (!waitCts()) {
+            DEBUG("Si4735PatchLoader -> CTS/ERR at offset %d\n", offset);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * A patch letöltése a leggyorsabb megbízható sebességgel
+ */
+bool Si4735PatchLoader::download(const uint8_t *patch, uint16_t size, std::function<void()> restartChip) {
+
+    bool success = false;
+
+    for (uint8_t i = 0; i < ARRAY_ITEM_COUNT(PATCH_I2C_CLOCKS) and !success; i++) {
+
+        // Az első próbálkozás előtt a hívó már előkészítette a chipet
+        if (i > 0) {
+            wire.setClock(SI4735_I2C_STANDARD_CLOCK);
+            restartChip();
+        }
+
+        wire.setClock(PATCH_I2C_CLOCKS[i]);
+        if (!probeBus()) {
+            DEBUG("Si4735PatchLoader -> bus probe failed at %d kHz\n", PATCH_I2C_CLOCKS[i] / 1000);
+            continue;
+        }
+
+        uint32_t start = millis();
+        success = downloadAtCurrentClock(patch, size);
+
+        if (success) {
+            lastClock = PATCH_I2C_CLOCKS[i];
+            lastDownloadMsec = millis() - start;
+            DEBUG("Si4735PatchLoader -> %d bytes downloaded at %d kHz in %d msec\n", size, lastClock / 1000, lastDownloadMsec);
+        } else {
+            DEBUG("Si4735PatchLoader -> download failed at %d kHz, falling back\n", PATCH_I2C_CLOCKS[i] / 1000);
+        }
+    }
+
+    wire.setClock(SI4735_I2C_STANDARD_CLOCK);
+    return success;
+}
@@ -0,0 +1,71 @@
+#ifndef __SI4735PATCHLOADER_H
+#define __SI4735PATCHLOADER_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include <functional>
+
+#define SI4735_PATCH_LINE_SIZE 8          // A patch soronként 8 bájtos parancsokból áll
+#define SI4735_CTS_TIMEOUT_USEC 20000     // Ennyi ideig várunk a CTS-re egy patch sor után
+#define SI4735_BUS_PROBE_READS 16         // Ennyi státusz olvasásnak kell hibátlannak lennie egy sebességen
+#define SI4735_I2C_STANDARD_CLOCK 100000  // A letöltés után erre állunk vissza (mint a setI2CStandardMode())
+
+/**
+ * Gyors SSB patch letöltő
+ *
+ * A library downloadPatch()-e minden 8 bájtos sor után fix 300usec-et vár, és csak 400kHz-en megy.
+ * Itt a sorokat közvetlenül a flash-ből küldjük, a CTS-t szorosan pollozzuk, és a legnagyobb megbízható I2C sebességgel töltünk.
+ * Minden sebességen előbb ellenőrizzük a buszt, letöltés közben pedig soronként a NACK-ot, a CTS-t és a chip ERR bitjét.
+ * Az ERR csak a parancs szintű hibát jelzi: a patch tartalmát (ellenőrző összeg híján) sem a chip, sem mi nem ellenőrizzük,
+ * egy átvitel közben sérült, de elfogadott sor tehát nem derül ki.
+ * Hiba (NACK, ERR, CTS timeout) esetén a chipet újraindítjuk, és a következő, lassabb sebességgel próbáljuk újra.
+ */
+class Si4735PatchLoader {
+
+   private:
+    TwoWire &wire;
+    uint8_t address;
+
+    uint32_t lastClock = 0;         // A sikeres letöltés I2C sebessége [Hz]
+    uint32_t lastDownloadMsec = 0;  // A sikeres letöltés ideje
+
+    /**
+     * Várakozás a CTS-re
+     * @return false, ha timeout, NACK vagy ERR volt
+     */
+    bool waitCts();
+
+    /**
+     * A busz ellenőrzése az aktuális sebességen (ismételt státusz olvasás)
+     */
+    bool probeBus();
+
+    /**
+     * A patch letöltése az aktuális sebességen
+     */
+    bool downloadAtCurrentClock(const uint8_t *patch, uint16_t size);
+
+   public:
+    /**
+     * Konstruktor
+     * @param wire az I2C busz
+     * @param address az SI4735 I2C címe
+     */
+    Si4735PatchLoader(TwoWire &wire, uint8_t address) : wire(wire), address(address) {}
+
+    /**
+     * A patch letöltése a leggyorsabb megbízható sebességgel
+     *
+     * @param patch a patch tartalma (flash-ben)
+     * @param size a patch mérete
+     * @param restartChip a chip újraindítása patch fogadására (reset + patchPowerUp), sikertelen próbálkozás után hívjuk
+     * @return true, ha sikerült
+     */
+    bool download(const uint8_t *patch, uint16_t size, std::function<void()> restartChip);
+
+    inline uint32_t getLastClock() const { return lastClock; }
+    inline uint32_t getLastDownloadMsec() const { return lastDownloadMsec; }
+};
+
+#endif  //__SI4735PATCHLOADER_H
@@ -0,0 +1,275 @@
+#include "Si4735State.h"
+
+#include "I2cTrace.h"
+#include "utils.h"
+
+/**
+ * A kívánt állapot kiküldése, csak a különbségek
+ * @return true, ha mód beállítás (setFM/setAM/setSSB) is történt
+ */
+bool Si4735State::apply(const Si4735Settings &desired) {
+
+    uint32_t startMicros = micros();
+    commandsSent = 0;
+    bool tuneNeeded = false;
+
+    // Mód váltás kell? (A sávhatárokat csak a mód beállító hívások állítják)
+    bool modeChange = !modeValid or desired.mode != applied.mode or desired.minFreq != applied.minFreq or desired.maxFreq != applied.maxFreq or
+                      ((desired.mode == ChipMode::Ssb) and desired.sideband != applied.sideband);
+
+    // Az antenna kapacitást a library csak megjegyzi, a következő hangoló paranccsal megy ki -> a hangolás előtt kell beállítani
+    setAntennaCapacitor(desired.antCap);
+
+    if (modeChange) {
+        I2cTrace::Scope trace(POWER_UP, I2C_TRACE_BYTES_POWER_UP);
+        switch (desired.mode) {
+            case ChipMode::Fm:
+                si4735.setFM(desired.minFreq, desired.maxFreq, desired.freq, desired.step);
+                break;
+
+            case ChipMode::Am:
+                si4735.setAM(desired.minFreq, desired.maxFreq, desired.freq, desired.step);
+                break;
+
+            case ChipMode::Ssb:
+                si4735.setSSB(desired.minFreq, desired.maxFreq, desired.freq, desired.step, desired.sideband);
+                break;
+
+            case ChipMode::SyncAm:
+                si4735.setSSB(desired.minFreq, desired.maxFreq, desired.freq, desired.step, USB);
+                break;
+
+            default:
+                break;
+        }
+        commandsSent++;
+
+        // A bekapcsolás után a property-k alapértékre állhattak
+        invalidateProperties();
+
+    } else {
+        // A frekvenciát más is állíthatja közvetlenül (pl. RDS AF, szkenner) -> a library által utoljára beállítottal hasonlítunk
+        tuneNeeded = desired.freq != si4735.getCurrentFrequency();
+        if (desired.step != applied.step) {
+            si4735.setFrequencyStep(desired.step);
+            commandsSent++;
+        }
+        if (tuneNeeded) {
+            // A library fix várakozása helyett a végén az STC-t pollozzuk (waitTuneComplete())
+            I2cTrace::Scope trace(desired.mode == ChipMode::Fm ? FM_TUNE_FREQ : AM_TUNE_FREQ, I2C_TRACE_BYTES_TUNE);
+            si4735.setMaxDelaySetFrequency(0);
+            si4735.setFrequency(desired.freq);
+            si4735.setMaxDelaySetFrequency(MAX_DELAY_AFTER_SET_FREQUENCY);
+            commandsSent++;
+        }
+    }
+
+    // Sávszélesség
+    bool ssbFamily = desired.mode == ChipMode::Ssb or desired.mode == ChipMode::SyncAm;
+    if (!propsValid or desired.bandwidth != applied.bandwidth or (ssbFamily and desired.mode != applied.mode)) {
+        I2cTrace::Scope trace(SET_PROPERTY, I2C_TRACE_BYTES_SET_PROPERTY);
+        switch (desired.mode) {
+            case ChipMode::Fm:
+                si4735.setFmBandwidth(desired.bandwidth);
+                break;
+
+            case ChipMode::Am:
+                si4735.setBandwidth(desired.bandwidth, 0);
+                break;
+
+            case ChipMode::Ssb:
+                // AUDIOBW, SBCUTFLT (2kHz alatt sáváteresztő), AVC_DIVIDER = 0, AVCEN, SMUTESEL, DSP_AFCDIS = 1 -> SSB mód
+                si4735.setSSBConfig(desired.bandwidth, (desired.bandwidth == 0 or desired.bandwidth == 4 or desired.bandwidth == 5) ? 0 : 1, 0, 1, 0, 1);
+                break;
+
+            case ChipMode::SyncAm:
+                // AVC_DIVIDER = 3, DSP_AFCDIS = 0 -> SYNC mód
+                si4735.setSSBConfig(desired.bandwidth, 1, 3, 1, 0, 0);
+                break;
+
+            default:
+                break;
+        }
+        commandsSent++;
+    }
+
+    // AGC, BFO, hangerő: a property cache-en keresztül
+    uint32_t writesBefore = writesSent;
+    setAutomaticGainControl(desired.agcDisabled, desired.agcIndex);
+    if (ssbFamily) {
+        setSSBBfo(desired.bfo);
+    }
+    setVolume(desired.volume);
+    commandsSent += writesSent - writesBefore;
+
+    // Ha hangoltunk, megvárjuk a végét
+    if (modeChange or tuneNeeded) {
+        tuneStartMsec = millis();
+        waitTuneComplete();
+    }
+
+    applied = desired;
+    modeValid = propsValid = true;
+
+    // Mérés
+    uint32_t elapsed = micros() - startMicros;
+    applyCount++;
+    totalApplyMicros += elapsed;
+    if (elapsed > maxApplyMicros) {
+        maxApplyMicros = elapsed;
+    }
+    applyCommands += commandsSent;
+    if (modeChange) {
+        applyModeChanges++;
+    }
+
+    return modeChange;
+}
+
+/**
+ * Várakozás a hangolás befejezésére (STC), majd az STC nyugtázása
+ */
+bool Si4735State::waitTuneComplete(uint16_t timeoutMsec) {
+
+    uint32_t start = millis();
+    while (millis() - start < timeoutMsec) {
+        if (pollTuneComplete()) {
+            return true;
+        }
+    }
+
+    DEBUG("Si4735State::waitTuneComplete() -> timeout\n");
+    tuneInProgress = false;
+    return false;
+}
+
+/**
+ * Hangolás indítása várakozás nélkül (a végét a pollTuneComplete()-el kell figyelni)
+ */
+void Si4735State::beginTune(uint16_t freq) {
+
+    // A library setFrequency() a parancs után fix ideig vár, ezt most kikapcsoljuk
+    // (a többi hívó, pl. a szkenner, a várakozás után rögtön mér, nekik visszaállítjuk)
+    I2cTrace::Scope trace(applied.mode == ChipMode::Fm ? FM_TUNE_FREQ : AM_TUNE_FREQ, I2C_TRACE_BYTES_TUNE);
+    si4735.setMaxDelaySetFrequency(0);
+    si4735.setFrequency(freq);
+    si4735.setMaxDelaySetFrequency(MAX_DELAY_AFTER_SET_FREQUENCY);
+
+    applied.freq = freq;
+    tuneInProgress = true;
+    tuneStartMsec = millis();
+}
+
+/**
+ * Befejeződött a hangolás? (Ha igen, az STC-t nyugtázzuk)
+ */
+bool Si4735State::pollTuneComplete() {
+
+    {
+        I2cTrace::Scope trace(GET_INT_STATUS, I2C_TRACE_BYTES_STATUS);
+        si4735.getInterruptStatus();
+    }
+    if (si4735.getTuneCompleteTriggered()) {
+        I2cTrace::Scope trace(applied.mode == ChipMode::Fm ? FM_TUNE_STATUS : AM_TUNE_STATUS, I2C_TRACE_BYTES_TUNE_STATUS);
+        si4735.getStatus(1, 0);  // INTACK -> STC törlése
+        tuneInProgress = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Kell-e írni? (A statisztikát is vezeti)
+ */
+bool Si4735State::needsWrite(bool valid, bool same) {
+    if (valid and same) {
+        writesSkipped++;
+        return false;
+    }
+    writesSent++;
+    return true;
+}
+
+/**
+ * Hangerő beállítása (csak ha változott)
+ */
+void Si4735State::setVolume(uint8_t volume) {
+    if (needsWrite(volumeValid, volume == applied.volume)) {
+        I2cTrace::Scope trace(SET_PROPERTY, I2C_TRACE_BYTES_SET_PROPERTY);
+        si4735.setVolume(volume);
+        applied.volume = volume;
+        volumeValid = true;
+    }
+}
+
+/**
+ * AGC beállítása (csak ha változott)
+ */
+void Si4735State::setAutomaticGainControl(uint8_t agcDisabled, uint8_t agcIndex) {
+    if (needsWrite(agcValid, agcDisabled == applied.agcDisabled and agcIndex == applied.agcIndex)) {
+        I2cTrace::Scope trace(applied.mode == ChipMode::Fm ? FM_AGC_OVERRIDE : AM_AGC_OVERRIDE, I2C_TRACE_BYTES_AGC_OVERRIDE);
+        si4735.setAutomaticGainControl(agcDisabled, agcIndex);
+        applied.agcDisabled = agcDisabled;
+        applied.agcIndex = agcIndex;
+        agcValid = true;
+    }
+}
+
+/**
+ * Az AGC engedélyezett? (Érvényes cache esetén nincs I2C olvasás)
+ */
+bool Si4735State::isAgcEnabled() {
+    if (agcValid) {
+        readsCached++;
+    } else {
+        // Nem tudjuk, mi van a chipen -> visszaolvassuk
+        I2cTrace::Scope trace(applied.mode == ChipMode::Fm ? FM_AGC_STATUS : AM_AGC_STATUS, I2C_TRACE_BYTES_AGC_STATUS);
+        si4735.getAutomaticGainControl();
+        applied.agcDisabled = si4735.isAgcEnabled() ? 0 : 1;
+        applied.agcIndex = si4735.getAgcGainIndex();
+        agcValid = true;
+        readsSent++;
+    }
+    return applied.agcDisabled == 0;
+}
+
+/**
+ * Antenna kapacitás beállítása (csak ha változott, a következő hangolással megy ki a chipre)
+ */
+void Si4735State::setAntennaCapacitor(uint16_t antCap) {
+    if (needsWrite(antCapValid, antCap == applied.antCap)) {
+        si4735.setTuneFrequencyAntennaCapacitor(antCap);
+        applied.antCap = antCap;
+        antCapValid = true;
+    }
+}
+
+/**
+ * SSB BFO beállítása (csak ha változott)
+ */
+void Si4735State::setSSBBfo(int16_t bfo) {
+    if (needsWrite(bfoValid, bfo == applied.bfo)) {
+        I2cTrace::Scope trace(SET_PROPERTY, I2C_TRACE_BYTES_SET_PROPERTY);
+        si4735.setSSBBfo(bfo);
+        applied.bfo = bfo;
+        bfoValid = true;
+    }
+}
+
+/**
+ * A property cache I2C forgalom és az apply() mérések kiírása
+ */
+void Si4735State::reportStats() {
+    uint32_t writes = writesSent + writesSkipped;
+    uint32_t reads = readsSent + readsCached;
+    DEBUG("Si4735State -> writes: %d sent, %d skipped (%d%%), reads: %d sent, %d cached (%d%%)\n", writesSent, writesSkipped, writes ? writesSkipped * 100 / writes : 0, readsSent,
+          readsCached, reads ? readsCached * 100 / reads : 0);
+
+    // Az apply() mérések az utolsó kiírás óta (hívásonként nem írunk ki semmit)
+    if (applyCount > 0) {
+        DEBUG("Si4735State -> apply: %d calls (%d mode changes), %d commands, avg: %d usec, max: %d usec\n", applyCount, applyModeChanges, applyCommands,
+              totalApplyMicros / applyCount, maxApplyMicros);
+    }
+    applyCount = applyModeChanges = applyCommands = 0;
+    totalApplyMicros = maxApplyMicros = 0;
+}
@@ -0,0 +1,181 @@
+#ifndef __SI4735STATE_H
+#define __SI4735STATE_H
+
+#include <SI4735.h>
+
+#define SI4735_STC_TIMEOUT_MSEC 250       // Ennyi ideig várunk a hangolás befejezésére (STC)
+#define SI4735_STATS_INTERVAL_MSEC 60000  // Az I2C forgalom statisztika kiírásának gyakorisága (__DEBUG)
+
+/**
+ * A chip üzemmódja
+ * (A SyncAm a patch-elt firmware szinkron AM módja)
+ */
+enum class ChipMode : uint8_t { None, Fm, Am, Ssb, SyncAm };
+
+/**
+ * Az SI4735 kívánt (vagy utoljára kiküldött) állapota
+ */
+struct Si4735Settings {
+    ChipMode mode;
+    uint16_t minFreq;  // A sáv határai
+    uint16_t maxFreq;
+    uint16_t freq;      // Frekvencia
+    uint8_t step;       // Lépésköz
+    uint8_t sideband;   // SSB oldalsáv (LSB/USB)
+    uint8_t bandwidth;  // Sávszélesség index (FM: FM_CHANNEL_FILTER, AM: AMCHFLT, SSB/SyncAm: AUDIOBW)
+    uint8_t agcDisabled;
+    uint8_t agcIndex;
+    uint16_t antCap;  // Antenna Tuning Capacitor
+    int16_t bfo;      // SSB BFO [Hz]
+    uint8_t volume;
+};
+
+/**
+ * Az SI4735 állapotának nyilvántartása és a különbségek kiküldése
+ *
+ * Band/mód váltáskor csak azt küldjük ki a chipnek, ami eltér az utoljára kiküldött állapottól.
+ * A setFM()/setAM()/setSSB() (bekapcsolással járó) hívás csak mód- vagy sávhatár váltáskor kell,
+ * utána a chip property-jei alapértékre állhatnak, ezért azokat újra kiküldjük.
+ * A fix várakozások helyett a hangolás végét (STC) figyeljük.
+ *
+ * Az egyes property-k (hangerő, AGC, antenna kapacitás, BFO) írása is ezen keresztül megy (write-through cache):
+ * az utoljára kiírt értékkel azonos írást nem küldjük ki, az AGC állapot lekérdezését a cache-ből válaszoljuk meg.
+ */
+class Si4735State {
+
+   private:
+    SI4735 &si4735;
+
+    Si4735Settings applied = {};  // Az utoljára kiküldött állapot
+    bool modeValid = false;       // A mód, sávhatárok, frekvencia, lépésköz érvényes?
+    bool propsValid = false;      // A sávszélesség érvényes?
+
+    bool tuneInProgress = false;  // beginTune() volt, az STC még nem jött meg
+    uint32_t tuneStartMsec = 0;   // Az utolsó hangolás indítása (az apply() hangolása is)
+
+    // A cache-elt property-k érvényessége (a chip bekapcsolása alapértékre állítja őket)
+    bool volumeValid = false;
+    bool agcValid = false;
+    bool antCapValid = false;
+    bool bfoValid = false;
+
+    // Mérés (a legutóbbi reportStats() óta)
+    uint32_t applyCount = 0;
+    uint32_t applyModeChanges = 0;  // Ennyi apply() járt mód váltással
+    uint32_t applyCommands = 0;     // Az apply()-ok által kiküldött beállítások összesen
+    uint32_t totalApplyMicros = 0;
+    uint32_t maxApplyMicros = 0;
+    uint16_t commandsSent = 0;  // Az utolsó apply() által kiküldött beállítások száma
+
+    // Property cache statisztika (a bekapcsolás óta)
+    uint32_t writesSent = 0;     // Kiküldött property írások
+    uint32_t writesSkipped = 0;  // Kihagyott (azonos értékű) property írások
+    uint32_t readsCached = 0;    // A cache-ből megválaszolt lekérdezések
+    uint32_t readsSent = 0;      // A chipről olvasott lekérdezések
+
+    /**
+     * A chip bekapcsolásakor alapértékre álló property-k eldobása
+     */
+    inline void invalidateProperties() { propsValid = volumeValid = agcValid = bfoValid = false; }
+
+    /**
+     * Kell-e írni? (A statisztikát is vezeti)
+     */
+    bool needsWrite(bool valid, bool same);
+
+   public:
+    /**
+     * Konstruktor
+     */
+    Si4735State(SI4735 &si4735) : si4735(si4735) {}
+
+    /**
+     * Az ismert állapot eldobása (chip reset, patch letöltés után)
+     */
+    inline void invalidate() {
+        modeValid = antCapValid = false;
+        invalidateProperties();
+    }
+
+    /**
+     * Ismert a chip állapota? (Volt már sikeres apply() az utolsó újraindítás óta)
+     */
+    inline bool isValid() const { return modeValid; }
+
+    /**
+     * A kívánt állapot kiküldése, csak a különbségek
+     * @return true, ha mód beállítás (setFM/setAM/setSSB) is történt
+     */
+    bool apply(const Si4735Settings &desired);
+
+    /**
+     * Várakozás a hangolás befejezésére (STC), majd az STC nyugtázása
+     * @return false, ha timeout volt
+     */
+    bool waitTuneComplete(uint16_t timeoutMsec = SI4735_STC_TIMEOUT_MSEC);
+
+    /**
+     * Hangolás indítása várakozás nélkül (a végét a pollTuneComplete()-el kell figyelni)
+     */
+    void beginTune(uint16_t freq);
+
+    /**
+     * Befejeződött a hangolás? (Ha igen, az STC-t nyugtázzuk)
+     */
+    bool pollTuneComplete();
+
+    /**
+     * Fut még hangolás? (Bárki indította: TuneEngine, memória szkenner, AF ellenőrzés, spektrum szkenner)
+     * Ha az STC-t senki nem nyugtázta, a timeout után már nem számít hangolásnak.
+     */
+    inline bool isTuning() const { return tuneInProgress and millis() - tuneStartMsec < SI4735_STC_TIMEOUT_MSEC; }
+
+    /**
+     * Az utolsó hangolás indításának ideje (millis): az ennél korábbi jelminőség mérés még a régi frekvenciáé lehet
+     */
+    inline uint32_t getLastTuneMsec() const { return tuneStartMsec; }
+
+    /**
+     * Az utoljára kiküldött állapot
+     */
+    inline const Si4735Settings &getApplied() const { return applied; }
+
+    /**
+     * Az utoljára beállított frekvencia (a library is nyilvántartja, akárki állította be, nincs I2C)
+     */
+    inline uint16_t getTunedFrequency() { return si4735.getCurrentFrequency(); }
+
+    /**
+     * Hangerő beállítása (csak ha változott)
+     */
+    void setVolume(uint8_t volume);
+
+    /**
+     * AGC beállítása (csak ha változott)
+     * @param agcDisabled 1 = AGC tiltva
+     * @param agcIndex a csillapítás
+     */
+    void setAutomaticGainControl(uint8_t agcDisabled, uint8_t agcIndex);
+
+    /**
+     * Az AGC engedélyezett? (Érvényes cache esetén nincs I2C olvasás)
+     */
+    bool isAgcEnabled();
+
+    /**
+     * Antenna kapacitás beállítása (csak ha változott, a következő hangolással megy ki a chipre)
+     */
+    void setAntennaCapacitor(uint16_t antCap);
+
+    /**
+     * SSB BFO beállítása (csak ha változott)
+     */
+    void setSSBBfo(int16_t bfo);
+
+    /**
+     * A property cache I2C forgalom és az apply() mérések kiírása (SI4735_STATS_INTERVAL_MSEC-enként)
+     */
+    void reportStats();
+};
+
+#endif  //__SI4735STATE_H
@@ -27,11 +27,6 @@ class Si4735Utils {
     // Band objektum
     Band &band;
 
-    /**
-     * Manage Squelch
-     */
-    void manageSquelch();
-
     /**
      * AGC beállítása
      */
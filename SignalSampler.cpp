@@ -0,0 +1,58 @@
+#include "SignalSampler.h"
+
+#include "I2cTrace.h"
+#include "utils.h"
+
+/**
+ * Egy mérés az éppen hangolt frekvencián, a snapshot módosítása nélkül
+ */
+SignalQuality SignalSampler::measure() {
+
+    SignalQuality quality;
+
+    {
+        I2cTrace::Scope trace(band.getCurrentBandType() == FM_BAND_TYPE ? FM_RSQ_STATUS : AM_RSQ_STATUS, I2C_TRACE_BYTES_RSQ_STATUS);
+        si4735.getCurrentReceivedSignalQuality();
+    }
+    quality.version = snapshot.version;
+    quality.timestamp = millis();
+    quality.frequency = band.getChipState().getTunedFrequency();
+    quality.rssi = si4735.getCurrentRSSI();
+    quality.snr = si4735.getCurrentSNR();
+    quality.multipath = si4735.getCurrentMultipath();
+    quality.freqOffset = si4735.getCurrentSignedFrequencyOffset();
+    quality.pilot = si4735.getCurrentPilot();
+
+    return quality;
+}
+
+/**
+ * Azonnali mérés és publikálás
+ */
+const SignalQuality &SignalSampler::sampleNow() {
+
+    uint32_t version = snapshot.version + 1;
+    snapshot = measure();
+    snapshot.version = version;
+    lastSample = snapshot.timestamp;
+
+    return snapshot;
+}
+
+/**
+ * Arduino loop: periodikus mérés
+ */
+void SignalSampler::loop() {
+
+    if (millis() - lastSample < SIGNAL_SAMPLER_PERIOD_MSEC) {
+        return;
+    }
+
+    // Hangolás közben (a TuneEngine-é, vagy a memória szkenner / AF ellenőrzés saját hangolása) nem mérünk,
+    // a hangolás végén a következő loop()-ban igen
+    if (suspended or !band.getTuneEngine().isIdle() or band.getChipState().isTuning()) {
+        return;
+    }
+
+    sampleNow();
+}
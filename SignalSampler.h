@@ -0,0 +1,81 @@
+#ifndef __SIGNALSAMPLER_H
+#define __SIGNALSAMPLER_H
+
+#include <SI4735.h>
+
+#include "Band.h"
+
+#define SIGNAL_SAMPLER_PERIOD_MSEC 100  // Ilyen gyakran olvassuk ki az RSQ státuszt
+
+/**
+ * A jelminőség (RSQ státusz) egy kiolvasásának eredménye
+ */
+struct SignalQuality {
+    uint32_t version;    // A snapshot sorszáma (minden új mérésnél nő, 0 -> még nem volt mérés)
+    uint32_t timestamp;  // A mérés ideje (millis)
+    uint16_t frequency;  // A mérés alatt hangolt frekvencia
+    uint8_t rssi;        // dBuV
+    uint8_t snr;         // dB
+    uint8_t multipath;   // FM multipath (0-100%)
+    int8_t freqOffset;   // Frekvencia eltérés (kHz)
+    bool pilot;          // FM stereo pilot
+};
+
+/**
+ * Fix ütemű jelminőség mintavételező
+ *
+ * Az RSQ státuszt egyetlen helyen, SIGNAL_SAMPLER_PERIOD_MSEC periódussal olvassuk ki egy verziózott snapshot-ba.
+ * Az S-Meter, a squelch, az RDS és a stereo kijelzés (és a memória szkenner) ebből olvas, így az I2C forgalom állandó,
+ * nem függ attól, hogy hány kijelző elem van éppen a képernyőn.
+ * Hangolás közben nem mérünk (a mért érték még az előző frekvenciáé lehetne), akárki indította a hangolást.
+ * A spektrum szkenner a saját frekvenciáin mér, a szkennelés alatt a periodikus mérést felfüggeszti (setSuspended()).
+ *
+ * A más frekvencián végzett mérések (AF ellenőrzés, spektrum szkennelés) a measure()-t használják, ami nem írja felül
+ * az aktuális csatorna snapshot-ját.
+ */
+class SignalSampler {
+
+   private:
+    SI4735 &si4735;
+    Band &band;
+
+    SignalQuality snapshot = {};
+    uint32_t lastSample = 0;
+    bool suspended = false;  // A periodikus mérés felfüggesztve (a chip nem az aktuális csatornán áll)
+
+   public:
+    /**
+     * Konstruktor
+     */
+    SignalSampler(SI4735 &si4735, Band &band) : si4735(si4735), band(band) {}
+
+    /**
+     * Az aktuális snapshot
+     */
+    inline const SignalQuality &get() const { return snapshot; }
+
+    /**
+     * Egy mérés az éppen hangolt frekvencián, a snapshot módosítása nélkül
+     */
+    SignalQuality measure();
+
+    /**
+     * Azonnali mérés és publikálás (pl. a hangolás végén, ha nem akarunk a következő periódusig várni)
+     */
+    const SignalQuality &sampleNow();
+
+    /**
+     * A periodikus mérés felfüggesztése / folytatása (a measure() és a sampleNow() közben is használható)
+     */
+    inline void setSuspended(bool suspend) { suspended = suspend; }
+
+    /**
+     * Arduino loop: periodikus mérés
+     */
+    void loop();
+};
+
+// Globális példány
+extern SignalSampler signalSampler;
+
+#endif  //__SIGNALSAMPLER_H
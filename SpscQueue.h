@@ -0,0 +1,80 @@
+#ifndef __SPSCQUEUE_H
+#define __SPSCQUEUE_H
+
+#include <Arduino.h>
+
+/**
+ * Zármentes (lock-free) egy termelős, egy fogyasztós (SPSC) gyűrű puffer
+ *
+ * A termelő (pl. megszakítás) csak a head-et, a fogyasztó (loop()) csak a tail-t írja, így nem kell tiltani
+ * a megszakításokat. Az indexek szabadon futnak (a méret 2 hatványa), a telítettség a különbségükből adódik.
+ * A push() RAM-ból futó megszakításból is hívható (__force_inline, flash hozzáférés nélkül).
+ *
+ * @tparam T az elem típusa
+ * @tparam SIZE a puffer mérete (2 hatványa)
+ */
+template <typename T, uint8_t SIZE>
+class SpscQueue {
+
+    static_assert(SIZE > 0 and (SIZE & (SIZE - 1)) == 0, "Az SpscQueue mérete 2 hatványa kell legyen");
+
+   private:
+    T buffer[SIZE];
+    volatile uint8_t head = 0;  // A következő írás helye (csak a termelő írja)
+    volatile uint8_t tail = 0;  // A következő olvasás helye (csak a fogyasztó írja)
+    volatile uint16_t overflowCount = 0;
+
+   public:
+    /**
+     * Elem betétele (termelő)
+     * @return false, ha a puffer tele van (az elemet eldobjuk)
+     */
+    __force_inline bool push(const T &item) {
+        uint8_t h = head;
+        if ((uint8_t)(h - tail) >= SIZE) {
+            overflowCount++;
+            return false;
+        }
+        buffer[h & (SIZE - 1)] = item;
+        __dmb();  // Az elem a head léptetése előtt legyen kiírva
+        head = h + 1;
+        return true;
+    }
+
+    /**
+     * A legrégebbi elem megnézése kivétel nélkül (fogyasztó)
+     */
+    inline bool peek(T &item) {
+        uint8_t t = tail;
+        if (t == head) {
+            return false;
+        }
+        __dmb();
+        item = buffer[t & (SIZE - 1)];
+        return true;
+    }
+
+    /**
+     * A legrégebbi elem kivétele (fogyasztó)
+     */
+    inline bool pop(T &item) {
+        if (!peek(item)) {
+            return false;
+        }
+        __dmb();  // Az elem a tail léptetése előtt legyen kiolvasva
+        tail = tail + 1;
+        return true;
+    }
+
+    /**
+     * Üres a puffer?
+     */
+    inline bool isEmpty() const { return head == tail; }
+
+    /**
+     * Az eldobott (tele puffer miatt elveszett) elemek száma
+     */
+    inline uint16_t getOverflowCount() const { return overflowCount; }
+};
+
+#endif  //__SPSCQUEUE_H
@@ -0,0 +1,37 @@
+#include "Squelch.h"
+
+/**
+ * Egy mérés kiértékelése
+ */
+bool Squelch::evaluate(uint8_t level, uint8_t threshold, uint32_t now) {
+
+    // Kikapcsolt zajzár
+    if (threshold == 0) {
+        pending = false;
+        if (!open) {
+            open = true;
+            return true;
+        }
+        return false;
+    }
+
+    // Nyitva a zárási (hiszterézissel alacsonyabb), zárva a nyitási küszöbhöz hasonlítunk
+    uint8_t closeThreshold = threshold > SQUELCH_HYSTERESIS ? threshold - SQUELCH_HYSTERESIS : 0;
+    bool toggle = open ? level < closeThreshold : level >= threshold;
+    if (!toggle) {
+        pending = false;
+        return false;
+    }
+
+    if (!pending) {
+        pending = true;
+        pendingSince = now;
+    }
+    if (now - pendingSince >= (open ? SQUELCH_DECAY_TIME : SQUELCH_ATTACK_TIME)) {
+        open = !open;
+        pending = false;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,62 @@
+#ifndef __SQUELCH_H
+#define __SQUELCH_H
+
+#include <Arduino.h>
+
+#include "rtVars.h"
+
+#define SQUELCH_HYSTERESIS 3     // A zárási küszöb ennyivel (dB) a nyitási alatt van
+#define SQUELCH_ATTACK_TIME 100  // msec, ennyi ideig kell a jelnek a nyitási küszöb felett lennie a nyitáshoz
+                                 // (a zárás ideje SQUELCH_DECAY_TIME)
+
+/**
+ * Zajzár (squelch)
+ *
+ * A jelminőség mintavételező minden új snapshot-ját kiértékeljük (fix ütem), az RSSI vagy az SNR alapján
+ * (config.data.squelchUsesRSSI). Külön nyitási (config.data.currentSquelch) és zárási (SQUELCH_HYSTERESIS-sel
+ * alacsonyabb) küszöb van, így a küszöb körül ingadozó jel nem kapcsolgat. Nyitni csak SQUELCH_ATTACK_TIME,
+ * zárni csak SQUELCH_DECAY_TIME folyamatos küszöb feletti / alatti jel után nyitunk / zárunk.
+ * A currentSquelch = 0 kikapcsolja a zajzárat (mindig nyitva).
+ *
+ * Itt csak a döntés van (hardware hozzáférés nélkül, host-on tesztelhető), a snapshot-ok kiértékelését
+ * és a hang némítását az AudioMute végzi.
+ */
+class Squelch {
+
+   private:
+    bool open = true;
+
+    // A váltás (nyitva: a zárás, zárva: a nyitás) feltétele teljesül, és mióta (msec)
+    bool pending = false;
+    uint32_t pendingSince = 0;
+
+   public:
+    /**
+     * A zajzár által figyelt jelszint (config.data.squelchUsesRSSI szerint)
+     */
+    static inline uint8_t selectLevel(uint8_t rssi, uint8_t snr, bool usesRssi) { return usesRssi ? rssi : snr; }
+
+    /**
+     * Eléri a jel a nyitási küszöböt? (Késleltetés nélkül, egy mérésre, pl. a memória szkenner döntéséhez)
+     */
+    static inline bool reachesOpenThreshold(uint8_t level, uint8_t threshold) { return threshold == 0 or level >= threshold; }
+
+    /**
+     * Egy mérés kiértékelése
+     * @param level a mért RSSI vagy SNR
+     * @param threshold a nyitási küszöb (0 -> a zajzár ki van kapcsolva)
+     * @param now az aktuális idő (msec)
+     * @return true, ha változott a zajzár állapota
+     */
+    bool evaluate(uint8_t level, uint8_t threshold, uint32_t now);
+
+    /**
+     * Nyitva van a zajzár?
+     */
+    inline bool isOpen() const { return open; }
+};
+
+// Globális példány
+extern Squelch squelch;
+
+#endif  //__SQUELCH_H
@@ -5,17 +5,150 @@
 #include <list>
 
 #include "EepromManager.h"
+#include "FlashJournal.h"
+
+#define STORE_SAVE_DEBOUNCE_MSEC 3000  // Az utolsó változás / felhasználói interakció után ennyivel mentünk
+
+/**
+ * A tárolt struktúra egy mezőjének leírója
+ */
+struct StoreField {
+    uint8_t tag;      // A mező állandó azonosítója (a flash journal kulcsa ebből képződik), nem változhat!
+    uint16_t offset;  // A mező helye a struktúrában (a struktúra átrendezésekor változhat)
+    uint8_t size;     // A mező mérete (ha változik, a tárolt érték nem töltődik be, az alapértelmezett marad)
+};
+
+/**
+ * A mező leírók ellenőrzése fordítási időben: a tag-ek egyediek és beleférnek a kulcs tartományba?
+ */
+constexpr bool storeFieldTagsValid(const StoreField *fields, size_t count, uint8_t maxTag) {
+    for (size_t i = 0; i < count; i++) {
+        if (fields[i].tag > maxTag) {
+            return false;
+        }
+        for (size_t j = i + 1; j < count; j++) {
+            if (fields[i].tag == fields[j].tag) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
 /**
- * Generikus wrapper ős osztály a mentés és betöltés + CRC számítás funkciókhoz
- * A beburkolt objektum EEPROM-ban történő kezelését oldja meg
+ * Generikus wrapper ős osztály a mentés és betöltés funkciókhoz
+ *
+ * A beburkolt objektumot mezőnként (tag-hossz-érték) tárolja a flash journal-ban: minden mező a tag-jéből képzett
+ * külön kulcson van (journalKeyBase + tag), mentéskor csak a változott mezők rekordjait fűzzük hozzá.
+ * Az alapértelmezett értékű mezőket nem tároljuk (a korábbi rekordjukat töröljük), így betöltéskor az alapértelmezett
+ * adatokra csak a tárolt mezőket kell ráírni. Mivel a mezőket a tag azonosítja, a struktúra bővítése vagy átrendezése
+ * után is betölthetők a korábbi értékek, az új mezők az alapértelmezett értéket kapják.
+ * A séma verzióját külön rekordban tároljuk, eltérés esetén a leszármazott migrate()-je alakíthatja át az adatokat.
+ *
+ * A változást a set() azonnal jelzi (dirty bit), a közvetlenül írt mezőket a legutóbb mentett
+ * állapot másolatával mezőnként összehasonlítva találjuk meg.
+ * A mentés az utolsó változás / felhasználói interakció után STORE_SAVE_DEBOUNCE_MSEC-el történik (loop()),
+ * kikapcsolás előtt a flush() azonnal ment.
+ * Ha a journal nem használható, akkor a teljes struktúrát az EEPROM-ba mentjük.
  */
 template <typename T>
 class StoreBase {
 
    private:
-    // A tárolt adatok CRC32 ellenőrző összege
-    uint16_t lastCRC = 0;
+    T saved;                 // A legutóbb mentett (betöltött) állapot másolata
+    uint32_t dirtyMask = 0;  // A set()-el jelzett, mentésre váró mezők (bit = mező index)
+
+    uint8_t journalKey;      // A teljes struktúra (régi formátum) flash journal kulcsa
+    uint8_t schemaKey;       // A séma verzió flash journal kulcsa
+    uint8_t journalKeyBase;  // A 0 tag-ű mező flash journal kulcsa
+    uint8_t schemaVersion;   // Az aktuális séma verzió
+
+    // Késleltetett mentés
+    bool savePending = false;  // Változás / interakció volt, mentés előtt össze kell hasonlítani
+    uint32_t lastChange = 0;   // Az utolsó változás / interakció ideje
+
+    /**
+     * A mező indexe a struktúrán belüli címe alapján
+     * @return a mező indexe, vagy -1, ha nincs ilyen mező
+     */
+    int8_t findField(const void *fieldPtr) {
+        uint8_t count;
+        const StoreField *fields = getFields(count);
+        uint16_t offset = (const uint8_t *)fieldPtr - (const uint8_t *)&r();
+        for (uint8_t i = 0; i < count; i++) {
+            if (fields[i].offset == offset) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * A tárolt mezők ráírása az adatokra
+     * @return a betöltött mezők száma
+     */
+    uint8_t loadFields() {
+        uint8_t count;
+        const StoreField *fields = getFields(count);
+        uint8_t loaded = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (flashJournal.read(journalKeyBase + fields[i].tag, (uint8_t *)&r() + fields[i].offset, fields[i].size)) {
+                loaded++;
+            }
+        }
+        return loaded;
+    }
+
+    /**
+     * A korábbi formátumok betöltése (séma verzió nélkül): a teljes struktúra a régi journal rekordból, vagy ha az sincs,
+     * az EEPROM-ból (az aktuális, vagy a leszármazott által ismert régebbi struktúrával), erre jönnek a mezőnként mentett értékek
+     */
+    void loadLegacy() {
+        if (flashJournal.read(journalKey, &r(), sizeof(T))) {
+            DEBUG("StoreBase::loadLegacy() -> Flash journal snapshot load OK\n");
+        } else {
+            bool valid = false;
+            EepromManager<T>::getIfValid(r(), valid);
+            if (!valid) {
+                loadDefaults();
+                if (!loadLegacyEeprom()) {
+                    EepromManager<T>::load(r());  // Nincs érvényes tartalom: hibajelzés, az alapértelmezett adatok mentése
+                }
+            }
+        }
+        loadFields();
+    }
+
+    /**
+     * Az összes mező átírása az új formátumba a séma verzióval együtt
+     * A sorrend miatt a folyamat bármely pontján történt kikapcsolás után is helyes adatok töltődnek be:
+     * előbb a nem alapértelmezett mezők, aztán a séma verzió, végül az alapértelmezett értékű régi rekordok törlése.
+     */
+    void rewriteAll() {
+        uint8_t count;
+        const StoreField *fields = getFields(count);
+        const uint8_t *defaults = (const uint8_t *)&getDefaults();
+
+        bool ok = true;
+        for (uint8_t i = 0; i < count; i++) {
+            const uint8_t *current = (const uint8_t *)&r() + fields[i].offset;
+            if (memcmp(current, defaults + fields[i].offset, fields[i].size) != 0) {
+                ok &= flashJournal.append(journalKeyBase + fields[i].tag, current, fields[i].size);
+            }
+        }
+        ok &= flashJournal.append(schemaKey, &schemaVersion, sizeof(schemaVersion));
+        for (uint8_t i = 0; i < count; i++) {
+            uint8_t key = journalKeyBase + fields[i].tag;
+            if (memcmp((const uint8_t *)&r() + fields[i].offset, defaults + fields[i].offset, fields[i].size) == 0 and flashJournal.contains(key)) {
+                ok &= flashJournal.remove(key);
+            }
+        }
+
+        if (!ok) {
+            EepromManager<T>::save(r());
+            DEBUG("StoreBase::rewriteAll() -> journal error, saved to the EEPROM\n");
+        }
+    }
 
    protected:
     /**
@@ -23,37 +156,194 @@ class StoreBase {
      */
     virtual T &r() = 0;
 
+    /**
+     * Az alapértelmezett adatok (a nem tárolt mezők értéke)
+     */
+    virtual const T &getDefaults() = 0;
+
+    /**
+     * A mezők leírói
+     */
+    virtual const StoreField *getFields(uint8_t &count) = 0;
+
+    /**
+     * Az adatok átalakítása egy korábbi séma verzióról (a tárolt mezők betöltése után hívjuk)
+     * Az új mezőkhöz nem kell, azok az alapértelmezett értéket kapják, csak a jelentésükben változott mezőkhöz.
+     * @param fromVersion a tárolt séma verzió (0 -> a séma verzió előtti formátum)
+     */
+    virtual void migrate(uint8_t fromVersion) {}
+
+    /**
+     * Egy régebbi struktúrával mentett EEPROM tartalom betöltése (az alapértelmezett adatokra)
+     * Ha egy mezőt a struktúra közepére vettek fel, a régi EEPROM tartalom az új struktúrával CRC hibás:
+     * ilyenkor a leszármazott a régi struktúra befagyasztott másolatával olvashatja be.
+     * @return true, ha volt érvényes régi tartalom
+     */
+    virtual bool loadLegacyEeprom() { return false; }
+
    public:
     /**
-     * Tárolt adatok mentése
+     * Konstruktor
+     * @param journalKey a teljes struktúra flash journal kulcsa (a korábbi formátum betöltéséhez)
+     * @param schemaKey a séma verzió flash journal kulcsa
+     * @param journalKeyBase a 0 tag-ű mező flash journal kulcsa
+     * @param schemaVersion az aktuális séma verzió
+     */
+    StoreBase(uint8_t journalKey, uint8_t schemaKey, uint8_t journalKeyBase, uint8_t schemaVersion)
+        : saved{}, journalKey(journalKey), schemaKey(schemaKey), journalKeyBase(journalKeyBase), schemaVersion(schemaVersion) {}
+
+    /**
+     * Mező beállítása és mentésre jelölése
      */
-    virtual void forceSave() { EepromManager<T>::save(r()); }
+    template <typename F, typename V>
+    void set(F &field, V value) {
+        if (field == static_cast<F>(value)) {
+            return;
+        }
+        field = static_cast<F>(value);
+        int8_t idx = findField(&field);
+        if (idx >= 0) {
+            dirtyMask |= (uint32_t)1 << idx;
+        }
+        notifyActivity();
+    }
+
+    /**
+     * Felhasználói interakció volt (a dialógok közvetlenül írják a mezőket): a mentést a végére halasztjuk
+     */
+    inline void notifyActivity() {
+        savePending = true;
+        lastChange = millis();
+    }
+
+    /**
+     * Tárolt adatok mentése (minden mező)
+     */
+    virtual void forceSave() {
+        uint8_t count;
+        getFields(count);
+        dirtyMask = count < 32 ? ((uint32_t)1 << count) - 1 : 0xFFFFFFFF;
+        checkSave();
+    }
 
     /**
      * Tárolt adatok betöltése
      */
-    virtual void load() { lastCRC = EepromManager<T>::load(r()); }
+    virtual void load() {
+
+        uint32_t start = micros();
+
+        uint8_t storedVersion;
+        bool rewrite = false;
+        if (flashJournal.read(schemaKey, &storedVersion, sizeof(storedVersion))) {
+            // Az alapértelmezett adatokra a tárolt mezők
+            loadDefaults();
+            uint8_t loaded = loadFields();
+            DEBUG("StoreBase::load() -> schema v%d, %d fields loaded, %d usec\n", storedVersion, loaded, micros() - start);
+
+            if (storedVersion != schemaVersion) {
+                DEBUG("StoreBase::load() -> migrating schema v%d -> v%d\n", storedVersion, schemaVersion);
+                migrate(storedVersion);
+                rewrite = true;
+            }
+        } else {
+            // Korábbi formátum (vagy az első indulás a journal-lal): átírjuk az új formátumba
+            loadLegacy();
+            DEBUG("StoreBase::load() -> legacy format loaded\n");
+            migrate(0);
+            rewrite = flashJournal.isReady();
+        }
+
+        saved = r();
+        dirtyMask = 0;
+        savePending = false;
+
+        if (rewrite) {
+            rewriteAll();
+        }
+    }
 
     /**
      * Alapértelmezett adatok betöltése
-     * Muszáj implementálni a leszármazottban
      */
-    virtual void loadDefaults() = 0;
+    virtual void loadDefaults() { memcpy(&r(), &getDefaults(), sizeof(T)); }
 
     /**
-     * CRC ellenőrzés és mentés indítása, ha szükséges
+     * Visszaállás az alapértelmezett adatokra, a tárolt mezők törlése
+     */
+    void reset() {
+        loadDefaults();
+        rewriteAll();
+        saved = r();
+        dirtyMask = 0;
+        savePending = false;
+    }
+
+    /**
+     * A változott mezők mentése, ha szükséges
      */
     virtual void checkSave() final {
 
-        uint16_t crc = calcCRC16((uint8_t *)&r(), sizeof(T));
-        if (lastCRC != crc) {
-            crc = EepromManager<T>::save(r());
-            lastCRC = crc;
-            DEBUG("StoreBase::checkSave() -> Saving the config to the EEPROM is OK., crc = %d\n", crc);
+        uint32_t start = micros();
+        uint8_t count;
+        const StoreField *fields = getFields(count);
+        const uint8_t *defaults = (const uint8_t *)&getDefaults();
+
+        uint8_t written = 0;
+        bool failed = false;
+        for (uint8_t i = 0; i < count; i++) {
+            const uint8_t *current = (const uint8_t *)&r() + fields[i].offset;
+            uint8_t *stored = (uint8_t *)&saved + fields[i].offset;
+
+            // A set()-el jelzett, vagy a közvetlenül írt (a mentettől eltérő) mező
+            if (!(dirtyMask & ((uint32_t)1 << i)) and memcmp(current, stored, fields[i].size) == 0) {
+                continue;
+            }
+
+            // Az alapértelmezett értéket nem tároljuk: a korábbi rekordot (ha van) töröljük
+            uint8_t key = journalKeyBase + fields[i].tag;
+            bool ok;
+            if (memcmp(current, defaults + fields[i].offset, fields[i].size) == 0) {
+                ok = !flashJournal.contains(key) or flashJournal.remove(key);
+            } else {
+                ok = flashJournal.append(key, current, fields[i].size);
+            }
+
+            if (ok) {
+                memcpy(stored, current, fields[i].size);
+                written++;
+            } else {
+                failed = true;
+            }
+        }
+        dirtyMask = 0;
+        savePending = false;
+
+        // A journal nem használható (vagy írási hiba volt): a teljes struktúra az EEPROM-ba
+        if (failed) {
+            EepromManager<T>::save(r());
+            saved = r();
+            DEBUG("StoreBase::checkSave() -> Saving the config to the EEPROM is OK.\n");
+        } else if (written > 0) {
+            DEBUG("StoreBase::checkSave() -> %d fields saved, %d usec\n", written, micros() - start);
         } else {
-            DEBUG("StoreBase::checkSave() -> There is no need to save the config to the EEPROM\n");
+            DEBUG("StoreBase::checkSave() -> There is no need to save the config\n");
         }
     }
+
+    /**
+     * A késleltetett mentés kezelése (a loop()-ból hívjuk)
+     */
+    void loop() {
+        if (savePending and millis() - lastChange >= STORE_SAVE_DEBOUNCE_MSEC) {
+            checkSave();
+        }
+    }
+
+    /**
+     * Azonnali mentés (pl. kikapcsolás előtt)
+     */
+    inline void flush() { checkSave(); }
 };
 
 #endif  //__STOREBASE_H
@@ -0,0 +1,79 @@
+#include "TuneEngine.h"
+
+#include "utils.h"
+
+/**
+ * A hangolási statisztika kiírása, majd új mérési ablak
+ */
+void TuneEngine::reportStats() {
+
+    if (statTunes > 0) {
+        DEBUG("TuneEngine -> %d tunes (%d timeouts), coalesced steps: %d, avg: %d msec, max: %d msec\n", statTunes, statTimeouts, statCoalescedSteps, statTotalMsec / statTunes,
+              statMaxMsec);
+    }
+    statTunes = statTimeouts = statCoalescedSteps = statTotalMsec = statMaxMsec = 0;
+}
+
+/**
+ * Új célfrekvencia (azonnal visszatér)
+ */
+void TuneEngine::setTarget(uint16_t freq) {
+
+    if (pending or tuning) {
+        coalescedSteps++;
+    }
+
+    targetFreq = freq;
+    pending = true;
+
+    // Ha a chip szabad, rögtön indítjuk
+    loop();
+}
+
+/**
+ * A függő célfrekvencia eldobása és a futó hangolás megvárása
+ */
+void TuneEngine::cancel() {
+
+    pending = false;
+    if (tuning) {
+        chipState.waitTuneComplete();
+        tuning = false;
+    }
+    coalescedSteps = 0;
+}
+
+/**
+ * Arduino loop: a futó hangolás figyelése, a következő indítása
+ */
+void TuneEngine::loop() {
+
+    // Fut még az előző hangolás?
+    if (tuning) {
+        bool timeout = millis() - tuneStart >= TUNE_ENGINE_TIMEOUT_MSEC;
+        if (!chipState.pollTuneComplete() and !timeout) {
+            return;
+        }
+        tuning = false;
+
+        uint32_t elapsed = millis() - tuneStart;
+        statTunes++;
+        statTimeouts += timeout ? 1 : 0;
+        statCoalescedSteps += coalescedSteps;
+        statTotalMsec += elapsed;
+        if (elapsed > statMaxMsec) {
+            statMaxMsec = elapsed;
+        }
+        coalescedSteps = 0;
+    }
+
+    // A chip szabad: indítjuk a legutolsó célfrekvenciára
+    if (pending) {
+        pending = false;
+        if (targetFreq != chipState.getTunedFrequency()) {
+            chipState.beginTune(targetFreq);
+            tuneStart = millis();
+            tuning = true;
+        }
+    }
+}
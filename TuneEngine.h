@@ -0,0 +1,74 @@
+#ifndef __TUNEENGINE_H
+#define __TUNEENGINE_H
+
+#include "Si4735State.h"
+
+#define TUNE_ENGINE_TIMEOUT_MSEC SI4735_STC_TIMEOUT_MSEC  // Ha eddig nem jön STC, akkor a hangolást befejezettnek vesszük
+
+/**
+ * Nem blokkoló hangolás
+ *
+ * A rotary a célfrekvenciát azonnal átírja (a kijelző ezt mutatja), a hangolást viszont csak akkor
+ * indítjuk, ha a chip szabad: mindig a legutolsó célfrekvenciára. Így egy gyors tekerés alatti
+ * köztes lépésekre nem indul külön hangolás, azok összevonódnak.
+ * A hangolás végét az STC bit figyelésével vesszük észre.
+ */
+class TuneEngine {
+
+   private:
+    Si4735State &chipState;
+
+    uint16_t targetFreq = 0;  // A legutóbb kért frekvencia
+    bool pending = false;     // Van még ki nem adott célfrekvencia?
+    bool tuning = false;      // Fut a chipen egy hangolás?
+    uint32_t tuneStart = 0;   // A futó hangolás indítása [msec]
+
+    // Statisztika
+    uint16_t coalescedSteps = 0;  // A futó hangolás alatt összevont lépések
+
+    // Mérés (a legutóbbi reportStats() óta)
+    uint32_t statTunes = 0;           // Befejezett hangolások
+    uint32_t statTimeouts = 0;        // Ebből STC nélkül, timeout-tal befejezettek
+    uint32_t statCoalescedSteps = 0;  // Összevont (ki nem adott) lépések
+    uint32_t statTotalMsec = 0;       // A hangolások összes ideje
+    uint32_t statMaxMsec = 0;         // A leghosszabb hangolás
+
+   public:
+    /**
+     * Konstruktor
+     */
+    TuneEngine(Si4735State &chipState) : chipState(chipState) {}
+
+    /**
+     * Új célfrekvencia (azonnal visszatér)
+     */
+    void setTarget(uint16_t freq);
+
+    /**
+     * A célfrekvencia: a még ki nem adott, vagy az utoljára kiadott
+     */
+    inline uint16_t getTarget() { return pending ? targetFreq : chipState.getTunedFrequency(); }
+
+    /**
+     * Nincs futó és függő hangolás?
+     */
+    inline bool isIdle() const { return !pending and !tuning; }
+
+    /**
+     * A függő célfrekvencia eldobása és a futó hangolás megvárása
+     * (Band/mód váltás előtt, ami saját maga hangol)
+     */
+    void cancel();
+
+    /**
+     * Arduino loop: a futó hangolás figyelése, a következő indítása
+     */
+    void loop();
+
+    /**
+     * A hangolási statisztika kiírása (SI4735_STATS_INTERVAL_MSEC-enként)
+     */
+    void reportStats();
+};
+
+#endif  //__TUNEENGINE_H
@@ -155,6 +155,16 @@ class ValueChangeDialog : public MessageDialog {
         drawValue();
     }
 
+    /**
+     * A rotary encoder gyorsítási görbéje
+     * Érték állításnál csak enyhe gyorsítás kell, hogy a kis tartományokban (pl. hangerő) ne lőjünk túl
+     */
+    const RotaryEncoder::AccelerationCurve &getAccelerationCurve() override {
+        static constexpr RotaryEncoder::AccelerationPoint POINTS[] = {{5, 1}, {20, 2}, {40, 5}, {80, 10}};
+        static constexpr RotaryEncoder::AccelerationCurve CURVE = {POINTS, ARRAY_ITEM_COUNT(POINTS)};
+        return CURVE;
+    }
+
     /**
      * Rotary handler
      */
@@ -181,11 +191,7 @@ class ValueChangeDialog : public MessageDialog {
             if (useEncoderValue) {
                 tempVal += encoderState.value;  // Közvetlenül az encoder értékével növelünk/csökkentünk
             } else {
-                if (encoderState.direction == RotaryEncoder::Direction::Up) {
-                    tempVal += static_cast<int>(step);
-                } else {
-                    tempVal -= static_cast<int>(step);
-                }
+                tempVal += encoderState.value * static_cast<int>(step);  // A (gyorsított) lépésszámszor a lépésköz
             }
             // Érvényes tartomány rögzítése
             tempVal = std::max(static_cast<int>(minVal), std::min(tempVal, static_cast<int>(maxVal)));
@@ -199,11 +205,7 @@ class ValueChangeDialog : public MessageDialog {
                 tempVal += encoderState.value;  // Közvetlenül az encoder értékével növelünk/csökkentünk
                 DEBUG("ValueChangeDialog::handleRotary(long long) -> encoderState.value: %d\n", encoderState.value);
             } else {
-                if (encoderState.direction == RotaryEncoder::Direction::Up) {
-                    tempVal += static_cast<long long>(step);
-                } else {
-                    tempVal -= static_cast<long long>(step);
-                }
+                tempVal += encoderState.value * static_cast<long long>(step);  // A (gyorsított) lépésszámszor a lépésköz
             }
             // Érvényes tartomány rögzítése
             tempVal = std::max(static_cast<long long>(minVal), std::min(tempVal, static_cast<long long>(maxVal)));
@@ -216,11 +218,7 @@ class ValueChangeDialog : public MessageDialog {
             if (useEncoderValue) {
                 tempVal += static_cast<double>(encoderState.value);  // Közvetlenül az encoder értékével növelünk/csökkentünk
             } else {
-                if (encoderState.direction == RotaryEncoder::Direction::Up) {
-                    tempVal += static_cast<double>(step);
-                } else {
-                    tempVal -= static_cast<double>(step);
-                }
+                tempVal += encoderState.value * static_cast<double>(step);  // A (gyorsított) lépésszámszor a lépésköz
             }
             // Érvényes tartomány rögzítése
             tempVal = std::max(static_cast<double>(minVal), std::min(tempVal, static_cast<double>(maxVal)));
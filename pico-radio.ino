@@ -12,15 +12,22 @@ TFT_eSPI tft;          // TFT objektum
 //------------------- Rotary Encoder
 #define __USE_ROTARY_ENCODER_IN_HW_TIMER
 #ifdef __USE_ROTARY_ENCODER_IN_HW_TIMER
-// Pico Hardware timer a Rotary encoder olvasására
-#include <RPi_Pico_TimerInterrupt.h>
-RPI_PICO_Timer ITimer1(1);
+// Pico hardware alarm a Rotary encoder olvasására (RAM-ból fut, a flash írás alatt sem áll meg)
+#include "EncoderTimer.h"
+#include "FlashWriter.h"
 #endif
 
 #include "RotaryEncoder.h"
+#if ENC_DECODER == ENC_PIO
+static_assert(PIN_ENCODER_CLK == PIN_ENCODER_DT + 1 or PIN_ENCODER_DT == PIN_ENCODER_CLK + 1, "A PIO dekóderhez az encoder CLK/DT lábainak egymás mellett kell lenniük");
+#endif
 RotaryEncoder rotaryEncoder = RotaryEncoder(PIN_ENCODER_CLK, PIN_ENCODER_DT, PIN_ENCODER_SW, ROTARY_ENCODER_STEPS_PER_NOTCH);
 #define ROTARY_ENCODER_SERVICE_INTERVAL_IN_MSEC 1  // 1msec
 
+//------------------- Flash journal (a config tárolója)
+#include "FlashJournal.h"
+FlashJournal flashJournal;
+
 //------------------- EEPROM Config
 #include "Config.h"
 Config config;
@@ -29,10 +36,43 @@ Config config;
 #include <SI4735.h>
 SI4735 si4735;
 
+//------------------- RDS FIFO
+#include "RdsGroupFifo.h"
+RdsGroupFifo rdsGroupFifo(si4735);
+
+//------------------- RDS állomás cache
+#include "RdsStationCache.h"
+RdsStationCache rdsStationCache;
+
+//------------------- Memória csatornák
+#include "MemoryStore.h"
+MemoryStore memoryStore;
+
 //------------------- Band
 #include "Band.h"
 Band band(si4735);
 
+//------------------- Sávonkénti hangolási adatok mentése
+#include "BandStore.h"
+BandStore bandStore(band);
+
+//------------------- Memória csatornák szkennelése
+#include "MemoryScanner.h"
+MemoryScanner memoryScanner(si4735, band);
+
+//------------------- Jelminőség mintavételezés (S-Meter, squelch, RDS, stereo)
+#include "SignalSampler.h"
+SignalSampler signalSampler(si4735, band);
+
+//------------------- Zajzár, és a hang némítása (minden némítási ok egy helyen, a mute lábbal)
+#include "AudioMute.h"
+#include "Squelch.h"
+Squelch squelch;
+AudioMute audioMute(si4735);
+
+//------------------- I2C forgalom nyomkövetése (képernyőnként, kezdeményezőnként)
+#include "I2cTrace.h"
+
 //------------------- Memória információk megjelenítése
 #ifdef __DEBUG
 #include "PicoMemoryInfo.h"
@@ -120,19 +160,18 @@ void changeDisplay() {
 
     // Elmentjük az aktuális képernyő típust
     ::currentDisplay = newDisplay;
+    I2cTrace::setScreen(::currentDisplay, DisplayBase::decodeDisplayType(::currentDisplay));
 
     // Jelezzük, hogy nem akarunk képernyőváltást, megtörtént már
     ::newDisplay = DisplayBase::DisplayType::none;
 }
 
-#ifdef __USE_ROTARY_ENCODER_IN_HW_TIMER
+#ifdef __USE_RDS_INTERRUPT
 /**
- * Hardware timer interrupt service routine a rotaryhoz
+ * SI4735 GPO2/INT megszakítás kezelő
+ * Itt nem lehet I2C forgalom, csak jelezzük a loop()-nak, hogy ki kell üríteni az RDS FIFO-t
  */
-bool hardwareTimerHandler1(struct repeating_timer *t) {
-    rotaryEncoder.service();
-    return true;
-}
+void si4735InterruptHandler() { rdsGroupFifo.setIrqPending(); }
 #endif
 
 /** ----------------------------------------------------------------------------------------------------------------------------------------
@@ -156,8 +195,9 @@ void setup() {
     rotaryEncoder.setDoubleClickEnabled(true);
     rotaryEncoder.setAccelerationEnabled(true);
 #ifdef __USE_ROTARY_ENCODER_IN_HW_TIMER
-    // Pico HW Timer1 beállítása a rotaryhoz
-    ITimer1.attachInterruptInterval(ROTARY_ENCODER_SERVICE_INTERVAL_IN_MSEC * 1000, hardwareTimerHandler1);
+    // Pico HW alarm beállítása a rotaryhoz, a megszakítása a flash írás alatt is mehet
+    EncoderTimer::begin(rotaryEncoder, ROTARY_ENCODER_SERVICE_INTERVAL_IN_MSEC * 1000);
+    FlashWriter::allowIrq(EncoderTimer::getIrqNum());
 #endif
 
     // TFT inicializálása
@@ -168,18 +208,24 @@ void setup() {
     // Várakozás a soros port megnyitására
     ////////////////////////////////////////Utils::debugWaitForSerial(tft);
 
+    // A flash journal végigolvasása (a konfig betöltése előtt)
+    flashJournal.begin();
+
     // Ha a bekapcsolás alatt nyomva tartjuk a rotary gombját, akkor töröljük a konfigot
     if (digitalRead(PIN_ENCODER_SW) == LOW) {
         Utils::beepTick();
         delay(1500);
         if (digitalRead(PIN_ENCODER_SW) == LOW) {  // Ha még mindig nyomják
-            config.loadDefaults();
+            config.reset();
             Utils::beepTick();
             DEBUG("Default settings resored!\n");
         }
     } else {
         // konfig betöltése
         config.load();
+
+        // A sávok utolsó frekvenciájának, lépésközének, módjának betöltése
+        bandStore.load();
     }
     // Kell kalibrálni a TFT Touch-t?
     if (Utils::isZeroArray(config.data.tftCalibrateData)) {
@@ -194,6 +240,18 @@ void setup() {
     Wire.setSCL(PIN_SI4735_I2C_SCL);  // I2C for SI4735 SCL
     Wire.begin();
 
+#ifdef __USE_RDS_INTERRUPT
+    // SI4735 GPO2/INT megszakítás (aktív alacsony)
+    pinMode(PIN_SI4735_INT, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(PIN_SI4735_INT), si4735InterruptHandler, FALLING);
+#endif
+
+    // RDS állomás cache betöltése
+    rdsStationCache.begin();
+
+    // Memória csatornák indexeinek felépítése
+    memoryStore.begin();
+
     // Si4735 inicializálása
     int16_t si4735Addr = si4735.getDeviceI2CAddress(PIN_SI4735_RESET);
     if (si4735Addr == 0) {
@@ -206,6 +264,7 @@ void setup() {
             ;
     }
     si4735.setDeviceI2CAddress(si4735Addr == 0x11 ? 0 : 1);  // Sets the I2C Bus Address, erre is szükség van...
+    rtv::si4735Address = si4735Addr;                         // A saját (patch letöltő) I2C forgalomhoz
 
     // Megtaláltuk az SI4735-öt, kiírjuk az I2C címét a képernyőre
     tft.setFreeFont();
@@ -222,6 +281,7 @@ void setup() {
 
     // Band + Si4735 init
     si4735.setAudioMuteMcuPin(PIN_AUDIO_MUTE);  // Audio Mute pin
+    audioMute.begin();
 
     // Kezdő képernyőtípus beállítása
     ::newDisplay = band.getCurrentBandType() == FM_BAND_TYPE ? DisplayBase::DisplayType::fm : DisplayBase::DisplayType::am;
@@ -254,13 +314,56 @@ void loop() {
     }
 #endif
 
-//------------------- EEprom mentés figyelése
+    //------------------- Nem blokkoló hangolás: a futó hangolás figyelése, a következő indítása
+    {
+        I2cTrace::Caller traceCaller(I2cCaller::Tune);
+        band.getTuneEngine().loop();
+    }
+
+    //------------------- Jelminőség mintavételezés: fix ütemben, a hangolások között
+    {
+        I2cTrace::Caller traceCaller(I2cCaller::Signal);
+        signalSampler.loop();
+    }
+
+    //------------------- Zajzár: minden új mérés kiértékelése, állapotváltáskor a mute láb kapcsolása
+    audioMute.loop();
+
+    //------------------- Memória szkennelés: a futó hangolás figyelése, a jel kiértékelése
+    {
+        I2cTrace::Caller traceCaller(I2cCaller::Scan);
+        memoryScanner.loop();
+    }
+
+    //------------------- RDS FIFO kiürítése (a képernyő frissítésétől és a dialógoktól függetlenül)
+    if (config.data.rdsEnabled and band.getCurrentBandType() == FM_BAND_TYPE) {
+        I2cTrace::Caller traceCaller(I2cCaller::RdsFifo);
+        rdsGroupFifo.loop();
+    }
+
+    //------------------- Config mentés: a változott mezők az utolsó változás / interakció után
+    config.loop();
+
+//------------------- EEprom mentés figyelése (a közvetlenül, interakció nélkül írt mezők miatt is)
 #define EEPROM_SAVE_CHECK_INTERVAL 1000 * 60 * 5  // 5 perc
     static uint32_t lastEepromSaveCheck = 0;
     if (millis() - lastEepromSaveCheck >= EEPROM_SAVE_CHECK_INTERVAL) {
         config.checkSave();
+        bandStore.checkSave();
         lastEepromSaveCheck = millis();
     }
+
+#ifdef __DEBUG
+    //------------------- SI4735 property cache statisztika
+    static uint32_t lastChipStatsReport = 0;
+    if (millis() - lastChipStatsReport >= SI4735_STATS_INTERVAL_MSEC) {
+        band.getChipState().reportStats();
+        band.getTuneEngine().reportStats();
+        I2cTrace::report();
+        lastChipStatsReport = millis();
+    }
+#endif
+
     //------------------- Memória információk megjelenítése
     // #ifdef __DEBUG
     // #define MEMORY_INFO_INTERVAL 20 * 1000  // 20mp
@@ -271,28 +374,39 @@ void loop() {
     //     }
     // #endif
 
-    // Rotary Encoder olvasása
-    RotaryEncoder::EncoderState encoderState = rotaryEncoder.read();
-    // Ha folyamatosan nyomva tartják a rotary gombját akkor kikapcsolunk
-    if (encoderState.buttonState == RotaryEncoder::ButtonState::Held) {
-        // TODO: Kikapcsolás figyelését még implementálni
-        DEBUG("Ki kellene kapcsolni...\n");
-        Utils::beepError();
-        delay(1000);
-        return;
-    }
+    // Rotary Encoder események: minden függő eseményt feldolgozunk, így a lassú loop alatt jött kattintások sem olvadnak össze
+    // Ha valamelyik esemény képernyő váltást kér, a maradékot már az új képernyő kapja
+    bool userInteraction = false;
+    do {
+        // A gyorsítás görbéjét az aktuális képernyő/dialóg határozza meg (FM, AM, BFO, érték állítás)
+        rotaryEncoder.setAccelerationCurve(pDisplay->getActiveAccelerationCurve());
+        RotaryEncoder::EncoderState encoderState = rotaryEncoder.read();
+        // Ha folyamatosan nyomva tartják a rotary gombját akkor kikapcsolunk
+        if (encoderState.buttonState == RotaryEncoder::ButtonState::Held) {
+            // TODO: Kikapcsolás figyelését még implementálni
+            DEBUG("Ki kellene kapcsolni...\n");
+            // Kikapcsolás előtt a függő változásokat azonnal mentjük
+            config.flush();
+            bandStore.checkSave();
+            Utils::beepError();
+            delay(1000);
+            return;
+        }
 
-    // FIXME: Ezt majd ellenőrizni...
-    //////////////////////////////////////////////////////pDisplay->MuteAud();
+        // FIXME: Ezt majd ellenőrizni...
+        //////////////////////////////////////////////////////pDisplay->MuteAud();
 
-    // Aktuális Display loopja
-    bool handleInLoop = pDisplay->loop(encoderState);
+        // Aktuális Display loopja
+        I2cTrace::Caller traceCaller(I2cCaller::Screen);
+        bool handleInLoop = pDisplay->loop(encoderState);
 
-    static uint32_t lastScreenSaver = millis();
-    // Ha volt touch valamelyik képernyőn, vagy volt rotary esemény...
-    // Volt felhasználói interakció?
-    bool userInteraction = (handleInLoop or encoderState.buttonState != RotaryEncoder::Open or encoderState.direction != RotaryEncoder::Direction::None);
+        // Ha volt touch valamelyik képernyőn, vagy volt rotary esemény...
+        // Volt felhasználói interakció?
+        userInteraction |= (handleInLoop or encoderState.buttonState != RotaryEncoder::Open or encoderState.direction != RotaryEncoder::Direction::None);
+
+    } while (rotaryEncoder.hasPendingEvents() and ::newDisplay == DisplayBase::DisplayType::none);
 
+    static uint32_t lastScreenSaver = millis();
     if (userInteraction) {
         // Ha volt interakció, akkor megnézzük, hogy az a képernyővédőn történt-e
         if (::currentDisplay == DisplayBase::DisplayType::screenSaver) {
@@ -304,6 +418,9 @@ void loop() {
         // Minden esetben frissítjük a timeoutot
         lastScreenSaver = millis();
 
+        // A dialógok a config mezőit közvetlenül írják: a mentést az interakció végéig halasztjuk
+        config.notifyActivity();
+
     } else {
 
         // Ha nincs user interakció, megnézzük, hogy lejárt-e a timeout
@@ -319,4 +436,14 @@ void loop() {
             }
         }
     }
+
+    //------------------- Flash journal: a következő szektor előre törlése üresjáratban
+    if (!userInteraction and !memoryScanner.isActive()) {
+        flashJournal.loop();
+
+        // RDS állomás cache: a függő rekordok mentése, amikor nem hangolunk (a LittleFS írás alatt a megszakítások tiltva vannak)
+        if (band.getTuneEngine().isIdle()) {
+            rdsStationCache.loop();
+        }
+    }
 }
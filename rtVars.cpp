@@ -4,6 +4,9 @@
 
 namespace rtv {
 
+// Az SI4735 I2C címe (a setup()-ban derítjük fel)
+uint8_t si4735Address = 0x11;
+
 // Némítás
 bool mute = false;
 
@@ -26,9 +29,6 @@ bool bfoTr = false;  // A BFO frekvencia kijelzés miatt a frekvencia méreténe
 // Mute
 bool muteStat = false;
 
-// Squelch
-long squelchDecay = 0;
-
 // Scan
 bool SCANbut = false;   // Scan aktív?
 bool SCANpause = true;  // LWH - SCANpause must be initialized to a value else the squelch function will
@@ -8,6 +8,9 @@
  */
 namespace rtv {
 
+// Az SI4735 I2C címe (a setup()-ban derítjük fel)
+extern uint8_t si4735Address;
+
 // Némítás
 extern bool mute;
 
@@ -32,7 +35,6 @@ extern bool muteStat;
 #define SQUELCH_DECAY_TIME 500
 #define MIN_SQUELCH 0
 #define MAX_SQUELCH 50
-extern long squelchDecay;
 
 // Scan
 extern bool SCANbut;
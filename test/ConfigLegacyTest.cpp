@@ -0,0 +1,120 @@
+/**
+ * A séma verzió előtti firmware EEPROM config-jának betöltése
+ * Az EEPROM képet a régi firmware módján (EepromManager<ConfigV0_t>::save()) írjuk, és a mezők név szerinti átvételét ellenőrizzük
+ */
+#include "ConfigLegacy.h"
+#include "TestCheck.h"
+
+// A Config.cpp (és a Si4735 library) nélkül: egy alapértelmezett-szerű kiinduló állapot
+static Config_t makeDefaults() {
+    Config_t data;
+    memset(&data, 0, sizeof(data));
+    data.memScanPrioritySec = 5;
+    data.memScanPrioritySlot = -1;
+    data.rdsAfRssiThreshold = 20;
+    data.rdsAfMaxGapMsec = 150;
+    data.currVolume = 50;
+    return data;
+}
+
+static ConfigV0_t makeV0() {
+    ConfigV0_t v0 = {};
+    v0.bandIdx = 7;
+    v0.bwIdxAM = 1;
+    v0.bwIdxFM = 2;
+    v0.bwIdxMW = 3;
+    v0.bwIdxSSB = 4;
+    v0.ssIdxMW = 2;
+    v0.ssIdxAM = 1;
+    v0.ssIdxFM = 0;
+    v0.currentBFO = -1250;
+    v0.currentBFOStep = 10;
+    v0.currentBFOmanu = 35;
+    v0.currentSquelch = 22;
+    v0.squelchUsesRSSI = false;
+    v0.rdsEnabled = false;
+    v0.currVolume = 41;
+    v0.agcGain = 2;
+    v0.currentAGCgain = 17;
+    const uint16_t calibration[5] = {301, 3555, 287, 3490, 3};
+    memcpy(v0.tftCalibrateData, calibration, sizeof(calibration));
+    v0.tftBackgroundBrightness = 128;
+    v0.tftDigitLigth = false;
+    return v0;
+}
+
+/**
+ * Régi formátumú EEPROM kép: minden régi mező átjön, az új mezők az alapértelmezett értéken maradnak
+ */
+static void testBaselineImage() {
+    EEPROM.erase();
+    ConfigV0_t v0 = makeV0();
+    EepromManager<ConfigV0_t>::save(v0);
+
+    // Az új struktúrával a kép nem olvasható (ezért kell a régi struktúra)
+    Config_t current = makeDefaults();
+    bool valid = true;
+    EepromManager<Config_t>::getIfValid(current, valid);
+    CHECK(!valid);
+
+    Config_t data = makeDefaults();
+    CHECK(loadConfigV0Eeprom(data));
+
+    CHECK_EQ(data.bandIdx, 7);
+    CHECK_EQ(data.bwIdxAM, 1);
+    CHECK_EQ(data.bwIdxFM, 2);
+    CHECK_EQ(data.bwIdxMW, 3);
+    CHECK_EQ(data.bwIdxSSB, 4);
+    CHECK_EQ(data.ssIdxMW, 2);
+    CHECK_EQ(data.ssIdxAM, 1);
+    CHECK_EQ(data.ssIdxFM, 0);
+    CHECK_EQ(data.currentBFO, -1250);
+    CHECK_EQ(data.currentBFOStep, 10);
+    CHECK_EQ(data.currentBFOmanu, 35);
+    CHECK_EQ(data.currentSquelch, 22);
+    CHECK(!data.squelchUsesRSSI);
+    CHECK(!data.rdsEnabled);
+    CHECK_EQ(data.currVolume, 41);
+    CHECK_EQ(data.agcGain, 2);
+    CHECK_EQ(data.currentAGCgain, 17);
+    CHECK(memcmp(data.tftCalibrateData, v0.tftCalibrateData, sizeof(data.tftCalibrateData)) == 0);
+    CHECK_EQ(data.tftBackgroundBrightness, 128);
+    CHECK(!data.tftDigitLigth);
+
+    // A régi formátumban nem létező mezők
+    CHECK_EQ(data.memScanPrioritySec, 5);
+    CHECK_EQ(data.memScanPrioritySlot, -1);
+    CHECK_EQ(data.rdsAfRssiThreshold, 20);
+    CHECK_EQ(data.rdsAfMaxGapMsec, 150);
+}
+
+/**
+ * Nem régi formátumú tartalom: törölt EEPROM, sérült régi kép, az aktuális struktúrával mentett kép
+ */
+static void testRejected() {
+    Config_t defaults = makeDefaults();
+
+    EEPROM.erase();
+    Config_t data = makeDefaults();
+    CHECK(!loadConfigV0Eeprom(data));
+    CHECK(memcmp(&data, &defaults, sizeof(data)) == 0);
+
+    EEPROM.erase();
+    EepromManager<ConfigV0_t>::save(makeV0());
+    EEPROM.data()[8] ^= 0x01;  // currentBFO egy bitje
+    CHECK(!loadConfigV0Eeprom(data));
+    CHECK(memcmp(&data, &defaults, sizeof(data)) == 0);
+
+    EEPROM.erase();
+    Config_t current = makeDefaults();
+    current.bandIdx = 9;
+    EepromManager<Config_t>::save(current);
+    CHECK(!loadConfigV0Eeprom(data));
+    CHECK(memcmp(&data, &defaults, sizeof(data)) == 0);
+}
+
+int main() {
+    RUN_TEST(testBaselineImage);
+    RUN_TEST(testRejected);
+    return TEST_RESULT();
+}
@@ -0,0 +1,302 @@
+/**
+ * FlashJournal host teszt szimulált NOR flash-en (stubs/HostFlash.h), áramszünet szimulációval
+ *
+ * A journal a valódi kódjával fut, csak a FlashWriter alatti flash szimulált. Minden ellenőrzés után új
+ * FlashJournal példánnyal (begin()) is megnézzük, hogy az újraindítás ugyanazt látja.
+ */
+#include <map>
+#include <random>
+#include <vector>
+
+#include "FlashJournal.h"
+#include "HostFlash.h"
+#include "TestCheck.h"
+
+// A linker szimbólumok (CMakeLists.txt --defsym) szerint a gyűrű a LittleFS terület előtt
+#define JOURNAL_FLASH_OFFSET (HOST_FS_START - XIP_BASE - FLASH_JOURNAL_SECTORS * FLASH_SECTOR_SIZE)
+#define JOURNAL_SIZE (FLASH_JOURNAL_SECTORS * FLASH_SECTOR_SIZE)
+
+FlashJournal flashJournal;  // A FlashJournal.h extern-je miatt (a tesztek saját példányokat használnak)
+
+/**
+ * Egy kulcs egy verziójának tartalma (a hossz a kulcstól függ, a verzió minden bájtban benne van)
+ */
+static std::vector<uint8_t> payload(uint8_t key, uint32_t version, uint16_t length) {
+    std::vector<uint8_t> data(length);
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(key * 31 + version * 7 + i);
+    }
+    return data;
+}
+
+/**
+ * A journal pontosan az elvárt kulcsokat és tartalmakat adja?
+ */
+static bool matches(FlashJournal &journal, const std::map<uint8_t, std::vector<uint8_t>> &expected, bool report = true) {
+    for (uint8_t key = 0; key < FLASH_JOURNAL_MAX_KEYS; key++) {
+        auto it = expected.find(key);
+        if (it == expected.end()) {
+            if (journal.contains(key)) {
+                if (report) std::printf("  key %d: unexpected record\n", key);
+                return false;
+            }
+            continue;
+        }
+        std::vector<uint8_t> data(it->second.size());
+        if (!journal.read(key, data.data(), data.size()) or data != it->second) {
+            if (report) std::printf("  key %d: missing or different record\n", key);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Alap műveletek: írás, olvasás, felülírás, törlés, újraindítás
+ */
+static void testAppendReadReload() {
+
+    HostFlash::init();
+    FlashJournal journal;
+    journal.begin();
+    CHECK(journal.isReady());
+
+    std::map<uint8_t, std::vector<uint8_t>> expected;
+    for (uint8_t key = 0; key < 10; key++) {
+        expected[key] = payload(key, 0, 4 + key);
+        CHECK(journal.append(key, expected[key].data(), expected[key].size()));
+    }
+    expected[3] = payload(3, 1, 7);
+    CHECK(journal.append(3, expected[3].data(), expected[3].size()));
+    CHECK(journal.remove(5));
+    expected.erase(5);
+
+    // Más hosszal nem olvasható
+    uint8_t small[2];
+    CHECK(!journal.read(3, small, sizeof(small)));
+    CHECK(!journal.append(FLASH_JOURNAL_MAX_KEYS, small, sizeof(small)));
+
+    CHECK(matches(journal, expected));
+    FlashJournal reloaded;
+    reloaded.begin();
+    CHECK(matches(reloaded, expected));
+}
+
+/**
+ * Sok írás: a gyűrű többször körbeér, a ritkán írt kulcsot az áthelyezés viszi tovább, a törlések egyenletesek
+ */
+static void testRingWrapRelocationAndWear() {
+
+    HostFlash::init();
+    FlashJournal journal;
+    journal.begin();
+
+    std::map<uint8_t, std::vector<uint8_t>> expected;
+    expected[30] = payload(30, 0, 40);  // Csak egyszer írjuk
+    CHECK(journal.append(30, expected[30].data(), expected[30].size()));
+
+    std::mt19937 rng(41);
+    for (uint32_t i = 1; i <= 3000; i++) {
+        uint8_t key = rng() % 8;
+        expected[key] = payload(key, i, 16 + rng() % 48);
+        CHECK(journal.append(key, expected[key].data(), expected[key].size()));
+        if (i % 50 == 0) {
+            journal.loop();  // Üresjárati előtörlés
+        }
+    }
+    CHECK(matches(journal, expected));
+
+    FlashJournal reloaded;
+    reloaded.begin();
+    CHECK(matches(reloaded, expected));
+
+    uint32_t minErases = UINT32_MAX, maxErases = 0;
+    for (uint8_t sector = 0; sector < FLASH_JOURNAL_SECTORS; sector++) {
+        uint32_t erases = HostFlash::sectorErases(JOURNAL_FLASH_OFFSET + sector * FLASH_SECTOR_SIZE);
+        minErases = min(minErases, erases);
+        maxErases = max(maxErases, erases);
+    }
+    CHECK(minErases >= 5);  // ~150 kByte ment át a 16 kByte-os gyűrűn (az első körben nincs törlés)
+    CHECK(maxErases - minErases <= 1);
+}
+
+/**
+ * Áramszünet minden lehetséges ponton: egy valós terhelés lépéseinél a művelet egységei (programozott bájt, törlés)
+ * után elvágjuk az áramot, majd újraindítunk. Az írt kulcs a régi vagy az új értéket adja, a többi változatlan,
+ * és a journal utána is írható. A szektor váltással járó lépéseknél (törlés, fejléc, áthelyezés) minden egységet,
+ * a sima hozzáfűzéseknél minden POWER_CUT_STRIDE-adikat kipróbáljuk (a rekord fejléce mindig benne van).
+ */
+#define POWER_CUT_STRIDE 5
+
+static void testPowerCutAtEveryPoint() {
+
+    HostFlash::init();
+    FlashJournal journal;
+    journal.begin();
+
+    std::map<uint8_t, std::vector<uint8_t>> expected;
+    expected[20] = payload(20, 0, 100);  // Ritkán írt, az áthelyezés viszi
+    journal.append(20, expected[20].data(), expected[20].size());
+
+    // Egy teljes kör előre, hogy a szektor váltások már törléssel járjanak
+    for (uint32_t i = 0; i < 250; i++) {
+        expected[5] = payload(5, i, 60);
+        journal.append(5, expected[5].data(), expected[5].size());
+    }
+
+    std::mt19937 rng(4141);
+    uint32_t trials = 0, rolledBack = 0, advances = 0;
+
+    for (uint32_t step = 1; step <= 250; step++) {
+        uint8_t key = rng() % 6;
+        std::vector<uint8_t> next = payload(key, step, 20 + rng() % 60);
+        bool remove = rng() % 10 == 0 and expected.count(key);
+
+        // Kiinduló állapot és a lépés teljes "költsége"
+        std::vector<uint8_t> image = HostFlash::snapshot(JOURNAL_FLASH_OFFSET, JOURNAL_SIZE);
+        FlashJournal dryRun;
+        dryRun.begin();
+        HostFlash::resetCounters();
+        remove ? dryRun.remove(key) : dryRun.append(key, next.data(), next.size());
+        uint32_t stepUnits = HostFlash::unitsUsed();
+        bool advance = HostFlash::totalErases() > 0;
+        advances += advance ? 1 : 0;
+
+        for (uint32_t cut = 0; cut < stepUnits; cut += (advance or cut < sizeof(FlashJournalRecordHeader)) ? 1 : POWER_CUT_STRIDE) {
+            HostFlash::restore(JOURNAL_FLASH_OFFSET, image);
+            FlashJournal victim;
+            victim.begin();
+            HostFlash::armPowerCut(cut);
+            try {
+                remove ? victim.remove(key) : victim.append(key, next.data(), next.size());
+            } catch (HostFlash::PowerCut &) {
+            }
+            HostFlash::disarmPowerCut();
+            trials++;
+
+            // Újraindítás: a régi vagy az új állapot
+            FlashJournal recovered;
+            recovered.begin();
+
+            std::map<uint8_t, std::vector<uint8_t>> after = expected;
+            if (matches(recovered, after, false)) {
+                rolledBack++;
+            } else {
+                if (remove) {
+                    after.erase(key);
+                } else {
+                    after[key] = next;
+                }
+                if (!matches(recovered, after)) {
+                    std::printf("  step %u, cut %u/%u: inconsistent state after power cut\n", step, cut, stepUnits);
+                    testFailures++;
+                    return;
+                }
+            }
+
+            // Utána is írható, és a következő újraindítás is ugyanazt látja
+            std::vector<uint8_t> marker = payload(39, cut, 8);
+            after[39] = marker;
+            if (!recovered.append(39, marker.data(), marker.size())) {
+                std::printf("  step %u, cut %u: append failed after recovery\n", step, cut);
+                testFailures++;
+                return;
+            }
+            FlashJournal rebooted;
+            rebooted.begin();
+            if (!matches(rebooted, after)) {
+                std::printf("  step %u, cut %u: state changed by the second reboot\n", step, cut);
+                testFailures++;
+                return;
+            }
+        }
+
+        // A lépés megszakítás nélkül
+        HostFlash::restore(JOURNAL_FLASH_OFFSET, image);
+        journal = FlashJournal();
+        journal.begin();
+        if (remove) {
+            CHECK(journal.remove(key));
+            expected.erase(key);
+        } else {
+            CHECK(journal.append(key, next.data(), next.size()));
+            expected[key] = next;
+        }
+    }
+
+    std::printf("  %u power cuts, %u rolled back, %u steps with sector change\n", trials, rolledBack, advances);
+    CHECK(advances >= 3);
+    CHECK(matches(journal, expected));
+}
+
+/**
+ * Kopott szektor: a visszaolvasás hibát jelez, a szektor maradékát eldobjuk, így az áthelyezés nem fér el,
+ * és a következő szektor megnyitásakor a rekord elveszik ("record lost").
+ * A journal ilyenkor sem adhat vissza hibás adatot, az újraindítás ugyanazt látja, és tovább írható.
+ */
+static void testRecordLostOnWornSector() {
+
+    HostFlash::init();
+
+    // A 2. szektor második rekordjának helyén egy 0-ba ragadt bájt
+    HostFlash::setStuckBits(JOURNAL_FLASH_OFFSET + 2 * FLASH_SECTOR_SIZE + 300, 0xFF);
+
+    FlashJournal journal;
+    journal.begin();
+
+    std::map<uint8_t, std::vector<uint8_t>> written;
+    for (uint8_t key = 0; key < 14; key++) {
+        written[key] = payload(key, 0, 200);
+        CHECK(journal.append(key, written[key].data(), written[key].size()));
+    }
+
+    uint8_t lostKeys = 0;
+    uint32_t failedAppends = 0;
+    for (uint32_t i = 1; i <= 200; i++) {
+        uint8_t key = 20 + i % 4;
+        std::vector<uint8_t> next = payload(key, i, 200);
+
+        // A kopott szektoron félbemaradt áthelyezés után az írás is elbukhat, ilyenkor a régi érték marad
+        if (journal.append(key, next.data(), next.size())) {
+            written[key] = next;
+        } else {
+            failedAppends++;
+        }
+
+        // Soha nem kaphatunk hibás adatot: vagy a legutóbb sikeresen írt, vagy semmi
+        lostKeys = 0;
+        for (auto &entry : written) {
+            std::vector<uint8_t> data(entry.second.size());
+            bool present = journal.read(entry.first, data.data(), data.size());
+            CHECK(!present or data == entry.second);
+            lostKeys += present ? 0 : 1;
+        }
+    }
+    CHECK(lostKeys > 0);
+    CHECK(failedAppends < 10);
+
+    FlashJournal reloaded;
+    reloaded.begin();
+    for (auto &entry : written) {
+        CHECK_EQ(reloaded.contains(entry.first), journal.contains(entry.first));
+        std::vector<uint8_t> data(entry.second.size());
+        CHECK(!reloaded.read(entry.first, data.data(), data.size()) or data == entry.second);
+    }
+
+    std::vector<uint8_t> again = payload(0, 999, 200);
+    CHECK(reloaded.append(0, again.data(), again.size()));
+    std::vector<uint8_t> data(again.size());
+    CHECK(reloaded.read(0, data.data(), data.size()) and data == again);
+}
+
+int main() {
+
+    HostFlash::init();
+
+    RUN_TEST(testAppendReadReload);
+    RUN_TEST(testRingWrapRelocationAndWear);
+    RUN_TEST(testPowerCutAtEveryPoint);
+    RUN_TEST(testRecordLostOnWornSector);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,76 @@
+/**
+ * MemoryStore benchmark
+ * Feltöltés a maximális méretig, keresések, törlés + újrafelvétel körök, végül újraindítás (begin())
+ * A host fájl a flash helyett áll, a kiírt bájtokból a flash terhelés becsülhető
+ *
+ * Használat: memory_store_bench [keresések száma]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+
+#include "LittleFS.h"
+#include "MemoryStore.h"
+
+static MemoryStore store;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+int main(int argc, char **argv) {
+
+    uint32_t lookups = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    std::filesystem::path dir = std::filesystem::current_path() / "memstore_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    LittleFS.setRoot(dir.string());
+    store.begin();
+
+    std::mt19937 rng(39);
+    MemoryRecord record;
+    memset(&record, 0, sizeof(record));
+
+    // Feltöltés
+    auto start = std::chrono::steady_clock::now();
+    for (uint16_t i = 0; i < MEMORY_STORE_MAX_ENTRIES; i++) {
+        record.freqHz = 100000 + rng() % 30000000;
+        snprintf(record.name, sizeof(record.name), "%c%c%c mem %d", (char)('A' + rng() % 26), (char)('a' + rng() % 26), (char)('a' + rng() % 26), i);
+        store.add(record);
+    }
+    double fillSec = secondsSince(start);
+    uint32_t fillBytes = LittleFS.bytesWritten;
+
+    // Keresés
+    start = std::chrono::steady_clock::now();
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < lookups; i++) {
+        found += store.findByFrequency(100000 + rng() % 30000000) < store.getCount();
+        char name[3] = {(char)('a' + rng() % 26), (char)('a' + rng() % 26), '\0'};
+        found += store.findByName(name) < store.getCount();
+    }
+    double lookupSec = secondsSince(start);
+
+    // Törlés + újrafelvétel (slot újrahasznosítás)
+    uint32_t churnBytesStart = LittleFS.bytesWritten;
+    start = std::chrono::steady_clock::now();
+    for (uint16_t i = 0; i < 500; i++) {
+        uint16_t slot = store.getSlotByFrequencyPos(rng() % store.getCount());
+        store.remove(slot);
+        record.freqHz = 100000 + rng() % 30000000;
+        store.add(record);
+    }
+    double churnSec = secondsSince(start);
+
+    // Újraindítás: az indexek felépítése a fájlból
+    start = std::chrono::steady_clock::now();
+    store.begin();
+    double beginSec = secondsSince(start);
+
+    std::printf("MemoryStore: fill %d in %.1f ms (%u bytes written, %.0f B/add)\n", MEMORY_STORE_MAX_ENTRIES, fillSec * 1000, fillBytes, (double)fillBytes / MEMORY_STORE_MAX_ENTRIES);
+    std::printf("MemoryStore: %u freq+name lookups in %.1f ms -> %.0f ns/lookup\n", lookups, lookupSec * 1000, lookupSec * 1e9 / (2.0 * lookups));
+    std::printf("MemoryStore: 500 remove+add in %.1f ms (%u bytes written)\n", churnSec * 1000, LittleFS.bytesWritten - churnBytesStart);
+    std::printf("MemoryStore: begin() with %d entries in %.1f ms\n", store.getCount(), beginSec * 1000);
+
+    return found > 0 and store.getCount() == MEMORY_STORE_MAX_ENTRIES ? 0 : 1;
+}
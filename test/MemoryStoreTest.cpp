@@ -0,0 +1,210 @@
+/**
+ * MemoryStore host teszt
+ * A LittleFS helyett host fájl (stubs/LittleFS.h), így a rendezett indexek, a keresés és a slot újrahasznosítás
+ * a valódi fájl formátummal együtt, újraindítást (begin()) is szimulálva ellenőrizhető
+ */
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "LittleFS.h"
+#include "MemoryStore.h"
+#include "TestCheck.h"
+
+// A példányok nagyok (indexek), statikusan foglaljuk
+static MemoryStore store;
+static MemoryStore reloaded;
+
+/**
+ * Üres munkakönyvtár a tesztnek (a fájl neve fix, a könyvtár választja el a teszteket)
+ */
+static void freshRoot(const char *name) {
+    std::filesystem::path dir = std::filesystem::current_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    LittleFS.setRoot(dir.string());
+}
+
+static MemoryRecord makeRecord(uint32_t freqHz, const char *name) {
+    MemoryRecord record;
+    memset(&record, 0, sizeof(record));
+    record.freqHz = freqHz;
+    record.mod = 3;
+    strncpy(record.name, name, MEMORY_NAME_LENGTH);
+    return record;
+}
+
+/**
+ * A két index rendezett, és pontosan a foglalt slot-okat tartalmazza?
+ */
+static void checkIndexes(MemoryStore &s, uint16_t expectedCount) {
+
+    CHECK_EQ(s.getCount(), expectedCount);
+
+    uint32_t prevFreq = 0;
+    char prevName[MEMORY_NAME_KEY_LENGTH + 1] = "";
+    for (uint16_t pos = 0; pos < s.getCount(); pos++) {
+        MemoryRecord record;
+        CHECK(s.read(s.getSlotByFrequencyPos(pos), record));
+        CHECK(record.freqHz >= prevFreq);
+        prevFreq = record.freqHz;
+
+        CHECK(s.read(s.getSlotByNamePos(pos), record));
+        char key[MEMORY_NAME_KEY_LENGTH + 1] = {0};
+        for (uint8_t i = 0; i < MEMORY_NAME_KEY_LENGTH and record.name[i] != '\0'; i++) {
+            key[i] = toupper(record.name[i]);
+        }
+        CHECK(strcmp(prevName, key) <= 0);
+        strcpy(prevName, key);
+    }
+    CHECK_EQ(s.getSlotByFrequencyPos(s.getCount()), -1);
+    CHECK_EQ(s.getSlotByNamePos(s.getCount()), -1);
+}
+
+/**
+ * Véletlen sorrendű felvétel: mindkét index rendezett marad, és újraindítás után is ugyanaz
+ */
+static void testInsertKeepsIndexesSorted() {
+
+    freshRoot("memstore_insert");
+    store.begin();
+    CHECK_EQ(store.getCount(), 0);
+
+    std::mt19937 rng(39);
+    for (uint16_t i = 0; i < 300; i++) {
+        char name[MEMORY_NAME_LENGTH];
+        snprintf(name, sizeof(name), "%c%c station %d", (char)('a' + rng() % 26), (char)('A' + rng() % 26), i);
+        CHECK(store.add(makeRecord(100000 + rng() % 30000000, name)) >= 0);
+    }
+    checkIndexes(store, 300);
+
+    reloaded.begin();
+    checkIndexes(reloaded, 300);
+    for (uint16_t pos = 0; pos < 300; pos++) {
+        CHECK_EQ(reloaded.getSlotByFrequencyPos(pos), store.getSlotByFrequencyPos(pos));
+        CHECK_EQ(reloaded.getSlotByNamePos(pos), store.getSlotByNamePos(pos));
+    }
+}
+
+/**
+ * lowerBound keresések: pontos, köztes, a legkisebb alatti és a legnagyobb feletti érték
+ */
+static void testLowerBound() {
+
+    freshRoot("memstore_lowerbound");
+    store.begin();
+
+    store.add(makeRecord(7100000, "Forty"));
+    store.add(makeRecord(3600000, "eighty"));
+    store.add(makeRecord(14200000, "Twenty"));
+    store.add(makeRecord(7100000, "Forty bis"));
+
+    CHECK_EQ(store.findByFrequency(0), 0);
+    CHECK_EQ(store.findByFrequency(3600000), 0);
+    CHECK_EQ(store.findByFrequency(3600001), 1);
+    CHECK_EQ(store.findByFrequency(7100000), 1);  // Az első a két azonos közül
+    CHECK_EQ(store.findByFrequency(14200000), 3);
+    CHECK_EQ(store.findByFrequency(14200001), store.getCount());
+
+    CHECK_EQ(store.findSlotByFrequency(14200000), 2);
+    CHECK_EQ(store.findSlotByFrequency(14200001), -1);
+
+    // A név szerinti keresés kis/nagybetű független, és csak a kulcs hosszáig számít
+    CHECK_EQ(store.findByName("EIGHTY"), 0);
+    CHECK_EQ(store.findByName("f"), 1);
+    CHECK_EQ(store.findByName("forty b"), 2);
+    CHECK_EQ(store.findByName("twenty"), 3);
+    CHECK_EQ(store.findByName("zzz"), store.getCount());
+}
+
+/**
+ * Törlés: az indexekből kikerül, a slot-ot a következő felvétel újrahasznosítja, újraindítás után sem él fel
+ */
+static void testRemoveAndSlotReuse() {
+
+    freshRoot("memstore_reuse");
+    store.begin();
+
+    for (uint16_t i = 0; i < 10; i++) {
+        char name[MEMORY_NAME_LENGTH];
+        snprintf(name, sizeof(name), "Mem %02d", i);
+        CHECK_EQ(store.add(makeRecord(1000000 + i * 1000, name)), i);
+    }
+
+    CHECK(store.remove(3));
+    CHECK(store.remove(7));
+    CHECK(!store.remove(7));  // Már törölt
+    CHECK(!store.remove(50));  // Nem létező slot
+    checkIndexes(store, 8);
+    CHECK_EQ(store.findSlotByFrequency(1003000), -1);
+
+    MemoryRecord record;
+    CHECK(!store.read(3, record));
+
+    // A legkisebb szabad slot kerül újra használatba, a fájl nem nő
+    uintmax_t fileSize = std::filesystem::file_size(std::filesystem::current_path() / "memstore_reuse" / "memories.bin");
+    CHECK_EQ(store.add(makeRecord(500000, "Reused A")), 3);
+    CHECK_EQ(store.add(makeRecord(900000, "Reused B")), 7);
+    CHECK_EQ(std::filesystem::file_size(std::filesystem::current_path() / "memstore_reuse" / "memories.bin"), fileSize);
+    CHECK_EQ(store.add(makeRecord(2000000, "Appended")), 10);
+    checkIndexes(store, 11);
+    CHECK_EQ(store.getSlotByFrequencyPos(0), 3);
+
+    CHECK(store.remove(0));
+    reloaded.begin();
+    checkIndexes(reloaded, 10);
+    CHECK_EQ(reloaded.findSlotByFrequency(1000000), -1);
+    CHECK_EQ(reloaded.findSlotByFrequency(500000), 3);
+}
+
+/**
+ * Más formátumú (régi magic) fájl: újat kezdünk
+ */
+static void testMagicMismatchResets() {
+
+    freshRoot("memstore_magic");
+    store.begin();
+    store.add(makeRecord(7000000, "Old"));
+
+    File file = LittleFS.open(MEMORY_STORE_FILE_NAME, "r+");
+    uint32_t oldMagic = 0x4D454D30;
+    file.write((const uint8_t *)&oldMagic, sizeof(oldMagic));
+    file.close();
+
+    reloaded.begin();
+    CHECK_EQ(reloaded.getCount(), 0);
+    CHECK(reloaded.add(makeRecord(7000000, "New")) == 0);
+}
+
+/**
+ * Megtelt tár: a felvétel -1-et ad, az indexek épek maradnak
+ */
+static void testFullStore() {
+
+    freshRoot("memstore_full");
+    store.begin();
+
+    for (uint16_t i = 0; i < MEMORY_STORE_MAX_ENTRIES; i++) {
+        if (store.add(makeRecord(150000 + i * 9000, "Fill")) < 0) {
+            CHECK(false);
+            break;
+        }
+    }
+    CHECK_EQ(store.add(makeRecord(1, "Overflow")), -1);
+    checkIndexes(store, MEMORY_STORE_MAX_ENTRIES);
+
+    CHECK(store.remove(1234));
+    CHECK_EQ(store.add(makeRecord(1, "Fits again")), 1234);
+    CHECK_EQ(store.getSlotByFrequencyPos(0), 1234);
+}
+
+int main() {
+
+    RUN_TEST(testInsertKeepsIndexesSorted);
+    RUN_TEST(testLowerBound);
+    RUN_TEST(testRemoveAndSlotReuse);
+    RUN_TEST(testMagicMismatchResets);
+    RUN_TEST(testFullStore);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,38 @@
+#ifndef __RDSCORPUS_H
+#define __RDSCORPUS_H
+
+#include <cstdio>
+#include <vector>
+
+#include "RdsDecoder.h"
+
+/**
+ * RDS csoport felvétel betöltése (test/data/rds_groups.txt formátum)
+ * Soronként: A B C D blokk (hex) + a 4 BLE érték, a '#' kezdetű sorok megjegyzések
+ */
+static inline bool loadRdsCorpus(const char *path, std::vector<RdsGroup> &groups) {
+
+    FILE *file = std::fopen(path, "r");
+    if (file == nullptr) {
+        std::printf("Cannot open corpus: %s\n", path);
+        return false;
+    }
+
+    char line[128];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        if (line[0] == '#' or line[0] == '\n') {
+            continue;
+        }
+        unsigned a, b, c, d, bleA, bleB, bleC, bleD;
+        if (std::sscanf(line, "%x %x %x %x %u %u %u %u", &a, &b, &c, &d, &bleA, &bleB, &bleC, &bleD) != 8) {
+            continue;
+        }
+        RdsGroup group = {{(uint16_t)a, (uint16_t)b, (uint16_t)c, (uint16_t)d}, {(uint8_t)bleA, (uint8_t)bleB, (uint8_t)bleC, (uint8_t)bleD}};
+        groups.push_back(group);
+    }
+    std::fclose(file);
+
+    return !groups.empty();
+}
+
+#endif  //__RDSCORPUS_H
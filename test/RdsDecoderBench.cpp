@@ -0,0 +1,57 @@
+/**
+ * RdsDecoder benchmark
+ * A felvételt ismételten végigjátsszuk: csoport/s, átlagos és legrosszabb csoportonkénti idő (és x86-on TSC ciklus)
+ *
+ * Használat: rds_decoder_bench [ismétlések száma]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "RdsCorpus.h"
+#include "RdsDecoder.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() __rdtsc()
+#else
+#define BENCH_CYCLES() 0ULL
+#endif
+
+int main(int argc, char **argv) {
+
+    uint32_t passes = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+    std::vector<RdsGroup> groups;
+    if (!loadRdsCorpus(TEST_DATA_DIR "/rds_groups.txt", groups)) {
+        return 1;
+    }
+
+    RdsDecoder decoder;
+    uint64_t totalGroups = 0;
+    uint64_t maxNanos = 0;
+    uint64_t maxCycles = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        decoder.reset();
+        for (const RdsGroup &group : groups) {
+            auto t0 = std::chrono::steady_clock::now();
+            uint64_t c0 = BENCH_CYCLES();
+            decoder.decodeGroup(group);
+            uint64_t cycles = BENCH_CYCLES() - c0;
+            uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+
+            if (nanos > maxNanos) maxNanos = nanos;
+            if (cycles > maxCycles) maxCycles = cycles;
+        }
+        totalGroups += groups.size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("RdsDecoder: %llu groups in %.3f s -> %.0f groups/s, avg %.1f ns/group, worst %llu ns, worst %llu cycles\n",  //
+                (unsigned long long)totalGroups, seconds, totalGroups / seconds, seconds * 1e9 / totalGroups, (unsigned long long)maxNanos, (unsigned long long)maxCycles);
+
+    // A dekódolt adatok a mérés végén is helyesek legyenek (a fordító se dobhassa ki a hívásokat)
+    return decoder.hasStationName() ? 0 : 1;
+}
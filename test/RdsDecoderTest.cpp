@@ -0,0 +1,232 @@
+/**
+ * RdsDecoder host teszt
+ * A rögzített csoport felvételen (test/data/rds_groups.txt) és kézzel összerakott csoportokon ellenőrizzük a dekódolást
+ */
+#include <vector>
+
+#include "RdsCorpus.h"
+#include "RdsDecoder.h"
+#include "TestCheck.h"
+
+#define TEST_PI 0xC201
+#define TEST_PTY 10
+
+/**
+ * Egy hibátlan csoport összerakása
+ */
+static RdsGroup makeGroup(uint16_t pi, uint8_t groupType, bool versionB, uint8_t low5, uint16_t c, uint16_t d) {
+    uint16_t b = (groupType << 12) | (versionB ? 0x0800 : 0) | (TEST_PTY << 5) | (low5 & 0x1F);
+    return RdsGroup{{pi, b, versionB ? pi : c, d}, {RDS_BLE_NONE, RDS_BLE_NONE, RDS_BLE_NONE, RDS_BLE_NONE}};
+}
+
+/**
+ * Rajta van-e a frekvencia az AF listán
+ */
+static bool hasAf(const RdsDecoder &decoder, uint16_t freq) {
+    for (uint8_t i = 0; i < decoder.getAfCount(); i++) {
+        if (decoder.getAf(i) == freq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 0A csoportok: a teljes PS (és egy AF kódpár)
+ */
+static void feedPs(RdsDecoder &decoder, uint16_t pi, const char *ps, uint8_t repeat = 2) {
+    for (uint8_t r = 0; r < repeat; r++) {
+        for (uint8_t seg = 0; seg < 4; seg++) {
+            decoder.decodeGroup(makeGroup(pi, 0, false, seg, 0xCDCD, (ps[seg * 2] << 8) | ps[seg * 2 + 1]));
+        }
+    }
+}
+
+/**
+ * 2A csoportok: a RadioText 4 karakteres szegmensekben
+ */
+static void feedRt(RdsDecoder &decoder, const char *text, uint8_t abFlag, uint8_t repeat = 2) {
+    size_t len = std::strlen(text);
+    for (uint8_t r = 0; r < repeat; r++) {
+        for (uint8_t seg = 0; seg * 4u < len; seg++) {
+            char t[4];
+            for (uint8_t i = 0; i < 4; i++) {
+                t[i] = seg * 4u + i < len ? text[seg * 4 + i] : ' ';
+            }
+            decoder.decodeGroup(makeGroup(TEST_PI, 2, false, (abFlag << 4) | seg, (t[0] << 8) | t[1], (t[2] << 8) | t[3]));
+        }
+    }
+}
+
+/**
+ * A teljes felvétel: minden állomás adatnak a hibák ellenére is be kell állnia
+ */
+static void testCorpusConformance() {
+
+    std::vector<RdsGroup> groups;
+    CHECK(loadRdsCorpus(TEST_DATA_DIR "/rds_groups.txt", groups));
+
+    RdsDecoder decoder;
+    uint32_t expectedDiscarded = 0;
+    for (const RdsGroup &group : groups) {
+        decoder.decodeGroup(group);
+        if (group.ble[RdsDecoder::B] > RDS_BLE_CORRECTED_3_5) {
+            expectedDiscarded++;
+        }
+    }
+
+    CHECK_EQ(decoder.getGroupsReceived(), groups.size());
+    CHECK_EQ(decoder.getGroupsDiscarded(), expectedDiscarded);
+
+    CHECK(decoder.hasPi());
+    CHECK_EQ(decoder.getPi(), TEST_PI);
+    CHECK(decoder.hasPty());
+    CHECK_EQ(decoder.getPty(), TEST_PTY);
+
+    CHECK(decoder.hasStationName());
+    CHECK_STR(decoder.getStationName(), "PICO FM ");
+    CHECK_STR(decoder.getRadioText(), "Hello from pico-radio");
+
+    // A módszerű lista: 87.6, 95.0, 101.2 MHz (a sorrend a hibás csoportok miatt a vétel sorrendje)
+    CHECK_EQ(decoder.getAfCount(), 3);
+    CHECK(hasAf(decoder, 8760));
+    CHECK(hasAf(decoder, 9500));
+    CHECK(hasAf(decoder, 10120));
+
+    // MJD 45218 (EN 50067 példa) -> 1982-09-06, 13:45 UTC, +2 félóra
+    CHECK(decoder.hasDateTime());
+    uint16_t year;
+    uint8_t month, day, hour, minute;
+    decoder.getUtcDateTime(year, month, day, hour, minute);
+    CHECK_EQ(year, 1982);
+    CHECK_EQ(month, 9);
+    CHECK_EQ(day, 6);
+    CHECK_EQ(hour, 13);
+    CHECK_EQ(minute, 45);
+    decoder.getLocalTime(hour, minute);
+    CHECK_EQ(hour, 14);
+    CHECK_EQ(minute, 45);
+}
+
+/**
+ * Egy gyenge blokkból jött eltérő karakter nem írhatja felül a már megerősített karaktert
+ */
+static void testPsVotingRejectsSingleError() {
+
+    RdsDecoder decoder;
+    feedPs(decoder, TEST_PI, "PICO FM ", 3);
+    CHECK_STR(decoder.getStationName(), "PICO FM ");
+
+    RdsGroup bad = makeGroup(TEST_PI, 0, false, 0, 0xCDCD, ('X' << 8) | 'Y');
+    bad.ble[RdsDecoder::D] = RDS_BLE_CORRECTED_3_5;
+    decoder.decodeGroup(bad);
+    CHECK_STR(decoder.getStationName(), "PICO FM ");
+
+    // Javíthatatlan D blokk egyáltalán nem szavaz
+    bad.ble[RdsDecoder::D] = RDS_BLE_UNCORRECTABLE;
+    for (uint8_t i = 0; i < 10; i++) {
+        decoder.decodeGroup(bad);
+    }
+    CHECK_STR(decoder.getStationName(), "PICO FM ");
+}
+
+/**
+ * PI váltás: egy eltérő PI még nem váltás, a második már igen, és törli az állomás adatait
+ */
+static void testPiChangeNeedsConfirmation() {
+
+    RdsDecoder decoder;
+    feedPs(decoder, TEST_PI, "STATION1");
+    feedRt(decoder, "Some text", 0);
+    CHECK_EQ(decoder.getPi(), TEST_PI);
+
+    uint8_t piVersion = decoder.getPiVersion();
+    decoder.decodeGroup(makeGroup(0xD302, 0, false, 0, 0xCDCD, ('S' << 8) | 'T'));
+    CHECK_EQ(decoder.getPi(), TEST_PI);
+    CHECK_EQ(decoder.getPiVersion(), piVersion);
+
+    decoder.decodeGroup(makeGroup(0xD302, 0, false, 1, 0xCDCD, ('A' << 8) | 'T'));
+    CHECK_EQ(decoder.getPi(), 0xD302);
+    CHECK(!decoder.hasStationName());
+    CHECK_STR(decoder.getRadioText(), "");
+    CHECK_EQ(decoder.getAfCount(), 0);
+}
+
+/**
+ * RadioText: az A/B flag váltása törli a régi szöveget, a 0x0D lezárja
+ */
+static void testRtAbFlagAndTerminator() {
+
+    RdsDecoder decoder;
+    feedRt(decoder, "First message here", 0);
+    CHECK_STR(decoder.getRadioText(), "First message here");
+
+    feedRt(decoder, "Next\r", 1);
+    CHECK_STR(decoder.getRadioText(), "Next");
+}
+
+/**
+ * Javíthatatlan B blokk: a csoport típusa ismeretlen, eldobjuk
+ */
+static void testUncorrectableBlockBDiscarded() {
+
+    RdsDecoder decoder;
+    RdsGroup group = makeGroup(TEST_PI, 0, false, 0, 0xCDCD, ('A' << 8) | 'B');
+    group.ble[RdsDecoder::B] = RDS_BLE_UNCORRECTABLE;
+    for (uint8_t i = 0; i < 5; i++) {
+        decoder.decodeGroup(group);
+    }
+
+    CHECK_EQ(decoder.getGroupsReceived(), 5);
+    CHECK_EQ(decoder.getGroupsDiscarded(), 5);
+    CHECK(decoder.hasPi());  // Az A blokk ettől még érvényes
+    CHECK(!decoder.hasPty());
+    CHECK_STR(decoder.getStationName(), "        ");
+}
+
+/**
+ * B módszerű AF lista: a csökkenő pár regionális változat, kihagyjuk
+ */
+static void testAfMethodB() {
+
+    RdsDecoder decoder;
+    // 4 AF, a hangolt frekvencia 89.0 MHz (kód 15)
+    decoder.decodeGroup(makeGroup(TEST_PI, 0, false, 0, ((224 + 4) << 8) | 15, 0x2020));
+    decoder.decodeGroup(makeGroup(TEST_PI, 0, false, 1, (15 << 8) | 60, 0x2020));  // 89.0 -> 93.5 azonos műsor
+    decoder.decodeGroup(makeGroup(TEST_PI, 0, false, 2, (100 << 8) | 15, 0x2020));  // 97.5 -> 89.0 regionális
+
+    CHECK_EQ(decoder.getAfCount(), 2);
+    CHECK_EQ(decoder.getAf(0), 8900);
+    CHECK_EQ(decoder.getAf(1), 9350);
+}
+
+/**
+ * Előtöltés a cache-ből: az élő adat felülírja, az AF lista bővül, de nem duplikál
+ */
+static void testSeedStationData() {
+
+    RdsDecoder decoder;
+    decoder.decodeGroup(makeGroup(TEST_PI, 1, false, 0, 0, 0));
+
+    const uint16_t afs[] = {9500, 10120, 9500};
+    decoder.seedStationData(TEST_PTY, "CACHED  ", "Cached text", afs, 3);
+    CHECK_STR(decoder.getStationName(), "CACHED  ");
+    CHECK_STR(decoder.getRadioText(), "Cached text");
+    CHECK_EQ(decoder.getAfCount(), 2);
+
+    feedPs(decoder, TEST_PI, "LIVE FM ", 2);
+    CHECK_STR(decoder.getStationName(), "LIVE FM ");
+}
+
+int main() {
+
+    RUN_TEST(testCorpusConformance);
+    RUN_TEST(testPsVotingRejectsSingleError);
+    RUN_TEST(testPiChangeNeedsConfirmation);
+    RUN_TEST(testRtAbFlagAndTerminator);
+    RUN_TEST(testUncorrectableBlockBDiscarded);
+    RUN_TEST(testAfMethodB);
+    RUN_TEST(testSeedStationData);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,103 @@
+/**
+ * RdsStationCache host teszt
+ * A LittleFS helyett host fájl (stubs/LittleFS.h): a store() nem ír, a loop() a késleltetés után rekordonként ír,
+ * és újraindítás (begin()) után a mentett állomások visszatölthetők
+ */
+#include <filesystem>
+
+#include "LittleFS.h"
+#include "RdsStationCache.h"
+#include "TestCheck.h"
+
+// A példányok nagyok (index), statikusan foglaljuk
+static RdsStationCache cache;
+static RdsStationCache reloaded;
+
+static const uint16_t TEST_AF[] = {8870, 9390, 10080};
+
+static void freshRoot(const char *name) {
+    std::filesystem::path dir = std::filesystem::current_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    LittleFS.setRoot(dir.string());
+}
+
+/**
+ * A cache fájlban lévő rekordok száma
+ */
+static size_t fileRecords() {
+    File file = LittleFS.open(RDS_CACHE_FILE_NAME, "r");
+    return file ? (file.size() - sizeof(uint32_t)) / sizeof(RdsCacheRecord) : 0;
+}
+
+/**
+ * A store() csak feljegyzi az állomást, a fájlba a loop() ír a késleltetés után
+ */
+static void testDeferredWrite() {
+    freshRoot("rds_cache_deferred");
+    hostSetMicros(1000000);
+    cache.begin();
+
+    cache.store(9390, 0x2201, 10, "PETOFI  ", TEST_AF, 3);
+    CHECK_EQ(fileRecords(), 0);
+
+    // A még nem mentett állomás is megtalálható
+    RdsCacheRecord record;
+    CHECK(cache.lookup(9390, 0x2201, record));
+    CHECK_EQ(record.pty, 10);
+    CHECK_EQ(record.afCount, 3);
+
+    cache.loop();
+    hostAdvanceMicros((RDS_CACHE_WRITE_DELAY_MSEC - 1) * 1000ull);
+    cache.loop();
+    CHECK_EQ(fileRecords(), 0);
+
+    hostAdvanceMicros(1000);
+    cache.loop();
+    CHECK_EQ(fileRecords(), 1);
+
+    reloaded.begin();
+    CHECK(reloaded.lookup(9390, 0x2201, record));
+    CHECK(memcmp(record.ps, "PETOFI  ", RDS_PS_LENGTH) == 0);
+    CHECK_EQ(record.af[2], 10080);
+}
+
+/**
+ * Gyors állomásváltások: ugyanaz az állomás egyszer vár, a tele sorból a legrégebbi esik ki, hívásonként egy írás
+ */
+static void testPendingQueue() {
+    freshRoot("rds_cache_pending");
+    hostSetMicros(1000000);
+    cache.begin();
+
+    cache.store(8870, 0x2202, 1, "KOSSUTH ", TEST_AF, 0);
+    cache.store(8870, 0x2202, 1, "KOSSUTH2", TEST_AF, 0);
+    for (uint16_t i = 0; i < RDS_CACHE_PENDING_SIZE; i++) {
+        cache.store(9000 + i * 10, 0x3000 + i, 2, "STATION ", TEST_AF, 1);
+    }
+
+    hostAdvanceMicros(RDS_CACHE_WRITE_DELAY_MSEC * 1000ull);
+    for (uint16_t i = 1; i <= RDS_CACHE_PENDING_SIZE; i++) {
+        cache.loop();
+        CHECK_EQ(fileRecords(), i);
+    }
+    cache.loop();
+    CHECK_EQ(fileRecords(), RDS_CACHE_PENDING_SIZE);
+
+    RdsCacheRecord record;
+    reloaded.begin();
+    CHECK(!reloaded.lookup(8870, 0x2202, record));
+    CHECK(reloaded.lookup(9000, 0x3000, record));
+
+    // Az azonos adatokkal újra feljegyzett állomás nem foglal új rekordot
+    cache.store(9000, 0x3000, 2, "STATION ", TEST_AF, 1);
+    hostAdvanceMicros(RDS_CACHE_WRITE_DELAY_MSEC * 1000ull);
+    cache.loop();
+    CHECK_EQ(fileRecords(), RDS_CACHE_PENDING_SIZE);
+}
+
+int main() {
+    RUN_TEST(testDeferredWrite);
+    RUN_TEST(testPendingQueue);
+    return TEST_RESULT();
+}
@@ -0,0 +1,372 @@
+/**
+ * RotaryEncoder host teszt szintetikus láb hullámformákkal
+ * A service()-t a szimulált órával 1 msec-enként hívjuk (mint az EncoderTimer), a lábakat a hostGpioIn-en állítjuk.
+ * Kétszer fordul: ENC_NORMAL dekóderrel, és ENC_PIO-val (ott a PIO számlálót a stub RX FIFO-ján keresztül adjuk).
+ */
+#include "RotaryEncoder.h"
+#include "TestCheck.h"
+
+#define TEST_PIN_A 17  // CLK
+#define TEST_PIN_B 16  // DT
+#define TEST_PIN_BTN 18
+#define TEST_PIN_APART 20  // Nem szomszédos a TEST_PIN_A-val
+
+#if ENC_DECODER == ENC_PIO
+HostPioHw hostPio0, hostPio1;
+#endif
+
+// A kvadratúra jel fázisai (A, B aktív), a növekvő index a B-vezetett (Up) irány
+static const uint8_t QUADRATURE[4][2] = {{0, 0}, {0, 1}, {1, 1}, {1, 0}};
+static uint8_t phase = 0;
+
+/**
+ * Láb aktív (LOW) / inaktív (HIGH) szintre állítása
+ */
+static void setPin(uint8_t pin, bool active) {
+    if (active) {
+        hostGpioIn &= ~(1u << pin);
+    } else {
+        hostGpioIn |= 1u << pin;
+    }
+}
+
+static void setPhase(uint8_t newPhase) {
+    phase = newPhase & 3;
+    setPin(TEST_PIN_A, QUADRATURE[phase][0]);
+    setPin(TEST_PIN_B, QUADRATURE[phase][1]);
+}
+
+/**
+ * Alaphelyzet: minden láb inaktív, az óra egy nem nulla időpontról indul
+ */
+static void resetPins() {
+    hostGpioIn = 0xFFFFFFFF;
+    phase = 0;
+    hostSetMicros(1000000);
+}
+
+/**
+ * Az időzítő megszakítás: eltelik az idő, aztán service()
+ */
+static void tick(RotaryEncoder &encoder, uint32_t usec = 1000) {
+    hostAdvanceMicros(usec);
+    encoder.service();
+}
+
+/**
+ * A sorban lévő összes esemény összevonva (forgatás), ill. az első gomb esemény
+ */
+static RotaryEncoder::EncoderState readAll(RotaryEncoder &encoder) {
+    RotaryEncoder::EncoderState total = {RotaryEncoder::Direction::None, RotaryEncoder::ButtonState::Open, 0, 0, 0};
+    while (encoder.hasPendingEvents()) {
+        RotaryEncoder::EncoderState state = encoder.read();
+        total.detents += state.detents;
+        total.value += state.value;
+        total.velocity = max(total.velocity, state.velocity);
+        if (state.buttonState != RotaryEncoder::ButtonState::Open and total.buttonState == RotaryEncoder::ButtonState::Open) {
+            total.buttonState = state.buttonState;
+        }
+    }
+    return total;
+}
+
+#if ENC_DECODER == ENC_NORMAL
+static void ticks(RotaryEncoder &encoder, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        tick(encoder);
+    }
+}
+
+/**
+ * Lépésenkénti tekerés a lábakon: tickenként egy átmenet
+ */
+static void rotatePins(RotaryEncoder &encoder, int8_t direction, uint16_t transitions, uint32_t usecPerTransition = 1000) {
+    for (uint16_t i = 0; i < transitions; i++) {
+        setPhase(phase + direction);
+        tick(encoder, usecPerTransition);
+    }
+}
+
+static void testDirection() {
+    resetPins();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+    encoder.setAccelerationEnabled(false);
+
+    // 8 átmenet, lépésenként 2 impulzus -> 4 lépés
+    rotatePins(encoder, 1, 8, 20000);
+    RotaryEncoder::EncoderState state = encoder.read();
+    CHECK_EQ(state.detents, 4);
+    CHECK_EQ(state.value, 4);
+    CHECK(state.direction == RotaryEncoder::Direction::Up);
+
+    rotatePins(encoder, -1, 6, 20000);
+    state = encoder.read();
+    CHECK_EQ(state.detents, -3);
+    CHECK(state.direction == RotaryEncoder::Direction::Down);
+    CHECK(!encoder.hasPendingEvents());
+}
+
+/**
+ * Egy láb pergése (oda-vissza átmenetek) nem ad lépést
+ */
+static void testBounce() {
+    resetPins();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+
+    for (uint8_t i = 0; i < 20; i++) {
+        setPhase(phase + 1);
+        tick(encoder, 100);
+        setPhase(phase - 1);
+        tick(encoder, 100);
+    }
+    CHECK(!encoder.hasPendingEvents());
+
+    // A pergés után a valódi lépés ugyanúgy megjön
+    rotatePins(encoder, 1, 2);
+    CHECK_EQ(readAll(encoder).detents, 1);
+}
+
+/**
+ * Két tick közötti teljes periódus (4 átmenet) a lábakon nem látszik: a mintavételnél gyorsabb jel elveszik,
+ * de nem ad hamis lépést
+ */
+static void testTooFast() {
+    resetPins();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+
+    for (uint8_t i = 0; i < 4; i++) {
+        setPhase(phase + 1);
+    }
+    tick(encoder);
+    CHECK(!encoder.hasPendingEvents());
+}
+
+/**
+ * Sebesség és gyorsítás a lépések közötti időből
+ */
+static void testVelocity() {
+    resetPins();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+    rotatePins(encoder, 1, 2);
+    encoder.read();
+
+    // Lassú: 500 msec / lépés -> 2 lépés/sec, nincs gyorsítás
+    rotatePins(encoder, 1, 4, 250000);
+    RotaryEncoder::EncoderState state = readAll(encoder);
+    CHECK_EQ(state.velocity, 2);
+    CHECK_EQ(state.value, 2);
+
+    // Gyors: 10 msec / lépés -> 100 lépés/sec, a görbe szerint 25-szörös
+    rotatePins(encoder, 1, 4, 5000);
+    state = readAll(encoder);
+    CHECK_EQ(state.velocity, 100);
+    CHECK_EQ(state.value, 2 * 25);
+}
+
+/**
+ * Gomb: kattintás, dupla kattintás, nyomva tartás
+ */
+static void testButton() {
+    resetPins();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+
+    // Kattintás: a dupla kattintás ideje után jön
+    setPin(TEST_PIN_BTN, true);
+    ticks(encoder, 50);
+    setPin(TEST_PIN_BTN, false);
+    ticks(encoder, 100);
+    CHECK(!encoder.hasPendingEvents());
+    ticks(encoder, 600);
+    CHECK(encoder.read().buttonState == RotaryEncoder::ButtonState::Clicked);
+
+    // Dupla kattintás
+    setPin(TEST_PIN_BTN, true);
+    ticks(encoder, 50);
+    setPin(TEST_PIN_BTN, false);
+    ticks(encoder, 100);
+    setPin(TEST_PIN_BTN, true);
+    ticks(encoder, 50);
+    setPin(TEST_PIN_BTN, false);
+    ticks(encoder, 20);
+    CHECK(encoder.read().buttonState == RotaryEncoder::ButtonState::DoubleClicked);
+    ticks(encoder, 1000);
+    CHECK(!encoder.hasPendingEvents());
+
+    // Nyomva tartás, majd elengedés
+    setPin(TEST_PIN_BTN, true);
+    ticks(encoder, 1500);
+    CHECK(encoder.read().buttonState == RotaryEncoder::ButtonState::Held);
+    setPin(TEST_PIN_BTN, false);
+    ticks(encoder, 20);
+    CHECK(encoder.read().buttonState == RotaryEncoder::ButtonState::Released);
+    ticks(encoder, 1000);
+    CHECK(!encoder.hasPendingEvents());
+}
+
+/**
+ * A gomb esemény nem olvad össze a korábbi forgatással
+ */
+static void testButtonAfterRotation() {
+    resetPins();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+
+    rotatePins(encoder, 1, 4);
+    setPin(TEST_PIN_BTN, true);
+    ticks(encoder, 50);
+    setPin(TEST_PIN_BTN, false);
+    ticks(encoder, 700);
+    rotatePins(encoder, 1, 2);
+
+    RotaryEncoder::EncoderState state = encoder.read();
+    CHECK_EQ(state.detents, 2);
+    CHECK(state.buttonState == RotaryEncoder::ButtonState::Open);
+    state = encoder.read();
+    CHECK_EQ(state.detents, 0);
+    CHECK(state.buttonState == RotaryEncoder::ButtonState::Clicked);
+    state = encoder.read();
+    CHECK_EQ(state.detents, 1);
+    CHECK(!encoder.hasPendingEvents());
+}
+
+/**
+ * Tele sor: a többlet eseményeket eldobjuk és megszámoljuk
+ */
+static void testQueueOverflow() {
+    resetPins();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+    encoder.setAccelerationEnabled(false);
+
+    rotatePins(encoder, 1, 2 * (ROTARY_ENCODER_EVENT_QUEUE_SIZE + 8));
+    CHECK_EQ(encoder.getLostEventCount(), 8);
+    CHECK_EQ(readAll(encoder).detents, ROTARY_ENCODER_EVENT_QUEUE_SIZE);
+}
+#endif
+
+#if ENC_DECODER == ENC_PIO
+/**
+ * A PIO számláló új értéke(i) a FIFO-ba, aztán tick
+ */
+static void pushCount(RotaryEncoder &encoder, uint32_t count, uint32_t usec = 1000) {
+    hostPioPush(pio0, 0, count);
+    tick(encoder, usec);
+}
+
+static void resetPio() {
+    resetPins();
+    hostPioReset(pio0);
+    hostPioReset(pio1);
+}
+
+static void testPioDirection() {
+    resetPio();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+    encoder.setAccelerationEnabled(false);
+
+    pushCount(encoder, 4);
+    RotaryEncoder::EncoderState state = encoder.read();
+    CHECK_EQ(state.detents, 2);
+    CHECK(state.direction == RotaryEncoder::Direction::Up);
+
+    // Visszafelé, a számláló 0-n átfordulva
+    pushCount(encoder, (uint32_t)-4);
+    state = encoder.read();
+    CHECK_EQ(state.detents, -4);
+    CHECK(state.direction == RotaryEncoder::Direction::Down);
+
+    // Egy tick alatt több FIFO elem: csak a legutolsó számít
+    hostPioPush(pio0, 0, (uint32_t)-2);
+    hostPioPush(pio0, 0, 0);
+    pushCount(encoder, 2);
+    CHECK_EQ(encoder.read().detents, 3);
+}
+
+/**
+ * A tele FIFO a frissebb értékeket eldobja: a bent lévő (elavult) értékek helyett a számláló aktuális értéke számít
+ * Az Y számlálót indulás előtt nullázzuk (a stub bekapcsolási értéke nem 0)
+ */
+static void testPioFreshCount() {
+    resetPio();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+    encoder.setAccelerationEnabled(false);
+
+    tick(encoder);
+    CHECK(!encoder.hasPendingEvents());
+
+    // 8 elavult érték, közben a számláló már 6-on áll (a FIFO tele volt, a push-ok elvesztek)
+    for (uint32_t i = 1; i <= 8; i++) {
+        hostPioPush(pio0, 0, i / 4);
+    }
+    hostPio0.counter[0] = 6;
+    tick(encoder);
+    CHECK_EQ(encoder.read().detents, 3);
+    CHECK(hostPio0.rxFifo[0].empty());
+}
+
+/**
+ * Egy tick alatt több lépés: az eltelt időt egyenlően osztjuk szét, így a sebesség a valódi tekerésé
+ */
+static void testPioSpreadInterval() {
+    resetPio();
+    RotaryEncoder encoder(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+
+    pushCount(encoder, 2);
+    encoder.read();
+
+    // 4 lépés 400 msec alatt, de egyszerre kiolvasva -> 100 msec / lépés = 10 lépés/sec
+    pushCount(encoder, 10, 400000);
+    RotaryEncoder::EncoderState state = encoder.read();
+    CHECK_EQ(state.detents, 4);
+    CHECK_EQ(state.velocity, 10);
+    CHECK_EQ(state.value, 4 * (1 + (10 - 5) * (25 - 1) / (50 - 5)));
+
+    // Egyenletesen: a következő (egyedüli) lépés ugyanakkora időközzel ugyanazt a sebességet adja
+    pushCount(encoder, 12, 100000);
+    CHECK_EQ(encoder.read().velocity, 10);
+}
+
+/**
+ * Ha a PIO dekóder nem indul el, a lábakat dekódoljuk (a service() nem nyúl a PIO-hoz)
+ */
+static void testPioFallback() {
+    // Nincs szabad állapotgép egyik PIO-n sem
+    resetPio();
+    hostPio0.freeStateMachines = 0;
+    hostPio1.programSpaceFree = false;
+    RotaryEncoder noSm(TEST_PIN_A, TEST_PIN_B, TEST_PIN_BTN, 2);
+    for (uint8_t i = 0; i < 4; i++) {
+        setPhase(phase + 1);
+        tick(noSm);
+    }
+    CHECK_EQ(readAll(noSm).detents, 2);
+
+    // A lábak nincsenek egymás mellett
+    resetPio();
+    RotaryEncoder apart(TEST_PIN_A, TEST_PIN_APART, TEST_PIN_BTN, 2);
+    hostPioPush(pio0, 0, 100);  // Ezt nem olvashatja ki
+    for (uint8_t i = 1; i <= 2; i++) {
+        setPin(TEST_PIN_A, QUADRATURE[i][0]);
+        setPin(TEST_PIN_APART, QUADRATURE[i][1]);
+        tick(apart);
+    }
+    CHECK_EQ(readAll(apart).detents, 1);
+    CHECK_EQ(hostPio0.rxFifo[0].size(), 1u);
+}
+#endif
+
+int main() {
+#if ENC_DECODER == ENC_NORMAL
+    RUN_TEST(testDirection);
+    RUN_TEST(testBounce);
+    RUN_TEST(testTooFast);
+    RUN_TEST(testVelocity);
+    RUN_TEST(testButton);
+    RUN_TEST(testButtonAfterRotation);
+    RUN_TEST(testQueueOverflow);
+#elif ENC_DECODER == ENC_PIO
+    RUN_TEST(testPioDirection);
+    RUN_TEST(testPioFreshCount);
+    RUN_TEST(testPioSpreadInterval);
+    RUN_TEST(testPioFallback);
+#endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,132 @@
+/**
+ * SpscQueue host teszt
+ * Sorrend, telítettség, az indexek átfordulása, és egy termelő / egy fogyasztó szálon futó terheléses teszt
+ */
+#include <thread>
+
+#include "SpscQueue.h"
+#include "TestCheck.h"
+
+struct Item {
+    uint32_t seq;
+    uint32_t check;  // A seq-ből számolt érték: ha az elem félig íródott ki, nem egyezik
+};
+
+static void testFifoOrder() {
+    SpscQueue<uint32_t, 8> queue{};
+    uint32_t value;
+
+    CHECK(queue.isEmpty());
+    CHECK(!queue.peek(value));
+    CHECK(!queue.pop(value));
+
+    for (uint32_t i = 0; i < 5; i++) {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.isEmpty());
+
+    // A peek() nem veszi ki az elemet
+    CHECK(queue.peek(value));
+    CHECK_EQ(value, 0);
+    CHECK(queue.peek(value));
+    CHECK_EQ(value, 0);
+
+    for (uint32_t i = 0; i < 5; i++) {
+        CHECK(queue.pop(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(queue.isEmpty());
+}
+
+static void testFull() {
+    SpscQueue<uint32_t, 8> queue{};
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECK(queue.push(i));
+    }
+
+    // Tele: a további elemeket eldobjuk, a bent lévők épek maradnak
+    CHECK(!queue.push(100));
+    CHECK(!queue.push(101));
+    CHECK_EQ(queue.getOverflowCount(), 2);
+
+    uint32_t value;
+    CHECK(queue.pop(value));
+    CHECK_EQ(value, 0);
+    CHECK(queue.push(8));
+
+    for (uint32_t i = 1; i <= 8; i++) {
+        CHECK(queue.pop(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(queue.isEmpty());
+}
+
+/**
+ * Az uint8_t indexek sokszor átfordulnak (a méret nem 256, de osztója)
+ */
+static void testIndexWrap() {
+    SpscQueue<uint32_t, 32> queue{};
+    uint32_t next = 0, expected = 0;
+    for (uint32_t round = 0; round < 1000; round++) {
+        uint8_t n = 1 + round % 32;
+        for (uint8_t i = 0; i < n; i++) {
+            CHECK(queue.push(next++));
+        }
+        uint32_t value;
+        while (queue.pop(value)) {
+            if (value != expected) {
+                CHECK_EQ(value, expected);
+                return;
+            }
+            expected++;
+        }
+    }
+    CHECK_EQ(expected, next);
+    CHECK_EQ(queue.getOverflowCount(), 0);
+}
+
+/**
+ * Egy termelő és egy fogyasztó szál (mint az ISR és a loop()): minden elem sorrendben és épen érkezik,
+ * az eldobottakat a termelő ismétli
+ */
+static void testProducerConsumer() {
+    static SpscQueue<Item, 32> queue;
+    const uint32_t count = 200000;
+
+    // Tele / üres sornál átadjuk a processzort (egy magos gépen különben a várakozó szál a teljes időszeletét elpörgeti)
+    std::thread producer([&] {
+        for (uint32_t seq = 0; seq < count;) {
+            if (queue.push({seq, seq * 2654435761u})) {
+                seq++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    Item item = {};
+    while (expected < count) {
+        if (!queue.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item.seq != expected or item.check != item.seq * 2654435761u) {
+            errors++;
+        }
+        expected = item.seq + 1;
+    }
+    producer.join();
+
+    CHECK_EQ(errors, 0);
+    CHECK(queue.isEmpty());
+}
+
+int main() {
+    RUN_TEST(testFifoOrder);
+    RUN_TEST(testFull);
+    RUN_TEST(testIndexWrap);
+    RUN_TEST(testProducerConsumer);
+    return TEST_RESULT();
+}
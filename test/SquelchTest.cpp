@@ -0,0 +1,195 @@
+/**
+ * Squelch host teszt szintetikus RSQ (RSSI/SNR) sorozatokkal
+ * A mintavételező ütemében (SIGNAL_SAMPLER_PERIOD_MSEC = 100 msec) adjuk a méréseket, ahogy az AudioMute::loop()
+ */
+#include <vector>
+
+#include "Squelch.h"
+#include "TestCheck.h"
+
+#define SAMPLE_MSEC 100
+#define THRESHOLD 20
+
+/**
+ * Egy RSQ sorozat kiértékelése, az állapotváltások száma
+ * @param now az első minta ideje, a végén az utolsó utáni minta ideje
+ */
+static uint8_t feed(Squelch &squelch, const std::vector<uint8_t> &levels, uint32_t &now, uint8_t threshold = THRESHOLD) {
+    uint8_t changes = 0;
+    for (uint8_t level : levels) {
+        if (squelch.evaluate(level, threshold, now)) {
+            changes++;
+        }
+        now += SAMPLE_MSEC;
+    }
+    return changes;
+}
+
+/**
+ * Zárt zajzár (zaj SQUELCH_DECAY_TIME-nál tovább)
+ */
+static void closeSquelch(Squelch &squelch, uint32_t &now) {
+    feed(squelch, std::vector<uint8_t>(SQUELCH_DECAY_TIME / SAMPLE_MSEC + 1, 5), now);
+}
+
+static void testHelpers() {
+    CHECK_EQ(Squelch::selectLevel(30, 12, true), 30);
+    CHECK_EQ(Squelch::selectLevel(30, 12, false), 12);
+    CHECK(Squelch::reachesOpenThreshold(20, 20));
+    CHECK(!Squelch::reachesOpenThreshold(19, 20));
+    CHECK(Squelch::reachesOpenThreshold(0, 0));  // Kikapcsolt zajzár
+}
+
+/**
+ * Zárás: csak SQUELCH_DECAY_TIME folyamatos küszöb alatti jel után
+ */
+static void testDecay() {
+    Squelch squelch;
+    uint32_t now = 1000;
+    CHECK(squelch.isOpen());
+
+    // A zárási küszöb alatti első mintától számolunk
+    CHECK(!squelch.evaluate(5, THRESHOLD, now));
+    CHECK(!squelch.evaluate(5, THRESHOLD, now + SQUELCH_DECAY_TIME - 1));
+    CHECK(squelch.isOpen());
+    CHECK(squelch.evaluate(5, THRESHOLD, now + SQUELCH_DECAY_TIME));
+    CHECK(!squelch.isOpen());
+
+    // Egy közbeeső jó minta újraindítja a számlálást
+    Squelch fading;
+    now = 1000;
+    CHECK_EQ(feed(fading, {5, 5, 5, 5, 25, 5, 5, 5, 5}, now), 0);
+    CHECK(fading.isOpen());
+    CHECK_EQ(feed(fading, {5, 5}, now), 1);
+    CHECK(!fading.isOpen());
+}
+
+/**
+ * Nyitás: csak SQUELCH_ATTACK_TIME folyamatos, a nyitási küszöböt elérő jel után
+ */
+static void testAttack() {
+    Squelch squelch;
+    uint32_t now = 1000;
+    closeSquelch(squelch, now);
+    CHECK(!squelch.isOpen());
+
+    // Egyetlen tüske nem nyit
+    CHECK_EQ(feed(squelch, {30, 5, 30, 5}, now), 0);
+    CHECK(!squelch.isOpen());
+
+    // A küszöb alatt (de a zárási küszöb felett) nem nyit
+    CHECK_EQ(feed(squelch, {THRESHOLD - 1, THRESHOLD - 1, THRESHOLD - 1, THRESHOLD - 1}, now), 0);
+    CHECK(!squelch.isOpen());
+
+    // Két egymás utáni minta (100 msec) már nyit
+    CHECK(!squelch.evaluate(THRESHOLD, THRESHOLD, now));
+    CHECK(squelch.evaluate(THRESHOLD, THRESHOLD, now + SQUELCH_ATTACK_TIME));
+    CHECK(squelch.isOpen());
+}
+
+/**
+ * Hiszterézis: a nyitási küszöb körül ingadozó jel nem kapcsolgat
+ */
+static void testHysteresis() {
+    Squelch squelch;
+    uint32_t now = 1000;
+
+    // Nyitva: a zárási küszöbig (THRESHOLD - SQUELCH_HYSTERESIS) nyitva marad
+    std::vector<uint8_t> wobble;
+    for (uint8_t i = 0; i < 50; i++) {
+        wobble.push_back(i % 2 ? THRESHOLD + 1 : THRESHOLD - SQUELCH_HYSTERESIS);
+    }
+    CHECK_EQ(feed(squelch, wobble, now), 0);
+    CHECK(squelch.isOpen());
+
+    // Zárva: a nyitási küszöb alatt zárva marad, akármeddig
+    closeSquelch(squelch, now);
+    CHECK_EQ(feed(squelch, std::vector<uint8_t>(50, THRESHOLD - 1), now), 0);
+    CHECK(!squelch.isOpen());
+
+    // Kis küszöbnél a zárási küszöb nem fordul át (0 alá)
+    Squelch low;
+    now = 1000;
+    CHECK_EQ(feed(low, std::vector<uint8_t>(20, 0), now, 2), 0);
+    CHECK(low.isOpen());
+}
+
+/**
+ * Kikapcsolt zajzár (threshold = 0): mindig nyitva, zárt állapotból azonnal nyit
+ */
+static void testDisabled() {
+    Squelch squelch;
+    uint32_t now = 1000;
+    closeSquelch(squelch, now);
+    CHECK(!squelch.isOpen());
+
+    CHECK(squelch.evaluate(0, 0, now));
+    CHECK(squelch.isOpen());
+    CHECK(!squelch.evaluate(0, 0, now + SAMPLE_MSEC));
+
+    // Visszakapcsolva a korábbi (félbemaradt) időzítés nem számít
+    now += 10 * SAMPLE_MSEC;
+    CHECK(!squelch.evaluate(5, THRESHOLD, now));
+    CHECK(!squelch.evaluate(5, THRESHOLD, now + SAMPLE_MSEC));
+    CHECK(squelch.isOpen());
+}
+
+/**
+ * A millis() átfordulása és a 0 időpont nem zavarja az időzítést
+ */
+static void testTimeWrap() {
+    Squelch squelch;
+    uint32_t now = 0xFFFFFFFF - 250;
+    CHECK_EQ(feed(squelch, {5, 5, 5, 5, 5}, now), 0);  // 0xFFFFFF05 .. 0x00000135: 400 msec
+    CHECK(squelch.isOpen());
+    CHECK_EQ(feed(squelch, {5}, now), 1);
+    CHECK(!squelch.isOpen());
+
+    // Pontosan 0-kor kezdődő feltétel
+    Squelch zero;
+    CHECK(!zero.evaluate(5, THRESHOLD, 0));
+    CHECK(zero.evaluate(5, THRESHOLD, SQUELCH_DECAY_TIME));
+}
+
+/**
+ * Valószerű RSQ sorozat: zaj, lassan erősödő vivő fadinggel, gyengülés, újra zaj
+ * A kezdeti zárás után pontosan egy nyitás és egy zárás lehet, a fading ne kapcsolgasson
+ */
+static void testRsqTrace() {
+    // RSSI (dBuV) 100 msec-enként
+    std::vector<uint8_t> trace = {
+        8,  10, 9,  11, 12, 10, 9,  8,                        // zaj (a kezdő nyitott állapot ezalatt zár)
+        14, 19, 22, 24, 25, 23, 26, 25,                       // erősödő vivő
+        24, 18, 17, 22, 25, 26, 17, 18, 24, 25,               // fading: rövid letörések a zárási küszöbig
+        21, 19, 18, 16, 18, 17, 16, 15, 13, 11, 10, 9, 8, 9,  // gyengülés
+        10, 8,  9,  11, 10, 21, 9,  8,  10, 9,                // zaj, egy tüskével
+    };
+
+    Squelch squelch;
+    uint32_t now = 5000;
+    std::vector<bool> states;
+    uint8_t changes = 0;
+    for (uint8_t level : trace) {
+        if (squelch.evaluate(level, THRESHOLD, now)) {
+            changes++;
+            states.push_back(squelch.isOpen());
+        }
+        now += SAMPLE_MSEC;
+    }
+
+    // zárás (zaj), nyitás (vivő), zárás (gyengülés)
+    CHECK_EQ(changes, 3);
+    CHECK(states.size() == 3 and !states[0] and states[1] and !states[2]);
+    CHECK(!squelch.isOpen());
+}
+
+int main() {
+    RUN_TEST(testHelpers);
+    RUN_TEST(testDecay);
+    RUN_TEST(testAttack);
+    RUN_TEST(testHysteresis);
+    RUN_TEST(testDisabled);
+    RUN_TEST(testTimeWrap);
+    RUN_TEST(testRsqTrace);
+    return TEST_RESULT();
+}
@@ -0,0 +1,48 @@
+#ifndef __TESTCHECK_H
+#define __TESTCHECK_H
+
+#include <cstdio>
+#include <cstring>
+
+/**
+ * Minimális host teszt segéd: a hibás ellenőrzéseket kiírjuk és megszámoljuk,
+ * a main() a hibák számával tér vissza (ctest ebből tudja, hogy elbukott)
+ */
+static int testFailures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                      \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                                                                     \
+    do {                                                                                                                                               \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);                                                                                \
+        if (a_ != e_) {                                                                                                                                \
+            std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, a_, e_);                            \
+            testFailures++;                                                                                                                            \
+        }                                                                                                                                              \
+    } while (0)
+
+#define CHECK_STR(actual, expected)                                                                                                \
+    do {                                                                                                                           \
+        const char *a_ = (actual), *e_ = (expected);                                                                               \
+        if (std::strcmp(a_, e_) != 0) {                                                                                            \
+            std::printf("%s:%d: CHECK_STR(%s, %s) failed: \"%s\" != \"%s\"\n", __FILE__, __LINE__, #actual, #expected, a_, e_); \
+            testFailures++;                                                                                                        \
+        }                                                                                                                          \
+    } while (0)
+
+#define RUN_TEST(fn)                   \
+    do {                               \
+        std::printf("[ RUN ] %s\n", #fn); \
+        fn();                          \
+    } while (0)
+
+#define TEST_RESULT()                                                             \
+    (std::printf(testFailures == 0 ? "[ OK ]\n" : "[FAIL] %d failed check(s)\n", testFailures), testFailures == 0 ? 0 : 1)
+
+#endif  //__TESTCHECK_H
@@ -0,0 +1,72 @@
+#ifndef __HOST_ARDUINO_H
+#define __HOST_ARDUINO_H
+
+/**
+ * Host stub: az Arduino API-nak csak az a része, amit a host tesztekben fordított modulok használnak
+ * Az idő szimulált (hostAdvanceMicros()), így a tesztek determinisztikusak
+ */
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+using std::max;
+using std::min;
+
+#define PSTR(s) (s)
+#define F(s) (s)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+
+// pico-sdk makrók (a host-on nincs RAM/flash különbség)
+#define __force_inline inline __attribute__((always_inline))
+#define __not_in_flash_func(func) func
+inline void __dmb() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+
+/**
+ * GPIO: a lábak szimulált szintje (bit = láb), a teszt állítja, a digitalRead() és a sio_hw->gpio_in ezt olvassa
+ */
+extern volatile uint32_t hostGpioIn;
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline int digitalRead(uint8_t pin) { return (hostGpioIn >> pin) & 1; }
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t msec);
+void delayMicroseconds(uint32_t usec);
+
+/**
+ * A szimulált óra léptetése / beállítása
+ */
+void hostAdvanceMicros(uint64_t usec);
+void hostSetMicros(uint64_t usec);
+
+/**
+ * A DEBUG kimenet (alapból néma, HOST_VERBOSE=1 környezeti változóval kiírja)
+ */
+class HostSerial {
+   public:
+    bool verbose = false;
+    template <typename... Args>
+    void printf_P(const char *fmt, Args... args) {
+        if (verbose) {
+            std::printf(fmt, args...);
+        }
+    }
+    void printf_P(const char *fmt) {
+        if (verbose) {
+            std::fputs(fmt, stdout);
+        }
+    }
+    explicit operator bool() const { return true; }
+};
+extern HostSerial Serial;
+
+#endif  //__HOST_ARDUINO_H
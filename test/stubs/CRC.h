@@ -0,0 +1,30 @@
+#ifndef __HOST_CRC_H
+#define __HOST_CRC_H
+
+/**
+ * Host stub: a CRC library calcCRC16() függvénye (nem tükrözött), táblázattal, mert a journal tesztek sokszor újraolvassák a gyűrűt
+ */
+#include <cstdint>
+
+static inline uint16_t calcCRC16(const uint8_t *array, uint16_t length, uint16_t polynome = 0x8001, uint16_t startmask = 0x0000, uint16_t endmask = 0x0000) {
+    static uint16_t table[256];
+    static uint16_t tablePolynome = 0;
+    if (tablePolynome != polynome) {
+        for (uint16_t n = 0; n < 256; n++) {
+            uint16_t crc = n << 8;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ polynome : crc << 1;
+            }
+            table[n] = crc;
+        }
+        tablePolynome = polynome;
+    }
+
+    uint16_t crc = startmask;
+    for (uint16_t i = 0; i < length; i++) {
+        crc = (crc << 8) ^ table[(crc >> 8) ^ array[i]];
+    }
+    return crc ^ endmask;
+}
+
+#endif  //__HOST_CRC_H
@@ -0,0 +1,44 @@
+#ifndef __HOST_EEPROM_H
+#define __HOST_EEPROM_H
+
+/**
+ * Host stub: az arduino-pico EEPROM (a flash-ben emulált EEPROM) egy RAM tömbben
+ * A tartalom a memcpy-vel írható / olvasható a tesztből (data()), a törölt flash mint a valódin 0xFF
+ */
+#include <cstdint>
+#include <cstring>
+
+#define HOST_EEPROM_SIZE 4096
+
+class EEPROMClass {
+   private:
+    uint8_t bytes[HOST_EEPROM_SIZE];
+
+   public:
+    EEPROMClass() { erase(); }
+
+    void begin(size_t size) {}
+    bool commit() { return true; }
+
+    template <typename T>
+    T &get(int address, T &t) {
+        memcpy(&t, bytes + address, sizeof(T));
+        return t;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &t) {
+        memcpy(bytes + address, &t, sizeof(T));
+        return t;
+    }
+
+    /**
+     * Teszt segédek
+     */
+    uint8_t *data() { return bytes; }
+    void erase() { memset(bytes, 0xFF, sizeof(bytes)); }
+};
+
+inline EEPROMClass EEPROM;
+
+#endif  //__HOST_EEPROM_H
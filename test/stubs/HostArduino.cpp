@@ -0,0 +1,85 @@
+/**
+ * Host stub implementáció: szimulált óra, DEBUG kimenet, LittleFS a host fájlrendszeren
+ */
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <hardware/structs/sio.h>
+#include <hardware/timer.h>
+
+#include <cstdlib>
+
+static uint64_t hostMicros = 0;
+
+uint32_t millis() { return (uint32_t)(hostMicros / 1000); }
+uint32_t micros() { return (uint32_t)hostMicros; }
+void delay(uint32_t msec) { hostMicros += (uint64_t)msec * 1000; }
+void delayMicroseconds(uint32_t usec) { hostMicros += usec; }
+void hostAdvanceMicros(uint64_t usec) { hostMicros += usec; }
+void hostSetMicros(uint64_t usec) { hostMicros = usec; }
+
+volatile uint32_t hostGpioIn = 0xFFFFFFFF;  // Felhúzó ellenállások: alapból minden láb magas
+HostSioHw hostSioHw;
+HostTimerHw hostTimerHw;
+
+static bool hostVerbose() {
+    const char *env = std::getenv("HOST_VERBOSE");
+    return env != nullptr and env[0] == '1';
+}
+
+HostSerial Serial = [] {
+    HostSerial serial;
+    serial.verbose = hostVerbose();
+    return serial;
+}();
+
+//--- LittleFS ---
+HostLittleFS LittleFS;
+
+size_t File::read(uint8_t *buf, size_t size) {
+    size_t n = fp ? std::fread(buf, 1, size, fp) : 0;
+    LittleFS.bytesRead += n;
+    return n;
+}
+
+size_t File::write(const uint8_t *buf, size_t size) {
+    size_t n = fp ? std::fwrite(buf, 1, size, fp) : 0;
+    LittleFS.bytesWritten += n;
+    return n;
+}
+
+bool File::seek(uint32_t pos) { return fp and std::fseek(fp, pos, SEEK_SET) == 0; }
+
+size_t File::size() {
+    if (!fp) {
+        return 0;
+    }
+    long pos = std::ftell(fp);
+    std::fseek(fp, 0, SEEK_END);
+    long end = std::ftell(fp);
+    std::fseek(fp, pos, SEEK_SET);
+    return end;
+}
+
+void File::close() {
+    if (fp) {
+        std::fclose(fp);
+        fp = nullptr;
+    }
+}
+
+File HostLittleFS::open(const char *path, const char *mode) {
+    opens++;
+    std::string fullPath = root + path;
+    std::string hostMode = std::string(mode) + "b";  // "r+" -> "r+b"
+    return File(std::fopen(fullPath.c_str(), hostMode.c_str()));
+}
+
+bool HostLittleFS::remove(const char *path) { return std::remove((root + path).c_str()) == 0; }
+
+bool HostLittleFS::exists(const char *path) {
+    FILE *fp = std::fopen((root + path).c_str(), "rb");
+    if (fp) {
+        std::fclose(fp);
+    }
+    return fp != nullptr;
+}
@@ -0,0 +1,137 @@
+/**
+ * Szimulált NOR flash és a FlashWriter host megvalósítása
+ */
+#include "HostFlash.h"
+
+#include <hardware/flash.h>
+#include <sys/mman.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include "FlashWriter.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE MAP_FIXED
+#endif
+
+uint32_t FlashWriter::allowedIrqMask = 0;
+uint32_t FlashWriter::opCount = 0;
+uint32_t FlashWriter::maxOpUsec = 0;
+uint32_t FlashWriter::maxJitterUsec = 0;
+
+namespace HostFlash {
+
+static uint8_t *flash = nullptr;
+static bool cutArmed = false;
+static uint32_t cutBudget = 0;
+static uint32_t units = 0;
+static uint32_t programmed = 0;
+static std::map<uint32_t, uint32_t> erases;
+static uint32_t eraseTotal = 0;
+static std::map<uint32_t, uint8_t> stuckBits;
+
+/**
+ * A kopott bitek érvényesítése egy tartományon
+ */
+static void applyStuckBits(uint32_t flashOffset, uint32_t length) {
+    for (auto it = stuckBits.lower_bound(flashOffset); it != stuckBits.end() and it->first < flashOffset + length; ++it) {
+        flash[it->first] &= ~it->second;
+    }
+}
+
+void init() {
+    if (flash == nullptr) {
+        void *p = mmap((void *)(uintptr_t)XIP_BASE, HOST_FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (p != (void *)(uintptr_t)XIP_BASE) {
+            std::printf("HostFlash: cannot map the flash at 0x%08X\n", XIP_BASE);
+            std::exit(2);
+        }
+        flash = (uint8_t *)p;
+    }
+    memset(flash, 0xFF, HOST_FLASH_SIZE);
+    stuckBits.clear();
+    disarmPowerCut();
+    resetCounters();
+}
+
+std::vector<uint8_t> snapshot(uint32_t flashOffset, uint32_t length) { return std::vector<uint8_t>(flash + flashOffset, flash + flashOffset + length); }
+
+void restore(uint32_t flashOffset, const std::vector<uint8_t> &image) { memcpy(flash + flashOffset, image.data(), image.size()); }
+
+void armPowerCut(uint32_t budget) {
+    cutArmed = true;
+    cutBudget = budget;
+}
+
+void disarmPowerCut() { cutArmed = false; }
+
+void setStuckBits(uint32_t flashOffset, uint8_t mask) {
+    stuckBits[flashOffset] |= mask;
+    applyStuckBits(flashOffset, 1);
+}
+
+void resetCounters() {
+    units = 0;
+    programmed = 0;
+    erases.clear();
+    eraseTotal = 0;
+}
+
+uint32_t unitsUsed() { return units; }
+uint32_t bytesProgrammed() { return programmed; }
+uint32_t sectorErases(uint32_t flashOffset) { return erases[flashOffset]; }
+uint32_t totalErases() { return eraseTotal; }
+
+/**
+ * Egy egység felhasználása, ha elfogyott a keret: áramszünet
+ */
+static bool consumeUnit() {
+    units++;
+    if (cutArmed) {
+        if (cutBudget == 0) {
+            return false;
+        }
+        cutBudget--;
+    }
+    return true;
+}
+
+}  // namespace HostFlash
+
+void FlashWriter::program(uint32_t flashOffset, const uint8_t *data, uint32_t length) {
+    using namespace HostFlash;
+    if (flashOffset % FLASH_PAGE_SIZE != 0 or length % FLASH_PAGE_SIZE != 0 or flashOffset + length > HOST_FLASH_SIZE) {
+        std::printf("FlashWriter::program() -> unaligned or out of range: 0x%X, %u\n", flashOffset, length);
+        std::abort();
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        if (!consumeUnit()) {
+            throw PowerCut();
+        }
+        flash[flashOffset + i] &= data[i];  // NOR: csak 1 -> 0
+        programmed++;
+    }
+    applyStuckBits(flashOffset, length);
+    opCount++;
+}
+
+void FlashWriter::eraseSector(uint32_t flashOffset) {
+    using namespace HostFlash;
+    if (flashOffset % FLASH_SECTOR_SIZE != 0 or flashOffset + FLASH_SECTOR_SIZE > HOST_FLASH_SIZE) {
+        std::printf("FlashWriter::eraseSector() -> unaligned or out of range: 0x%X\n", flashOffset);
+        std::abort();
+    }
+    if (!consumeUnit()) {
+        memset(flash + flashOffset, 0xFF, FLASH_SECTOR_SIZE / 2);
+        applyStuckBits(flashOffset, FLASH_SECTOR_SIZE / 2);
+        throw PowerCut();
+    }
+    memset(flash + flashOffset, 0xFF, FLASH_SECTOR_SIZE);
+    applyStuckBits(flashOffset, FLASH_SECTOR_SIZE);
+    erases[flashOffset]++;
+    eraseTotal++;
+    opCount++;
+}
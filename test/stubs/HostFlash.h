@@ -0,0 +1,55 @@
+#ifndef __HOST_FLASH_H
+#define __HOST_FLASH_H
+
+/**
+ * Szimulált NOR flash a FlashWriter helyett
+ *
+ * A flash a XIP_BASE címen van (mmap), programozáskor csak 1 -> 0 bit váltás lehet (régi & új),
+ * törléskor a szektor csupa 0xFF lesz. Áramszünet szimulálása: armPowerCut() után a megadott számú
+ * "egység" (programozott bájt, illetve szektor törlés) után a művelet félbeszakad és PowerCut kivétel repül.
+ * A félbeszakadt törlés a szektor első felét törli, a többi marad (ahogy egy valódi törlés közben is bármi lehet).
+ * Kopott cella: setStuckBits() után a megadott bitek törléskor sem állnak vissza 1-re.
+ */
+#include <cstdint>
+#include <vector>
+
+namespace HostFlash {
+
+#define HOST_FLASH_SIZE (2u * 1024 * 1024)
+
+struct PowerCut {};
+
+/**
+ * A szimulált flash létrehozása (csupa 0xFF), a többszöri hívás csak törli
+ */
+void init();
+
+/**
+ * A flash egy részének mentése / visszatöltése (a tesztek kiinduló állapotához)
+ */
+std::vector<uint8_t> snapshot(uint32_t flashOffset, uint32_t length);
+void restore(uint32_t flashOffset, const std::vector<uint8_t> &image);
+
+/**
+ * Áramszünet a megadott számú egység után, illetve a tiltása
+ */
+void armPowerCut(uint32_t units);
+void disarmPowerCut();
+
+/**
+ * Kopott (0-ba ragadt) bitek egy bájton
+ */
+void setStuckBits(uint32_t flashOffset, uint8_t mask);
+
+/**
+ * Az indulás (vagy a resetCounters()) óta felhasznált egységek, programozott bájtok és szektor törlések száma
+ */
+void resetCounters();
+uint32_t unitsUsed();
+uint32_t bytesProgrammed();
+uint32_t sectorErases(uint32_t flashOffset);
+uint32_t totalErases();
+
+}  // namespace HostFlash
+
+#endif  //__HOST_FLASH_H
@@ -0,0 +1,56 @@
+#ifndef __HOST_LITTLEFS_H
+#define __HOST_LITTLEFS_H
+
+/**
+ * Host stub: a LittleFS fájlok egy host könyvtárban (LittleFS.setRoot()), a flash helyett
+ * Az írási forgalmat számoljuk, a benchmark ebből becsüli a flash terhelést
+ */
+#include <Arduino.h>
+
+#include <string>
+
+class File {
+   private:
+    FILE *fp = nullptr;
+
+   public:
+    File() = default;
+    explicit File(FILE *fp) : fp(fp) {}
+    File(const File &) = delete;
+    File &operator=(const File &) = delete;
+    File(File &&other) : fp(other.fp) { other.fp = nullptr; }
+    File &operator=(File &&other) {
+        close();
+        fp = other.fp;
+        other.fp = nullptr;
+        return *this;
+    }
+    ~File() { close(); }
+
+    explicit operator bool() const { return fp != nullptr; }
+    size_t read(uint8_t *buf, size_t size);
+    size_t write(const uint8_t *buf, size_t size);
+    bool seek(uint32_t pos);
+    size_t size();
+    void close();
+};
+
+class HostLittleFS {
+   private:
+    std::string root = ".";
+
+   public:
+    // Statisztika
+    uint32_t opens = 0;
+    uint32_t bytesWritten = 0;
+    uint32_t bytesRead = 0;
+
+    void setRoot(const std::string &dir) { root = dir; }
+    bool begin() { return true; }
+    File open(const char *path, const char *mode);
+    bool remove(const char *path);
+    bool exists(const char *path);
+};
+extern HostLittleFS LittleFS;
+
+#endif  //__HOST_LITTLEFS_H
@@ -0,0 +1,14 @@
+#ifndef __HOST_TFT_ESPI_H
+#define __HOST_TFT_ESPI_H
+
+/**
+ * Host stub: a utils.h csak a típust és a színeket hivatkozza
+ */
+#include <Arduino.h>
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+
+class TFT_eSPI {};
+
+#endif  //__HOST_TFT_ESPI_H
@@ -0,0 +1,14 @@
+#ifndef __HOST_HARDWARE_FLASH_H
+#define __HOST_HARDWARE_FLASH_H
+
+/**
+ * Host stub: a pico-sdk flash konstansai
+ * A szimulált flash (HostFlash) a valódi XIP címre van leképezve, így a memóriába leképezett olvasás ugyanúgy működik
+ */
+#include <cstdint>
+
+#define XIP_BASE 0x10000000u
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#endif  //__HOST_HARDWARE_FLASH_H
@@ -0,0 +1,143 @@
+#ifndef __HOST_HARDWARE_PIO_H
+#define __HOST_HARDWARE_PIO_H
+
+/**
+ * Host stub: a PIO blokkból annyi, amennyi a RotaryEncoder PIO dekóderéhez kell
+ * Az állapotgép nem fut, a teszt közvetlenül a számláló értékeit teszi az RX FIFO-ba (hostPioPush()),
+ * a szabad programhely és állapotgép pedig állítható, hogy a hibás indulás is tesztelhető legyen.
+ * Mint a valódi állapotgép (ami minden körben push-ol), az üres FIFO-ra váró olvasó a számláló aktuális értékét kapja.
+ */
+#include <Arduino.h>
+
+#include <deque>
+
+typedef unsigned int uint;
+
+#define PIO_FSTAT_RXEMPTY_LSB 8
+#define PIO_FLEVEL_RX0_LSB 4
+#define PIO_FLEVEL_RX0_BITS 0x000000f0
+#define NUM_PIO_STATE_MACHINES 4
+#define HOST_PIO_Y_POWER_ON 0x5A5A  // Az Y regiszter kezdőértéke, amíg senki nem állítja be (a valódin ismeretlen)
+
+struct HostPioHw {
+    std::deque<uint32_t> rxFifo[NUM_PIO_STATE_MACHINES];
+    uint32_t counter[NUM_PIO_STATE_MACHINES] = {HOST_PIO_Y_POWER_ON, HOST_PIO_Y_POWER_ON, HOST_PIO_Y_POWER_ON, HOST_PIO_Y_POWER_ON};  // Az Y számláló
+    bool running[NUM_PIO_STATE_MACHINES] = {};  // Engedélyezett állapotgép (csak az push-ol)
+    bool programSpaceFree = true;              // pio_can_add_program_at_offset() eredménye
+    uint8_t freeStateMachines = NUM_PIO_STATE_MACHINES;
+
+    // FSTAT: csak az RXEMPTY bitek (az üres FIFO-ba a futó állapotgép közben beírja a számlálót, mint a következő körében)
+    struct Fstat {
+        HostPioHw &hw;
+        operator uint32_t() const {
+            uint32_t value = 0;
+            for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+                bool empty = hw.rxFifo[sm].empty();
+                if (empty and hw.running[sm]) {
+                    hw.rxFifo[sm].push_back(hw.counter[sm]);
+                }
+                value |= (empty ? 1u : 0u) << (PIO_FSTAT_RXEMPTY_LSB + sm);
+            }
+            return value;
+        }
+    } fstat{*this};
+
+    // FLEVEL: csak az RX szintek
+    struct Flevel {
+        HostPioHw &hw;
+        operator uint32_t() const {
+            uint32_t value = 0;
+            for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+                value |= (uint32_t)std::min<size_t>(hw.rxFifo[sm].size(), 15) << (PIO_FLEVEL_RX0_LSB + sm * 8);
+            }
+            return value;
+        }
+    } flevel{*this};
+
+    // RXF[sm]: olvasáskor kivesz egy elemet a FIFO-ból
+    struct Rxf {
+        HostPioHw &hw;
+        struct Entry {
+            HostPioHw &hw;
+            uint sm;
+            operator uint32_t() const {
+                uint32_t value = hw.rxFifo[sm].front();
+                hw.rxFifo[sm].pop_front();
+                return value;
+            }
+        };
+        Entry operator[](uint sm) const { return {hw, sm}; }
+    } rxf{*this};
+};
+
+typedef HostPioHw *PIO;
+extern HostPioHw hostPio0, hostPio1;
+#define pio0 (&hostPio0)
+#define pio1 (&hostPio1)
+
+/**
+ * Alaphelyzet: üres FIFO-k, szabad programhely és állapotgépek
+ */
+inline void hostPioReset(PIO pio) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        pio->rxFifo[sm].clear();
+        pio->counter[sm] = HOST_PIO_Y_POWER_ON;
+        pio->running[sm] = false;
+    }
+    pio->programSpaceFree = true;
+    pio->freeStateMachines = NUM_PIO_STATE_MACHINES;
+}
+
+/**
+ * Számláló érték az állapotgép RX FIFO-jába (a teszt hívja)
+ */
+inline void hostPioPush(PIO pio, uint sm, uint32_t value) {
+    pio->counter[sm] = value;
+    pio->rxFifo[sm].push_back(value);
+}
+
+// Utasítás kódolók (a program nem fut, a kód érdektelen)
+enum pio_src_dest { pio_pins, pio_x, pio_y, pio_null, pio_pindirs, pio_exec_mov, pio_status, pio_pc, pio_isr, pio_osr };
+inline uint16_t pio_encode_jmp(uint addr) { return addr; }
+inline uint16_t pio_encode_jmp_y_dec(uint addr) { return addr; }
+inline uint16_t pio_encode_mov(pio_src_dest dest, pio_src_dest src) { return 0; }
+inline uint16_t pio_encode_mov_not(pio_src_dest dest, pio_src_dest src) { return 0; }
+inline uint16_t pio_encode_push(bool ifFull, bool block) { return 0; }
+inline uint16_t pio_encode_out(pio_src_dest dest, uint count) { return 0; }
+inline uint16_t pio_encode_in(pio_src_dest src, uint count) { return 0; }
+inline uint16_t pio_encode_set(pio_src_dest dest, uint value) { return 0xE000 | (dest << 5) | value; }  // A valódi kódolás: az exec ezt értelmezi
+
+struct pio_program_t {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+};
+
+struct pio_sm_config {};
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE, PIO_FIFO_JOIN_TX, PIO_FIFO_JOIN_RX };
+
+inline bool pio_can_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset) { return pio->programSpaceFree; }
+inline void pio_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset) { pio->programSpaceFree = false; }
+inline int pio_claim_unused_sm(PIO pio, bool required) {
+    if (pio->freeStateMachines == 0) {
+        return -1;
+    }
+    return NUM_PIO_STATE_MACHINES - pio->freeStateMachines--;
+}
+inline void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool isOut) {}
+inline pio_sm_config pio_get_default_sm_config() { return {}; }
+inline void sm_config_set_wrap(pio_sm_config *c, uint wrapTarget, uint wrap) {}
+inline void sm_config_set_in_pins(pio_sm_config *c, uint base) {}
+inline void sm_config_set_in_shift(pio_sm_config *c, bool shiftRight, bool autopush, uint threshold) {}
+inline void sm_config_set_out_shift(pio_sm_config *c, bool shiftRight, bool autopull, uint threshold) {}
+inline void sm_config_set_fifo_join(pio_sm_config *c, pio_fifo_join join) {}
+inline void sm_config_set_clkdiv(pio_sm_config *c, float div) {}
+inline void pio_sm_init(PIO pio, uint sm, uint initialPc, const pio_sm_config *config) {}
+inline void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) { pio->running[sm] = enabled; }
+inline void pio_sm_exec(PIO pio, uint sm, uint instr) {
+    if ((instr & 0xFFE0) == pio_encode_set(pio_y, 0)) {
+        pio->counter[sm] = instr & 0x1F;  // set y, <érték>
+    }
+}
+
+#endif  //__HOST_HARDWARE_PIO_H
@@ -0,0 +1,18 @@
+#ifndef __HOST_HARDWARE_STRUCTS_SIO_H
+#define __HOST_HARDWARE_STRUCTS_SIO_H
+
+/**
+ * Host stub: a SIO blokkból csak a GPIO bemenetek (a hostGpioIn-re leképezve)
+ */
+#include <Arduino.h>
+
+struct HostSioHw {
+    struct GpioIn {
+        operator uint32_t() const { return hostGpioIn; }
+    } gpio_in;
+};
+
+extern HostSioHw hostSioHw;
+#define sio_hw (&hostSioHw)
+
+#endif  //__HOST_HARDWARE_STRUCTS_SIO_H
@@ -0,0 +1,18 @@
+#ifndef __HOST_HARDWARE_TIMER_H
+#define __HOST_HARDWARE_TIMER_H
+
+/**
+ * Host stub: a timer blokkból csak a nyers usec számláló (a szimulált órára leképezve)
+ */
+#include <Arduino.h>
+
+struct HostTimerHw {
+    struct TimeRawL {
+        operator uint32_t() const { return micros(); }
+    } timerawl;
+};
+
+extern HostTimerHw hostTimerHw;
+#define timer_hw (&hostTimerHw)
+
+#endif  //__HOST_HARDWARE_TIMER_H
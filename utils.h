@@ -10,6 +10,7 @@
 #define PIN_SI4735_I2C_SDA 8
 #define PIN_SI4735_I2C_SCL 9
 #define PIN_SI4735_RESET 10
+#define PIN_SI4735_INT 19  // GPO2/INT
 
 // Rotary Encoder
 #define PIN_ENCODER_CLK 17